@@ -0,0 +1,248 @@
+/*
+ * acquire.c
+ *
+ * Concurrent sensor acquisition, see acquire.h
+ */
+
+#include <string.h>
+#include <acquire.h>
+#include <config.h>
+#include "diag.h"
+#include <driverLib/aon_rtc.h>
+#include <driverLib/prcm.h>
+#include "bmp-280-sensor.h"
+#include "tmp-007-sensor.h"
+#include "hdc-1000-sensor.h"
+#include "opt-3001-sensor.h"
+#include "sensor-common.h"
+#include "interfaces/board-i2c.h"
+#if ACQUIRE_CYCLES
+#include <inc/hw_cpu_dwt.h>
+#include <inc/hw_cpu_scs.h>
+#include <inc/hw_memmap.h>
+#include <inc/hw_types.h>
+#define acquireCycles()				HWREG(CPU_DWT_BASE + CPU_DWT_O_CYCCNT)
+#endif
+
+#define ACQUIRE_US(us)				((uint32_t)((us) * 65536ULL / 1000000))	// -> RTC ticks
+#define ACQUIRE_OPS_MAX				6				// largest list, the reads of all sensors
+
+// slave addresses on interface 0
+#define ACQUIRE_ADDR_BMP280			0x77
+#define ACQUIRE_ADDR_HDC1000		0x43
+#define ACQUIRE_ADDR_TMP007			0x44
+#define ACQUIRE_ADDR_OPT3001		0x45
+
+// conversion times (datasheet max., see acquire.h)
+static const uint32_t acquireTicks[4] = {
+  ACQUIRE_US(6400),									// BMP280
+  ACQUIRE_US(15000),								// HDC1000, 12.9 ms + margin
+  ACQUIRE_US(275000),								// TMP007
+  ACQUIRE_US(110000)								// OPT3001
+};
+
+// * Transaction lists (board_i2c_batch()), registers and values as written by the drivers
+// ----------------------------------------------------------------------------------------
+static const uint8_t bmpForced[] = {0xF4, 0x25};	// CTRL_MEAS: forced, T x1, P x1
+static const uint8_t bmpStatus[] = {0xF3};			// STATUS .. TEMP_XLSB in one burst
+static const uint8_t hdcTrigger[] = {0x00};			// pointer to TEMP: T and RH in sequence
+static const uint8_t tmpOn[] = {0x02, 0x10, 0x00};	// CONFIG: on
+static const uint8_t tmpOff[] = {0x02, 0x00, 0x00};
+static const uint8_t tmpStatus[] = {0x04};			// STATUS, bit 14 conversion ready
+static const uint8_t tmpLocal[] = {0x01};			// die temperature
+static const uint8_t optSingle[] = {0x01, 0xC2, 0x10};	// CONFIG: single shot, 100 ms, auto range
+static const uint8_t optShutdown[] = {0x01, 0xC0, 0x10};	// CONFIG after the single shot, as the driver disables
+static const uint8_t optConfig[] = {0x01};			// CONFIG, bit 7 conversion ready
+static const uint8_t optResult[] = {0x00};
+
+static uint8_t bmpData[10];							// STATUS, CTRL_MEAS, CONFIG, -, PRESS, TEMP
+static uint8_t hdcData[4];							// TEMP, HUM (big endian)
+static uint8_t tmpData[4];							// STATUS, LOCAL_TEMP
+static uint8_t optData[4];							// CONFIG, RESULT
+
+// per sensor (ACQUIRE_* bit i) the ops first[i] .. first[i + 1] - 1 of the list
+static const board_i2c_op_t acquireTriggerOps[] = {
+  {ACQUIRE_ADDR_BMP280, bmpForced, sizeof(bmpForced), NULL, 0},
+  {ACQUIRE_ADDR_HDC1000, hdcTrigger, sizeof(hdcTrigger), NULL, 0},
+  {ACQUIRE_ADDR_TMP007, tmpOn, sizeof(tmpOn), NULL, 0},
+  {ACQUIRE_ADDR_OPT3001, optSingle, sizeof(optSingle), NULL, 0}
+};
+static const uint8_t acquireTriggerFirst[5] = {0, 1, 2, 3, 4};
+#define ACQUIRE_TRIGGER_SHADOWED	0x04				// tmpOn, the others are triggers
+
+static const board_i2c_op_t acquireReadOps[] = {
+  {ACQUIRE_ADDR_BMP280, bmpStatus, sizeof(bmpStatus), bmpData, 10},
+  {ACQUIRE_ADDR_HDC1000, NULL, 0, hdcData, 4},		// NACKs its address while converting
+  {ACQUIRE_ADDR_TMP007, tmpStatus, sizeof(tmpStatus), &tmpData[0], 2},
+  {ACQUIRE_ADDR_TMP007, tmpLocal, sizeof(tmpLocal), &tmpData[2], 2},
+  {ACQUIRE_ADDR_OPT3001, optConfig, sizeof(optConfig), &optData[0], 2},
+  {ACQUIRE_ADDR_OPT3001, optResult, sizeof(optResult), &optData[2], 2}
+};
+static const uint8_t acquireReadFirst[5] = {0, 1, 2, 4, 6};
+
+static const board_i2c_op_t acquireTmpOff = {ACQUIRE_ADDR_TMP007, tmpOff, sizeof(tmpOff), NULL, 0};
+static const uint8_t acquireTmpOffFirst[5] = {0, 0, 0, 1, 1};
+
+static board_i2c_op_t acquireOps[ACQUIRE_OPS_MAX];	// list of the sensors in the set
+
+acquire_t g_acquire;
+uint32_t g_acquire_awake = 0;
+uint32_t g_acquire_span = 0;
+uint32_t g_acquire_read_cycles = 0;
+
+static uint8_t acquireStarted = 0;					// ACQUIRE_* triggered by acquireStart()
+static uint32_t acquireStartTime;
+
+
+// I2C pins back to GPIO, SERIAL domain off (as after sensorsInit())
+static void acquireBusOff(void) {
+  board_i2c_shutdown();
+  PRCMPowerDomainOff(PRCM_DOMAIN_SERIAL);
+  while((PRCMPowerDomainStatus(PRCM_DOMAIN_SERIAL) != PRCM_DOMAIN_POWER_OFF));
+}
+
+// The ops of the sensors in the mask as one list, returns the sensors whose ops all succeeded.
+// Writes of the ops in shadowed (bit k: list[k]) are configuration writes and skipped when
+// the register shadow (sensor-common.c) already holds the value, all other writes are
+// triggers and drop the register from the shadow
+static uint8_t acquireBatch(const board_i2c_op_t *list, const uint8_t *first, uint8_t sensors, uint8_t shadowed) {
+  uint8_t owner[ACQUIRE_OPS_MAX];
+  bool config[ACQUIRE_OPS_MAX];
+  uint8_t count = 0;
+  uint8_t ok = sensors;
+  uint32_t failed;
+  uint8_t i, k;
+
+  for(i = 0; i < 4; i++) {
+    if(!(sensors & (1 << i))) {
+      continue;
+    }
+    for(k = first[i]; k < first[i + 1]; k++) {
+      const board_i2c_op_t *op = &list[k];
+
+      config[count] = (shadowed >> k) & 1;
+      if(op->rlen == 0) {
+        if(config[count] && sensor_shadow_match(op->addr, op->wdata, op->wlen)) {
+          continue;
+        }
+        if(!config[count]) {
+          sensor_shadow_forget(op->addr, op->wdata[0]);
+        }
+      }
+      acquireOps[count] = *op;
+      owner[count++] = 1 << i;
+    }
+  }
+  if(count == 0) {
+    return ok;
+  }
+
+  failed = board_i2c_batch(acquireOps, count);
+  for(k = 0; k < count; k++) {
+    if(failed & (1UL << k)) {
+      ok &= ~owner[k];
+      if(owner[k] != ACQUIRE_HDC1000) {				// not an error, still converting
+        DIAG_COUNT(i2cFailures);
+        sensor_shadow_invalidate(acquireOps[k].addr);
+      }
+    } else if(config[k]) {
+      sensor_shadow_store(acquireOps[k].addr, acquireOps[k].wdata, acquireOps[k].wlen);
+    }
+  }
+  return ok;
+}
+
+// Results of the sensors read without error, returns the ones that were done converting
+static uint8_t acquireResults(uint8_t sensors) {
+  uint8_t done = 0;
+  int32_t t, rh, amb;
+
+  if(sensors & ACQUIRE_BMP280) {
+    if(bmpData[0] & 0x08) {							// STATUS: measuring
+      DIAG_COUNT(bmpRetries);
+    } else {
+      g_acquire.rawPressure    = ((uint32_t)bmpData[4] << 12) | ((uint32_t)bmpData[5] << 4) | (bmpData[6] >> 4);
+      g_acquire.rawTemperature = ((uint32_t)bmpData[7] << 12) | ((uint32_t)bmpData[8] << 4) | (bmpData[9] >> 4);
+      g_acquire.pressure = 0;
+      convert_bmp_280(&bmpData[4], &g_acquire.temperature, &g_acquire.pressure);
+      done |= ACQUIRE_BMP280;
+    }
+  }
+  if(sensors & ACQUIRE_HDC1000) {
+    convert_raw_hdc_1000((hdcData[0] << 8) | hdcData[1], (hdcData[2] << 8) | hdcData[3], &t, &rh);
+    g_acquire.humidity = rh;
+    done |= ACQUIRE_HDC1000;
+  }
+  if((sensors & ACQUIRE_TMP007) && (tmpData[0] & 0x40)) {
+    convert_tmp_007((tmpData[2] << 8) | tmpData[3], 0, &t, &amb);
+    g_acquire.ambient = amb;
+    done |= ACQUIRE_TMP007;
+  }
+  if((sensors & ACQUIRE_OPT3001) && (optData[1] & 0x80)) {
+    g_acquire.light = (optData[2] << 8) | optData[3];
+    sensor_shadow_store(ACQUIRE_ADDR_OPT3001, optShutdown, sizeof(optShutdown));
+    done |= ACQUIRE_OPT3001;
+  }
+  return done;
+}
+
+void acquireInit(void) {
+#if ACQUIRE_CYCLES
+  // DWT cycle counter, needs trace enabled
+  HWREG(CPU_SCS_BASE + CPU_SCS_O_DEMCR) |= CPU_SCS_DEMCR_TRCENA;
+  HWREG(CPU_DWT_BASE + CPU_DWT_O_CYCCNT) = 0;
+  HWREG(CPU_DWT_BASE + CPU_DWT_O_CTRL) |= CPU_DWT_CTRL_CYCCNTENA;
+#endif
+  if(ACQUIRE_SENSORS & ACQUIRE_HDC1000) {
+    configure_hdc_1000();							// T and RH in one sequence, kept by the sensor
+  }
+}
+
+uint32_t acquireStart(uint8_t sensors) {
+  uint32_t start = AONRTCCurrentCompareValueGet();
+  uint32_t ticks = 0;
+  uint8_t i;
+
+  acquireStarted = sensors;
+  acquireStartTime = start;
+
+  // back to back in one list, the sensors convert in parallel
+  acquireBatch(acquireTriggerOps, acquireTriggerFirst, sensors, ACQUIRE_TRIGGER_SHADOWED);
+  acquireBusOff();
+
+  for(i = 0; i < 4; i++) {
+    if((sensors & (1 << i)) && acquireTicks[i] > ticks) {
+      ticks = acquireTicks[i];
+    }
+  }
+  g_acquire_awake = AONRTCCurrentCompareValueGet() - start;
+  return start + ticks;
+}
+
+bool acquireRead(void) {
+  uint32_t start = AONRTCCurrentCompareValueGet();
+  uint8_t pending = acquireStarted;
+  uint16_t n;
+#if ACQUIRE_CYCLES
+  uint32_t cycles = acquireCycles();
+#endif
+
+  // all results in one list, the sensors still busy again until done
+  g_acquire.valid = 0;
+  for(n = 0; pending != 0 && n <= ACQUIRE_POLL_MAX; n++) {
+    uint8_t done = acquireResults(acquireBatch(acquireReadOps, acquireReadFirst, pending, 0));
+    g_acquire.valid |= done;
+    pending &= ~done;
+  }
+  if(acquireStarted & ACQUIRE_TMP007) {
+    acquireBatch(&acquireTmpOff, acquireTmpOffFirst, ACQUIRE_TMP007, 0x01);	// continuous mode, off until the next set
+  }
+  acquireBusOff();
+
+#if ACQUIRE_CYCLES
+  g_acquire_read_cycles = acquireCycles() - cycles;
+#endif
+  g_acquire_awake += AONRTCCurrentCompareValueGet() - start;
+  g_acquire_span = AONRTCCurrentCompareValueGet() - acquireStartTime;
+  return g_acquire.valid == acquireStarted;
+}
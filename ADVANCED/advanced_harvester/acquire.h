@@ -0,0 +1,62 @@
+/*
+ * acquire.h
+ *
+ * Concurrent sensor acquisition (SENSOR_ACQUIRE in config.h)
+ * ----------------------------------------------------------
+ * All sensors of ACQUIRE_SENSORS convert at the same time: acquireStart() triggers them
+ * back to back in one I2C session and returns when the slowest one is done, the caller
+ * sleeps until then (standby, see main.c) and acquireRead() fetches every result in a
+ * second I2C session. A set costs one conversion time of the slowest sensor instead of
+ * the sum, and no CPU time while the sensors convert.
+ *
+ * Conversion times (datasheet max.):
+ *   BMP280   forced, T x1 / P x1     6.4 ms
+ *   HDC1000  T + RH, 14 bit each    12.9 ms
+ *   TMP007   one sample (CR = 0)     275 ms (first result after power-up)
+ *   OPT3001  single shot, CT = 0     110 ms
+ * A sensor that is still busy at acquireRead() is polled (ACQUIRE_POLL_MAX rounds) like
+ * the old read loops.
+ *
+ * Both sessions are one I2C transaction list each (board_i2c_batch()): the register
+ * accesses of all sensors back to back with repeated starts, one wakeup and one shutdown
+ * of the I2C and the SERIAL domain. The transfers are interrupt driven, the CPU sleeps
+ * while a byte is on the bus; ACQUIRE_CYCLES counts what is left of a read session.
+ */
+
+#ifndef ACQUIRE_H_
+#define ACQUIRE_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define ACQUIRE_BMP280				0x01
+#define ACQUIRE_HDC1000				0x02
+#define ACQUIRE_TMP007				0x04
+#define ACQUIRE_OPT3001				0x08
+
+#define ACQUIRE_POLL_MAX			200				// status reads per sensor when late
+
+typedef struct {
+  uint8_t valid;									// ACQUIRE_* of the sensors read
+  uint32_t pressure;								// BMP280 [Pa]
+  int32_t temperature;								// BMP280 [0.01 degC]
+  uint32_t rawPressure;								// BMP280 20 bit ADC words
+  uint32_t rawTemperature;
+  int32_t humidity;									// HDC1000 [0.01 %RH]
+  int32_t ambient;									// TMP007 die temperature [0.001 degC]
+  uint16_t light;									// OPT3001 result register (exponent | mantissa)
+} acquire_t;
+
+extern acquire_t g_acquire;							// last set
+extern uint32_t g_acquire_awake;					// CPU time of the last set [RTC ticks]
+extern uint32_t g_acquire_span;						// trigger to last result of the last set [RTC ticks]
+extern uint32_t g_acquire_read_cycles;				// CPU-active cycles of the last acquireRead() (ACQUIRE_CYCLES)
+
+
+// * Functions
+// ------------
+void acquireInit(void);								// once, in sensorsInit()
+uint32_t acquireStart(uint8_t sensors);				// returns the RTC time the slowest conversion is done
+bool acquireRead(void);								// into g_acquire, true if all triggered sensors read
+
+#endif /* ACQUIRE_H_ */
@@ -1251,6 +1251,16 @@ int mbedtls_aes_self_test( int verbose )
             mbedtls_printf( "  AES-ECB-%3d (%s): ", 128 + u * 64,
                              ( v == MBEDTLS_AES_DECRYPT ) ? "dec" : "enc" );
 
+#if defined(MBEDTLS_AES_ALT)
+        /* aes_alt.c: the CC26xx crypto engine does AES-128 only */
+        if( u != 0 )
+        {
+            if( verbose != 0 )
+                mbedtls_printf( "skipped\n" );
+            continue;
+        }
+#endif
+
         memset( buf, 0, 16 );
 
         if( v == MBEDTLS_AES_DECRYPT )
@@ -1306,6 +1316,16 @@ int mbedtls_aes_self_test( int verbose )
             mbedtls_printf( "  AES-CBC-%3d (%s): ", 128 + u * 64,
                              ( v == MBEDTLS_AES_DECRYPT ) ? "dec" : "enc" );
 
+#if defined(MBEDTLS_AES_ALT)
+        /* aes_alt.c: the CC26xx crypto engine does AES-128 only */
+        if( u != 0 )
+        {
+            if( verbose != 0 )
+                mbedtls_printf( "skipped\n" );
+            continue;
+        }
+#endif
+
         memset( iv , 0, 16 );
         memset( prv, 0, 16 );
         memset( buf, 0, 16 );
@@ -1372,6 +1392,16 @@ int mbedtls_aes_self_test( int verbose )
             mbedtls_printf( "  AES-CFB128-%3d (%s): ", 128 + u * 64,
                              ( v == MBEDTLS_AES_DECRYPT ) ? "dec" : "enc" );
 
+#if defined(MBEDTLS_AES_ALT)
+        /* aes_alt.c: the CC26xx crypto engine does AES-128 only */
+        if( u != 0 )
+        {
+            if( verbose != 0 )
+                mbedtls_printf( "skipped\n" );
+            continue;
+        }
+#endif
+
         memcpy( iv,  aes_test_cfb128_iv, 16 );
         memcpy( key, aes_test_cfb128_key[u], 16 + u * 8 );
 
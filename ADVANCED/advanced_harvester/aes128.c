@@ -0,0 +1,327 @@
+/*
+ * aes128.c
+ *
+ * AES-128 on the engine, the ROM or in C, see aes128.h
+ */
+
+#include <string.h>
+#include <aes128.h>
+#include <config.h>
+
+#if !defined(__TI_COMPILER_VERSION__)
+#undef AES128_BACKEND
+#define AES128_BACKEND				AES128_SOFT		// host build
+#endif
+
+#if AES128_BACKEND == AES128_ENGINE
+#include "system.h"
+#include <inc/hw_crypto.h>
+#include <inc/hw_memmap.h>
+#include <inc/hw_types.h>
+#include <driverLib/crypto.h>
+#include <driverLib/prcm.h>
+#define AES128_KEY_AREA				CRYPTO_KEY_AREA_0
+#define AES128_ENGINE_POLLS			10000			// a block takes well under 100 polls
+#elif AES128_BACKEND == AES128_ROM
+#include <driverLib/rom_crypto.h>
+#endif
+
+// S-box (flash), also needed for provisioning with the engine and the ROM
+static const uint8_t aes128Sbox[256] = {
+  0x63, 0x7c, 0x77, 0x7b, 0xf2, 0x6b, 0x6f, 0xc5, 0x30, 0x01, 0x67, 0x2b, 0xfe, 0xd7, 0xab, 0x76,
+  0xca, 0x82, 0xc9, 0x7d, 0xfa, 0x59, 0x47, 0xf0, 0xad, 0xd4, 0xa2, 0xaf, 0x9c, 0xa4, 0x72, 0xc0,
+  0xb7, 0xfd, 0x93, 0x26, 0x36, 0x3f, 0xf7, 0xcc, 0x34, 0xa5, 0xe5, 0xf1, 0x71, 0xd8, 0x31, 0x15,
+  0x04, 0xc7, 0x23, 0xc3, 0x18, 0x96, 0x05, 0x9a, 0x07, 0x12, 0x80, 0xe2, 0xeb, 0x27, 0xb2, 0x75,
+  0x09, 0x83, 0x2c, 0x1a, 0x1b, 0x6e, 0x5a, 0xa0, 0x52, 0x3b, 0xd6, 0xb3, 0x29, 0xe3, 0x2f, 0x84,
+  0x53, 0xd1, 0x00, 0xed, 0x20, 0xfc, 0xb1, 0x5b, 0x6a, 0xcb, 0xbe, 0x39, 0x4a, 0x4c, 0x58, 0xcf,
+  0xd0, 0xef, 0xaa, 0xfb, 0x43, 0x4d, 0x33, 0x85, 0x45, 0xf9, 0x02, 0x7f, 0x50, 0x3c, 0x9f, 0xa8,
+  0x51, 0xa3, 0x40, 0x8f, 0x92, 0x9d, 0x38, 0xf5, 0xbc, 0xb6, 0xda, 0x21, 0x10, 0xff, 0xf3, 0xd2,
+  0xcd, 0x0c, 0x13, 0xec, 0x5f, 0x97, 0x44, 0x17, 0xc4, 0xa7, 0x7e, 0x3d, 0x64, 0x5d, 0x19, 0x73,
+  0x60, 0x81, 0x4f, 0xdc, 0x22, 0x2a, 0x90, 0x88, 0x46, 0xee, 0xb8, 0x14, 0xde, 0x5e, 0x0b, 0xdb,
+  0xe0, 0x32, 0x3a, 0x0a, 0x49, 0x06, 0x24, 0x5c, 0xc2, 0xd3, 0xac, 0x62, 0x91, 0x95, 0xe4, 0x79,
+  0xe7, 0xc8, 0x37, 0x6d, 0x8d, 0xd5, 0x4e, 0xa9, 0x6c, 0x56, 0xf4, 0xea, 0x65, 0x7a, 0xae, 0x08,
+  0xba, 0x78, 0x25, 0x2e, 0x1c, 0xa6, 0xb4, 0xc6, 0xe8, 0xdd, 0x74, 0x1f, 0x4b, 0xbd, 0x8b, 0x8a,
+  0x70, 0x3e, 0xb5, 0x66, 0x48, 0x03, 0xf6, 0x0e, 0x61, 0x35, 0x57, 0xb9, 0x86, 0xc1, 0x1d, 0x9e,
+  0xe1, 0xf8, 0x98, 0x11, 0x69, 0xd9, 0x8e, 0x94, 0x9b, 0x1e, 0x87, 0xe9, 0xce, 0x55, 0x28, 0xdf,
+  0x8c, 0xa1, 0x89, 0x0d, 0xbf, 0xe6, 0x42, 0x68, 0x41, 0x99, 0x2d, 0x0f, 0xb0, 0x54, 0xbb, 0x16
+};
+
+#define aes128Xtime(x)				((uint8_t)(((x) << 1) ^ (((x) & 0x80) ? 0x1b : 0)))
+
+
+// Key expansion, one round key at a time (FIPS-197 5.2)
+void aes128KeyStep(uint8_t *roundKey, uint8_t round) {
+  uint8_t t[4];
+  uint8_t rcon = 0x01, i;
+
+  for(i = 1; i < round; i++) {
+    rcon = aes128Xtime(rcon);
+  }
+  t[0] = aes128Sbox[roundKey[13]] ^ rcon;
+  t[1] = aes128Sbox[roundKey[14]];
+  t[2] = aes128Sbox[roundKey[15]];
+  t[3] = aes128Sbox[roundKey[12]];
+  for(i = 0; i < 16; i++) {
+    roundKey[i] ^= t[i % 4];
+    t[i % 4] = roundKey[i];
+  }
+}
+
+// CMAC subkey: shift left by one bit, xor R128 on carry (RFC 4493 2.3)
+void aes128CmacSubkey(uint8_t *l) {
+  uint8_t carry = l[0] & 0x80;
+  uint8_t i;
+
+  for(i = 0; i < 15; i++) {
+    l[i] = (l[i] << 1) | (l[i + 1] >> 7);
+  }
+  l[15] = (l[15] << 1) ^ (carry ? 0x87 : 0);
+}
+
+// The cipher rounds on a provisioned schedule, column-major state
+static void aes128Rounds(const uint8_t *rk, uint8_t *block) {
+  uint8_t t[16];
+  uint8_t round, i, c, all, a0;
+
+  for(i = 0; i < 16; i++) {
+    block[i] ^= rk[i];
+  }
+  for(round = 1; round <= AES128_ROUNDS; round++) {
+    // SubBytes and ShiftRows
+    for(c = 0; c < 4; c++) {
+      for(i = 0; i < 4; i++) {
+        t[c * 4 + i] = aes128Sbox[block[((c + i) % 4) * 4 + i]];
+      }
+    }
+    // MixColumns, not in the last round
+    if(round < AES128_ROUNDS) {
+      for(c = 0; c < 16; c += 4) {
+        all = t[c] ^ t[c + 1] ^ t[c + 2] ^ t[c + 3];
+        a0 = t[c];
+        t[c]     ^= all ^ aes128Xtime(t[c] ^ t[c + 1]);
+        t[c + 1] ^= all ^ aes128Xtime(t[c + 1] ^ t[c + 2]);
+        t[c + 2] ^= all ^ aes128Xtime(t[c + 2] ^ t[c + 3]);
+        t[c + 3] ^= all ^ aes128Xtime(t[c + 3] ^ a0);
+      }
+    }
+    for(i = 0; i < 16; i++) {
+      block[i] = t[i] ^ rk[round * 16 + i];
+    }
+  }
+}
+
+void aes128Expand(const uint8_t *key, aes128_key_t *k) {
+  uint8_t r;
+
+  memcpy(k->rk, key, AES128_KEY_LEN);
+  for(r = 1; r <= AES128_ROUNDS; r++) {
+    memcpy(&k->rk[r * 16], &k->rk[(r - 1) * 16], 16);
+    aes128KeyStep(&k->rk[r * 16], r);
+  }
+  memset(k->cmacK1, 0, 16);
+  aes128Rounds(k->rk, k->cmacK1);
+  aes128CmacSubkey(k->cmacK1);
+  memcpy(k->cmacK2, k->cmacK1, 16);
+  aes128CmacSubkey(k->cmacK2);
+}
+
+
+#if AES128_BACKEND == AES128_ENGINE
+static bool aes128PeriphOwned;
+
+// The engine sits in the PERIPH domain, the key RAM is lost with it: power up unless a
+// caller holds it already, load the key (key store DMA reads from word aligned RAM).
+// False if the key store failed
+static bool aes128EngineOpen(const aes128_key_t *k) {
+  uint32_t key[AES128_KEY_LEN / 4];
+
+  aes128PeriphOwned = powerAcquirePeriph();
+  PRCMPeripheralRunEnable(PRCM_PERIPH_CRYPTO);
+  PRCMLoadSet();
+  while(!PRCMLoadGet());
+
+  memcpy(key, k->rk, AES128_KEY_LEN);
+  return CRYPTOAesLoadKey(key, AES128_KEY_AREA) == AES_SUCCESS;
+}
+
+// Result or DMA bus error as in aes_alt.c, bounded: false on an error or if the engine
+// never finishes
+static bool aes128EngineWait(void) {
+  uint32_t status = 0, polls;
+
+  for(polls = 0; polls < AES128_ENGINE_POLLS &&
+      !(status & (CRYPTO_IRQSTAT_RESULT_AVAIL | CRYPTO_IRQSTAT_DMA_BUS_ERR)); polls++) {
+    status = HWREG(CRYPTO_BASE + CRYPTO_O_IRQSTAT);
+  }
+  return (status & (CRYPTO_IRQSTAT_RESULT_AVAIL | CRYPTO_IRQSTAT_DMA_BUS_ERR)) == CRYPTO_IRQSTAT_RESULT_AVAIL;
+}
+
+static void aes128EngineClose(void) {
+  PRCMPeripheralRunDisable(PRCM_PERIPH_CRYPTO);
+  PRCMLoadSet();
+  powerReleasePeriph(aes128PeriphOwned);
+}
+
+bool aes128Encrypt(const aes128_key_t *k, uint8_t *block) {
+  uint32_t b[4];
+  bool ok;
+
+  memcpy(b, block, 16);
+  ok = aes128EngineOpen(k) &&
+       CRYPTOAesEcb(b, b, AES128_KEY_AREA, true, false) == AES_SUCCESS &&
+       aes128EngineWait() && CRYPTOAesEcbStatus() == AES_SUCCESS;
+  if(ok) {
+    CRYPTOAesEcbFinish();
+    memcpy(block, b, 16);
+  }
+  aes128EngineClose();
+  return ok;
+}
+
+bool aes128CcmMic(const aes128_key_t *k, const uint8_t *nonce, const uint8_t *aad, uint8_t aadLen,
+                  uint8_t *mic, uint8_t micLen) {
+  uint32_t tag[4];
+  bool ok;
+
+  ok = aes128EngineOpen(k) &&
+       CRYPTOCcmAuthEncrypt(false, micLen, (uint32_t*)nonce, NULL, 0,
+                            (uint32_t*)aad, aadLen, AES128_KEY_AREA, 2, false) == AES_SUCCESS &&
+       aes128EngineWait() && CRYPTOCcmAuthEncryptStatus() == AES_SUCCESS &&
+       CRYPTOCcmAuthEncryptResultGet(micLen, tag) == AES_SUCCESS;
+  if(ok) {
+    memcpy(mic, tag, micLen);
+  }
+  aes128EngineClose();
+  return ok;
+}
+
+#elif AES128_BACKEND == AES128_ROM
+// The ROM routines take non-const pointers. Only the key goes through a RAM copy (it may
+// be in flash), nonce and additional data are read only
+
+bool aes128Encrypt(const aes128_key_t *k, uint8_t *block) {
+  uint8_t key[AES128_KEY_LEN];
+
+  memcpy(key, k->rk, AES128_KEY_LEN);
+  AES_ECB_EncryptData(block, 16, key);
+  return true;
+}
+
+bool aes128CcmMic(const aes128_key_t *k, const uint8_t *nonce, const uint8_t *aad, uint8_t aadLen,
+                  uint8_t *mic, uint8_t micLen) {
+  uint8_t key[AES128_KEY_LEN];
+  uint8_t tag[16], none = 0;
+
+  memcpy(key, k->rk, AES128_KEY_LEN);
+  if(AES_CCM_EncryptData(false, micLen, (uint8_t*)nonce, &none, 0, (uint8_t*)aad, aadLen, key, tag, 2) != 0) {
+    return false;
+  }
+  memcpy(mic, tag, micLen);
+  return true;
+}
+
+#else
+bool aes128Encrypt(const aes128_key_t *k, uint8_t *block) {
+  aes128Rounds(k->rk, block);
+  return true;
+}
+
+// CBC-MAC over B0 and the length-prefixed additional data, encrypted with counter block A0
+bool aes128CcmMic(const aes128_key_t *k, const uint8_t *nonce, const uint8_t *aad, uint8_t aadLen,
+                  uint8_t *mic, uint8_t micLen) {
+  uint8_t x[16], a[16];
+  uint8_t i, pos;
+
+  // B0: flags (Adata, M, L = 2), nonce, message length 0
+  x[0] = (aadLen ? 0x40 : 0) | (((micLen - 2) / 2) << 3) | (2 - 1);
+  memcpy(&x[1], nonce, AES128_CCM_NONCE_LEN);
+  x[14] = 0;
+  x[15] = 0;
+  aes128Encrypt(k, x);
+
+  // additional data: 2 byte length, data, zero padded to the block
+  if(aadLen > 0) {
+    x[1] ^= aadLen;
+    pos = 2;
+    for(i = 0; i < aadLen; i++) {
+      x[pos++] ^= aad[i];
+      if(pos == 16) {
+        aes128Encrypt(k, x);
+        pos = 0;
+      }
+    }
+    if(pos != 0) {
+      aes128Encrypt(k, x);
+    }
+  }
+
+  // A0: flags (L = 2), nonce, counter 0
+  a[0] = 2 - 1;
+  memcpy(&a[1], nonce, AES128_CCM_NONCE_LEN);
+  a[14] = 0;
+  a[15] = 0;
+  aes128Encrypt(k, a);
+
+  for(i = 0; i < micLen; i++) {
+    mic[i] = x[i] ^ a[i];
+  }
+  return true;
+}
+#endif
+
+
+// Encrypt-only modes on aes128Encrypt(), all backends
+
+bool aes128Ctr(const aes128_key_t *k, uint8_t *counter, uint8_t *data, uint8_t len) {
+  uint8_t s[16];
+  uint8_t i, n;
+
+  while(len > 0) {
+    memcpy(s, counter, 16);
+    if(!aes128Encrypt(k, s)) {
+      return false;
+    }
+    for(i = 16; i > 0 && ++counter[i - 1] == 0; i--);
+    n = len < 16 ? len : 16;
+    for(i = 0; i < n; i++) {
+      data[i] ^= s[i];
+    }
+    data += n;
+    len -= n;
+  }
+  return true;
+}
+
+// CBC-MAC, last block xored with K1 if complete, else padded (10..0) and xored with K2
+bool aes128Cmac(const aes128_key_t *k, const uint8_t *msg, uint8_t len, uint8_t *mac, uint8_t macLen) {
+  uint8_t x[16];
+  uint8_t i;
+
+  memset(x, 0, 16);
+  for(; len > 16; msg += 16, len -= 16) {
+    for(i = 0; i < 16; i++) {
+      x[i] ^= msg[i];
+    }
+    if(!aes128Encrypt(k, x)) {
+      return false;
+    }
+  }
+  for(i = 0; i < len; i++) {
+    x[i] ^= msg[i];
+  }
+  if(len == 16) {
+    for(i = 0; i < 16; i++) {
+      x[i] ^= k->cmacK1[i];
+    }
+  } else {
+    x[len] ^= 0x80;
+    for(i = 0; i < 16; i++) {
+      x[i] ^= k->cmacK2[i];
+    }
+  }
+  if(!aes128Encrypt(k, x)) {
+    return false;
+  }
+  memcpy(mac, x, macLen);
+  return true;
+}
@@ -0,0 +1,60 @@
+/*
+ * aes128.h
+ *
+ * AES-128 for payload encryption and authentication (AES128_BACKEND in config.h)
+ * -------------------------------------------------------------------------------
+ * One interface, three implementations:
+ *   AES128_ENGINE  crypto engine (driverLib/crypto.c), PERIPH domain powered per call
+ *   AES128_ROM     AES in the CC26xx ROM (driverLib/rom_crypto.c), runs on the CPU
+ *   AES128_SOFT    portable C, always used on the host. Same results as the ROM
+ *                  (FIPS-197 / RFC 3610), the gateway code is checked against it.
+ *                  Encrypt only, runs from the provisioned round keys: no key
+ *                  expansion per call, no schedule on the stack
+ * None of them links mbedtls: aes.c is left to the host and aes_bench.c, its generated
+ * tables (FSb/FT0-3/RSb/RT0-3/RCON, 8744 bytes of .bss) no longer take target RAM.
+ * Flash: AES128_ROM adds the wrappers only, AES128_SOFT one 256 byte S-box.
+ *
+ * Keys are aes128_key_t records, provisioned once (auth.c keeps its record in the auth
+ * flash page): round keys 0..10 (round key 0 is the key, which the engine and the ROM
+ * use) and the CMAC subkeys. Record update one round key at a time with
+ * aes128KeyStep() / aes128CmacSubkey(), 16 bytes of RAM.
+ */
+
+#ifndef AES128_H_
+#define AES128_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#define AES128_ENGINE				0
+#define AES128_ROM					1
+#define AES128_SOFT					2
+
+#define AES128_KEY_LEN				16
+#define AES128_ROUNDS				10
+#define AES128_CCM_NONCE_LEN		13				// L = 2
+
+typedef struct {
+  uint8_t rk[(AES128_ROUNDS + 1) * 16];			// round keys, rk[0..15] is the key
+  uint8_t cmacK1[16];								// CMAC subkeys (RFC 4493)
+  uint8_t cmacK2[16];
+} aes128_key_t;
+
+
+// * Functions
+// ------------
+// provisioning
+void aes128KeyStep(uint8_t *roundKey, uint8_t round);		// round key round - 1 -> round, in place
+void aes128CmacSubkey(uint8_t *l);							// L -> K1, K1 -> K2, in place
+void aes128Expand(const uint8_t *key, aes128_key_t *k);		// whole record in RAM (host)
+
+// false if the engine or the ROM failed (key store, DMA, timeout): output not written
+bool aes128Encrypt(const aes128_key_t *k, uint8_t *block);	// one block, in place
+// CTR, in place; counter: 16 byte counter block, incremented (big endian) per block
+bool aes128Ctr(const aes128_key_t *k, uint8_t *counter, uint8_t *data, uint8_t len);
+bool aes128Cmac(const aes128_key_t *k, const uint8_t *msg, uint8_t len, uint8_t *mac, uint8_t macLen);
+// CCM MIC without payload (authentication only, L = 2, micLen 4..16 even)
+bool aes128CcmMic(const aes128_key_t *k, const uint8_t *nonce, const uint8_t *aad, uint8_t aadLen,
+                  uint8_t *mic, uint8_t micLen);
+
+#endif /* AES128_H_ */
@@ -0,0 +1,327 @@
+/*
+ * aes_alt.c
+ *
+ * mbedtls AES on the CC26xx crypto engine (MBEDTLS_AES_ALT, see mbedtls/aes_alt.h).
+ * ECB, CBC and CTR buffers go to the engine as one DMA job (AESCTL programmed directly,
+ * driverLib/crypto.c only has single block ECB and CCM), CFB runs block by block. The
+ * engine does AES-128 only. Without MBEDTLS_AES_ALT aes.c is the implementation (host).
+ */
+
+#if !defined(MBEDTLS_CONFIG_FILE)
+#include "mbedtls/config.h"
+#else
+#include MBEDTLS_CONFIG_FILE
+#endif
+
+#if defined(MBEDTLS_AES_C) && defined(MBEDTLS_AES_ALT)
+
+#include <string.h>
+#include "mbedtls/aes.h"
+#include "system.h"
+#include <inc/hw_crypto.h>
+#include <inc/hw_memmap.h>
+#include <inc/hw_types.h>
+#include <driverLib/crypto.h>
+#include <driverLib/prcm.h>
+
+#define AES_ALT_KEY_AREA			CRYPTO_KEY_AREA_1	// area 0: auth.c
+#define AES_ALT_DMA_MAX				0xFFF0				// DMA length field is 16 bits, whole blocks
+
+#define AES_ALT_ECB					0
+#define AES_ALT_CBC					CRYPTO_AESCTL_CBC
+#define AES_ALT_CTR					(CRYPTO_AESCTL_CTR | (3 << CRYPTO_AESCTL_CTR_WIDTH_S))	// 128 bit counter as aes.c
+#define AES_ALT_ENCRYPT				(CRYPTO_AESCTL_DIR | (1 << CRYPTO_AESCTL_KEY_SIZE_S))
+#define AES_ALT_DECRYPT				(1 << CRYPTO_AESCTL_KEY_SIZE_S)
+
+#define aesAligned(p)				(((uint32_t)(p) & 3) == 0)
+
+static bool aesPeriphOwned;
+
+
+// The engine sits in the PERIPH domain: power it only if nobody else did
+static void aesEngineOpen(void) {
+  aesPeriphOwned = powerAcquirePeriph();
+  PRCMPeripheralRunEnable(PRCM_PERIPH_CRYPTO);
+  PRCMLoadSet();
+  while(!PRCMLoadGet());
+}
+
+static void aesEngineClose(void) {
+  PRCMPeripheralRunDisable(PRCM_PERIPH_CRYPTO);
+  PRCMLoadSet();
+  powerReleasePeriph(aesPeriphOwned);
+}
+
+// One DMA job: len bytes of whole blocks, word aligned, in == out allowed. The key store
+// is loaded every time, it does not survive standby. iv: CBC IV or CTR counter block
+static int aesEngineRun(mbedtls_aes_context *ctx, uint32_t ctl, const uint32_t *iv,
+                        const void *in, void *out, uint32_t len) {
+  uint32_t status;
+
+  if(CRYPTOAesLoadKey(ctx->key, AES_ALT_KEY_AREA) != AES_SUCCESS) {
+    return MBEDTLS_ERR_AES_HW_ACCEL_FAILED;
+  }
+
+  HWREG(CRYPTO_BASE + CRYPTO_O_IRQTYPE) = CRYPTO_INT_LEVEL;
+  HWREG(CRYPTO_BASE + CRYPTO_O_IRQEN) = CRYPTO_IRQEN_RESULT_AVAIL;
+  HWREG(CRYPTO_BASE + CRYPTO_O_IRQCLR) = CRYPTO_IRQCLR_DMA_IN_DONE | CRYPTO_IRQCLR_RESULT_AVAIL;
+  HWREG(CRYPTO_BASE + CRYPTO_O_ALGSEL) = CRYPTO_ALGSEL_AES;
+
+  HWREG(CRYPTO_BASE + CRYPTO_O_KEYREADAREA) = AES_ALT_KEY_AREA;
+  while(HWREG(CRYPTO_BASE + CRYPTO_O_KEYREADAREA) & CRYPTO_KEYREADAREA_BUSY);
+  if(HWREG(CRYPTO_BASE + CRYPTO_O_IRQSTAT) & CRYPTO_KEY_ST_RD_ERR) {
+    return MBEDTLS_ERR_AES_HW_ACCEL_FAILED;
+  }
+
+  if(ctl & (CRYPTO_AESCTL_CBC | CRYPTO_AESCTL_CTR)) {
+    HWREG(CRYPTO_BASE + CRYPTO_O_AESIV0) = iv[0];
+    HWREG(CRYPTO_BASE + CRYPTO_O_AESIV1) = iv[1];
+    HWREG(CRYPTO_BASE + CRYPTO_O_AESIV2) = iv[2];
+    HWREG(CRYPTO_BASE + CRYPTO_O_AESIV3) = iv[3];
+  }
+  HWREG(CRYPTO_BASE + CRYPTO_O_AESCTL) = ctl;
+  HWREG(CRYPTO_BASE + CRYPTO_O_AESDATALEN0) = len;
+  HWREG(CRYPTO_BASE + CRYPTO_O_AESDATALEN1) = 0;
+
+  // channel 0 feeds the engine, channel 1 writes the result back
+  HWREGBITW(CRYPTO_BASE + CRYPTO_O_DMACH0CTL, CRYPTO_DMACH0CTL_EN_BITN) = 1;
+  HWREG(CRYPTO_BASE + CRYPTO_O_DMACH0EXTADDR) = (uint32_t)in;
+  HWREG(CRYPTO_BASE + CRYPTO_O_DMACH0LEN) = len;
+  HWREGBITW(CRYPTO_BASE + CRYPTO_O_DMACH1CTL, CRYPTO_DMACH1CTL_EN_BITN) = 1;
+  HWREG(CRYPTO_BASE + CRYPTO_O_DMACH1EXTADDR) = (uint32_t)out;
+  HWREG(CRYPTO_BASE + CRYPTO_O_DMACH1LEN) = len;
+
+  do {
+    status = HWREG(CRYPTO_BASE + CRYPTO_O_IRQSTAT);
+  } while(!(status & (CRYPTO_IRQSTAT_RESULT_AVAIL | CRYPTO_IRQSTAT_DMA_BUS_ERR)));
+
+  HWREG(CRYPTO_BASE + CRYPTO_O_IRQCLR) = CRYPTO_IRQCLR_DMA_IN_DONE | CRYPTO_IRQCLR_RESULT_AVAIL;
+  HWREG(CRYPTO_BASE + CRYPTO_O_AESCTL) = 0;
+  HWREG(CRYPTO_BASE + CRYPTO_O_ALGSEL) = 0;
+  return (status & CRYPTO_IRQSTAT_DMA_BUS_ERR) ? MBEDTLS_ERR_AES_HW_ACCEL_FAILED : 0;
+}
+
+// counter block + blocks, big endian over all 16 bytes (wraps like aes.c)
+static void aesCounterAdd(unsigned char ctr[16], uint32_t blocks) {
+  int i;
+
+  for(i = 15; i >= 0 && blocks != 0; i--) {
+    blocks += ctr[i];
+    ctr[i] = (unsigned char)blocks;
+    blocks >>= 8;
+  }
+}
+
+// len bytes of whole blocks, engine open. Word aligned buffers go out in DMA_MAX jobs,
+// others one block at a time through an aligned copy. iv is left as the next call
+// needs it: CBC last ciphertext block, CTR counter after the last block
+static int aesEngineBlocks(mbedtls_aes_context *ctx, uint32_t ctl, unsigned char iv[16],
+                           const unsigned char *in, unsigned char *out, size_t len) {
+  uint32_t block[4], ivw[4], last[4];
+  bool bounce = !aesAligned(in) || !aesAligned(out);
+  uint32_t n;
+  int ret = 0;
+
+  while(len > 0 && ret == 0) {
+    n = bounce ? 16 : (len > AES_ALT_DMA_MAX ? AES_ALT_DMA_MAX : len);
+    if(iv != NULL) {
+      memcpy(ivw, iv, 16);
+      memcpy(last, &in[n - 16], 16);				// CBC decrypt in place overwrites it
+    }
+    if(bounce) {
+      memcpy(block, in, 16);
+      ret = aesEngineRun(ctx, ctl, ivw, block, block, 16);
+      memcpy(out, block, 16);
+    } else {
+      ret = aesEngineRun(ctx, ctl, ivw, in, out, n);
+    }
+
+    if(ctl & CRYPTO_AESCTL_CBC) {
+      memcpy(iv, (ctl & CRYPTO_AESCTL_DIR) ? (const void*)&out[n - 16] : (const void*)last, 16);
+    } else if(ctl & CRYPTO_AESCTL_CTR) {
+      aesCounterAdd(iv, n / 16);
+    }
+    in += n;
+    out += n;
+    len -= n;
+  }
+  return ret;
+}
+
+
+void mbedtls_aes_init( mbedtls_aes_context *ctx ) {
+  memset(ctx, 0, sizeof(mbedtls_aes_context));
+}
+
+void mbedtls_aes_free( mbedtls_aes_context *ctx ) {
+  volatile uint32_t *p;
+
+  if(ctx == NULL) {
+    return;
+  }
+  for(p = ctx->key; p < ctx->key + 4; p++) {
+    *p = 0;
+  }
+}
+
+int mbedtls_aes_setkey_enc( mbedtls_aes_context *ctx, const unsigned char *key,
+                    unsigned int keybits ) {
+  if(keybits != 128) {
+    return MBEDTLS_ERR_AES_INVALID_KEY_LENGTH;
+  }
+  memcpy(ctx->key, key, 16);
+  return 0;
+}
+
+// the engine derives the decryption key schedule itself
+int mbedtls_aes_setkey_dec( mbedtls_aes_context *ctx, const unsigned char *key,
+                    unsigned int keybits ) {
+  return mbedtls_aes_setkey_enc(ctx, key, keybits);
+}
+
+int mbedtls_aes_crypt_ecb( mbedtls_aes_context *ctx,
+                    int mode,
+                    const unsigned char input[16],
+                    unsigned char output[16] ) {
+  int ret;
+
+  aesEngineOpen();
+  ret = aesEngineBlocks(ctx, AES_ALT_ECB | (mode == MBEDTLS_AES_ENCRYPT ? AES_ALT_ENCRYPT : AES_ALT_DECRYPT),
+                        NULL, input, output, 16);
+  aesEngineClose();
+  return ret;
+}
+
+void mbedtls_aes_encrypt( mbedtls_aes_context *ctx,
+                          const unsigned char input[16],
+                          unsigned char output[16] ) {
+  mbedtls_aes_crypt_ecb(ctx, MBEDTLS_AES_ENCRYPT, input, output);
+}
+
+void mbedtls_aes_decrypt( mbedtls_aes_context *ctx,
+                          const unsigned char input[16],
+                          unsigned char output[16] ) {
+  mbedtls_aes_crypt_ecb(ctx, MBEDTLS_AES_DECRYPT, input, output);
+}
+
+#if defined(MBEDTLS_CIPHER_MODE_CBC)
+int mbedtls_aes_crypt_cbc( mbedtls_aes_context *ctx,
+                    int mode,
+                    size_t length,
+                    unsigned char iv[16],
+                    const unsigned char *input,
+                    unsigned char *output ) {
+  int ret;
+
+  if(length % 16) {
+    return MBEDTLS_ERR_AES_INVALID_INPUT_LENGTH;
+  }
+  aesEngineOpen();
+  ret = aesEngineBlocks(ctx, AES_ALT_CBC | (mode == MBEDTLS_AES_ENCRYPT ? AES_ALT_ENCRYPT : AES_ALT_DECRYPT),
+                        iv, input, output, length);
+  aesEngineClose();
+  return ret;
+}
+#endif /* MBEDTLS_CIPHER_MODE_CBC */
+
+#if defined(MBEDTLS_CIPHER_MODE_CFB)
+// CFB on single ECB blocks, same semantics as aes.c
+int mbedtls_aes_crypt_cfb128( mbedtls_aes_context *ctx,
+                       int mode,
+                       size_t length,
+                       size_t *iv_off,
+                       unsigned char iv[16],
+                       const unsigned char *input,
+                       unsigned char *output ) {
+  size_t n = *iv_off;
+  unsigned char c;
+  int ret = 0;
+
+  aesEngineOpen();
+  while(length-- && ret == 0) {
+    if(n == 0) {
+      ret = aesEngineBlocks(ctx, AES_ALT_ECB | AES_ALT_ENCRYPT, NULL, iv, iv, 16);
+    }
+    c = *input++;
+    *output++ = (unsigned char)(c ^ iv[n]);
+    iv[n] = (mode == MBEDTLS_AES_ENCRYPT) ? output[-1] : c;
+    n = (n + 1) & 0x0F;
+  }
+  aesEngineClose();
+
+  *iv_off = n;
+  return ret;
+}
+
+int mbedtls_aes_crypt_cfb8( mbedtls_aes_context *ctx,
+                    int mode,
+                    size_t length,
+                    unsigned char iv[16],
+                    const unsigned char *input,
+                    unsigned char *output ) {
+  unsigned char c;
+  unsigned char ov[17];
+  int ret = 0;
+
+  aesEngineOpen();
+  while(length-- && ret == 0) {
+    memcpy(ov, iv, 16);
+    ret = aesEngineBlocks(ctx, AES_ALT_ECB | AES_ALT_ENCRYPT, NULL, iv, iv, 16);
+    if(mode == MBEDTLS_AES_DECRYPT) {
+      ov[16] = *input;
+    }
+    c = *output++ = (unsigned char)(iv[0] ^ *input++);
+    if(mode == MBEDTLS_AES_ENCRYPT) {
+      ov[16] = c;
+    }
+    memcpy(iv, ov + 1, 16);
+  }
+  aesEngineClose();
+  return ret;
+}
+#endif /* MBEDTLS_CIPHER_MODE_CFB */
+
+#if defined(MBEDTLS_CIPHER_MODE_CTR)
+// Leftover key stream first, whole blocks as one engine job, the tail from one more
+// key stream block kept in stream_block (nc_off as aes.c)
+int mbedtls_aes_crypt_ctr( mbedtls_aes_context *ctx,
+                       size_t length,
+                       size_t *nc_off,
+                       unsigned char nonce_counter[16],
+                       unsigned char stream_block[16],
+                       const unsigned char *input,
+                       unsigned char *output ) {
+  size_t n = *nc_off;
+  size_t full;
+  int ret = 0;
+
+  while(length > 0 && n != 0) {
+    *output++ = (unsigned char)(*input++ ^ stream_block[n]);
+    n = (n + 1) & 0x0F;
+    length--;
+  }
+
+  aesEngineOpen();
+  full = length & ~(size_t)0x0F;
+  if(full > 0) {
+    ret = aesEngineBlocks(ctx, AES_ALT_CTR | AES_ALT_ENCRYPT, nonce_counter, input, output, full);
+    input += full;
+    output += full;
+    length -= full;
+  }
+  if(length > 0 && ret == 0) {
+    ret = aesEngineBlocks(ctx, AES_ALT_ECB | AES_ALT_ENCRYPT, NULL, nonce_counter, stream_block, 16);
+    aesCounterAdd(nonce_counter, 1);
+    while(length-- > 0) {
+      *output++ = (unsigned char)(*input++ ^ stream_block[n]);
+      n++;
+    }
+  }
+  aesEngineClose();
+
+  *nc_off = n;
+  return ret;
+}
+#endif /* MBEDTLS_CIPHER_MODE_CTR */
+
+#endif /* MBEDTLS_AES_C && MBEDTLS_AES_ALT */
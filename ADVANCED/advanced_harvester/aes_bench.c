@@ -0,0 +1,110 @@
+/*
+ * aes_bench.c
+ *
+ * AES self test and cycles per byte, see aes_bench.h
+ */
+
+#include <string.h>
+#include <aes_bench.h>
+#include <config.h>
+#include "mbedtls/aes.h"
+#include <inc/hw_cpu_dwt.h>
+#include <inc/hw_cpu_scs.h>
+#include <inc/hw_memmap.h>
+#include <inc/hw_types.h>
+#include <driverLib/cpu.h>
+
+#if AES_BENCH
+
+#define AES_BENCH_ROUNDS			8				// per mode and size, result is the mean
+#define aesBenchCycles()			HWREG(CPU_DWT_BASE + CPU_DWT_O_CYCCNT)
+
+aes_bench_t g_aes_bench;
+
+static const uint16_t aesBenchSize[AES_BENCH_SIZES] = {16, 64, 256};
+static const unsigned char aesBenchKey[16] = {
+  0x2b, 0x7e, 0x15, 0x16, 0x28, 0xae, 0xd2, 0xa6, 0xab, 0xf7, 0x15, 0x88, 0x09, 0xcf, 0x4f, 0x3c
+};
+static uint32_t aesBenchBuf[256 / 4];				// word aligned: whole buffer in one engine job
+
+
+// Cycles of one call of mode on len bytes
+static uint32_t aesBenchRun(mbedtls_aes_context *ctx, uint8_t mode, uint16_t len) {
+  unsigned char *buf = (unsigned char*)aesBenchBuf;
+  unsigned char iv[16], stream[16];
+  size_t off = 0;
+  uint32_t start;
+  uint16_t i;
+
+  memset(iv, 0, sizeof(iv));
+  start = aesBenchCycles();
+  switch(mode) {
+  case AES_BENCH_ECB_ENC:
+  case AES_BENCH_ECB_DEC:
+    for(i = 0; i < len; i += 16) {
+      mbedtls_aes_crypt_ecb(ctx, mode == AES_BENCH_ECB_ENC ? MBEDTLS_AES_ENCRYPT : MBEDTLS_AES_DECRYPT,
+                            &buf[i], &buf[i]);
+    }
+    break;
+  case AES_BENCH_CBC_ENC:
+  case AES_BENCH_CBC_DEC:
+    mbedtls_aes_crypt_cbc(ctx, mode == AES_BENCH_CBC_ENC ? MBEDTLS_AES_ENCRYPT : MBEDTLS_AES_DECRYPT,
+                          len, iv, buf, buf);
+    break;
+  case AES_BENCH_CTR:
+    mbedtls_aes_crypt_ctr(ctx, len, &off, iv, stream, buf, buf);
+    break;
+  case AES_BENCH_CFB128:
+    mbedtls_aes_crypt_cfb128(ctx, MBEDTLS_AES_ENCRYPT, len, &off, iv, buf, buf);
+    break;
+  }
+  return aesBenchCycles() - start;
+}
+
+void aesBench(void) {
+  mbedtls_aes_context ctx;
+  uint32_t start, sum;
+  uint8_t mode, size, r;
+
+  // DWT cycle counter, needs trace enabled
+  HWREG(CPU_SCS_BASE + CPU_SCS_O_DEMCR) |= CPU_SCS_DEMCR_TRCENA;
+  HWREG(CPU_DWT_BASE + CPU_DWT_O_CYCCNT) = 0;
+  HWREG(CPU_DWT_BASE + CPU_DWT_O_CTRL) |= CPU_DWT_CTRL_CYCCNTENA;
+
+  g_aes_bench.selfTest = mbedtls_aes_self_test(0);
+  g_aes_bench.ctxBytes = sizeof(mbedtls_aes_context);
+
+  CPUcpsid();										// no interrupts in the measurement
+  mbedtls_aes_init(&ctx);
+  start = aesBenchCycles();
+  mbedtls_aes_setkey_dec(&ctx, aesBenchKey, 128);
+  g_aes_bench.keyCycles[1] = aesBenchCycles() - start;
+  start = aesBenchCycles();
+  mbedtls_aes_setkey_enc(&ctx, aesBenchKey, 128);
+  g_aes_bench.keyCycles[0] = aesBenchCycles() - start;
+
+  memset(aesBenchBuf, 0x5A, sizeof(aesBenchBuf));
+  for(mode = 0; mode < AES_BENCH_MODES; mode++) {
+    // decryption needs the decryption key schedule in aes.c
+    if(mode == AES_BENCH_ECB_DEC) {
+      mbedtls_aes_setkey_dec(&ctx, aesBenchKey, 128);
+    } else if(mode == AES_BENCH_CBC_ENC) {
+      mbedtls_aes_setkey_enc(&ctx, aesBenchKey, 128);
+    } else if(mode == AES_BENCH_CBC_DEC) {
+      mbedtls_aes_setkey_dec(&ctx, aesBenchKey, 128);
+    } else if(mode == AES_BENCH_CTR) {
+      mbedtls_aes_setkey_enc(&ctx, aesBenchKey, 128);
+    }
+    for(size = 0; size < AES_BENCH_SIZES; size++) {
+      sum = 0;
+      for(r = 0; r < AES_BENCH_ROUNDS; r++) {
+        sum += aesBenchRun(&ctx, mode, aesBenchSize[size]);
+      }
+      g_aes_bench.cpb[mode][size] = sum * 100 / AES_BENCH_ROUNDS / aesBenchSize[size];
+    }
+  }
+  mbedtls_aes_free(&ctx);
+  CPUcpsie();
+}
+
+#endif
@@ -0,0 +1,44 @@
+/*
+ * aes_bench.h
+ *
+ * AES benchmark (AES_BENCH in config.h)
+ * -------------------------------------
+ * Runs once after reset: mbedtls_aes_self_test() on the linked AES (crypto engine with
+ * MBEDTLS_AES_ALT, aes.c without, see mbedtls/config.h), then cycles per byte for every
+ * mode and buffer size from the DWT cycle counter. Results in g_aes_bench, read them
+ * with the debugger. Build once per path to compare.
+ *
+ * Flash and RAM of a path come from the linker map: aes_alt.obj (+ driverLib crypto)
+ * or aes.obj. aes.c builds its tables in RAM (.bss, about 8.5 kB) unless
+ * MBEDTLS_AES_ROM_TABLES moves them to flash. RAM per context is ctxBytes.
+ */
+
+#ifndef AES_BENCH_H_
+#define AES_BENCH_H_
+
+#include <stdint.h>
+
+#define AES_BENCH_ECB_ENC			0
+#define AES_BENCH_ECB_DEC			1
+#define AES_BENCH_CBC_ENC			2
+#define AES_BENCH_CBC_DEC			3
+#define AES_BENCH_CTR				4
+#define AES_BENCH_CFB128			5
+#define AES_BENCH_MODES				6
+#define AES_BENCH_SIZES				3				// 16, 64, 256 bytes
+
+typedef struct {
+  int32_t selfTest;									// mbedtls_aes_self_test(), 0 = passed
+  uint32_t keyCycles[2];							// setkey_enc, setkey_dec
+  uint32_t ctxBytes;								// sizeof(mbedtls_aes_context)
+  uint32_t cpb[AES_BENCH_MODES][AES_BENCH_SIZES];	// cycles per byte x 100
+} aes_bench_t;
+
+extern aes_bench_t g_aes_bench;
+
+
+// * Functions
+// ------------
+void aesBench(void);								// once after reset, takes ~1 s with aes.c
+
+#endif /* AES_BENCH_H_ */
@@ -0,0 +1,192 @@
+/*
+ * auth.c
+ *
+ * Payload authentication, see auth.h
+ */
+
+#include <string.h>
+#include <auth.h>
+#include <config.h>
+#include "system.h"
+#include "radio.h"
+#include <inc/hw_memmap.h>
+#include <driverLib/aon_rtc.h>
+#include <driverLib/cpu.h>
+#include <driverLib/flash.h>
+#include "aes128.h"
+
+#define AUTH_MAGIC					0xA0C7C0DE
+#define AUTH_EPOCH_WORDS			((AUTH_PAGE_SIZE - AUTH_RECORD_LEN) / 4)
+
+// Per-device key at the start of the auth page, programmed after the image
+// (gateway/authkey.py), the image leaves the page alone
+#define authRecord					((const aes128_key_t*)AUTH_PAGE_BASE)		// rk[0..15] is the key
+#define authEpochBits				((volatile const uint32_t*)(AUTH_PAGE_BASE + AUTH_RECORD_LEN))
+
+// survives warm resets (.TI.noinit), magic tells a power-on
+#pragma NOINIT(authState)
+static struct {
+  uint32_t magic;
+  uint32_t counter;									// next nonce counter
+} authState;
+
+static bool authReady = false;
+static uint32_t authNonce[4];						// word aligned for the engine DMA (AES128_ENGINE)
+uint32_t g_auth_ticks = 0;
+uint32_t g_auth_seals = 0;
+
+
+// Program len bytes (words) of the auth page, true if they read back as data
+static bool authProgram(const void *data, uint32_t addr, uint32_t len) {
+  uint32_t status;
+
+  // no code may run from flash while it is programmed: no interrupts, no cache
+  CPUcpsid();
+  powerDisableCache();
+  status = FlashProgram((uint8_t*)data, addr, len);
+  powerEnableCache();
+  CPUcpsie();
+
+  return status == FAPI_STATUS_SUCCESS && memcmp((const void*)addr, data, len) == 0;
+}
+
+// Take the next epoch: clear one more bit of the page (LSB first, word by word).
+// Returns the new epoch, 0 if the page is used up or programming failed
+static uint32_t authEpochNext(void) {
+  uint32_t i, word;
+  uint8_t z;
+
+  for(i = 0; i < AUTH_EPOCH_WORDS && authEpochBits[i] == 0; i++);
+  if(i == AUTH_EPOCH_WORDS) {
+    return 0;
+  }
+  word = authEpochBits[i] << 1;
+  if(!authProgram(&word, (uint32_t)&authEpochBits[i], 4)) {
+    return 0;
+  }
+  for(z = 0; z < 32 && !(word & ((uint32_t)1 << z)); z++);
+  return i * 32 + z;
+}
+
+// One block of the key record: program it if erased, then it has to match
+static bool authStore(const uint8_t *block, const uint8_t *dst) {
+  uint8_t i;
+
+  for(i = 0; i < 16 && dst[i] == 0xFF; i++);
+  if(i == 16 && !authProgram(block, (uint32_t)dst, 16)) {
+    return false;
+  }
+  return memcmp(block, dst, 16) == 0;
+}
+
+// Provisioning of the key record (aes128.h) after a new key: round keys 1..10 and the
+// CMAC subkeys into the auth page, one block at a time (16 bytes of stack). After every
+// reset it only checks the record, false if no key is programmed or the record does not
+// belong to the key (programming interrupted)
+static bool authProvision(void) {
+  uint8_t block[16];
+  uint8_t r;
+
+  for(r = 0; r < AUTH_KEY_LEN && authRecord->rk[r] == 0xFF; r++);
+  if(r == AUTH_KEY_LEN) {
+    return false;									// erased: no key provisioned
+  }
+
+  memcpy(block, authRecord->rk, 16);
+  for(r = 1; r <= AES128_ROUNDS; r++) {
+    aes128KeyStep(block, r);
+    if(!authStore(block, &authRecord->rk[r * 16])) {
+      return false;
+    }
+  }
+
+  memset(block, 0, 16);
+  if(!aes128Encrypt(authRecord, block)) {		// L = E(K, 0) on the stored round keys
+    return false;
+  }
+  aes128CmacSubkey(block);
+  if(!authStore(block, authRecord->cmacK1)) {
+    return false;
+  }
+  aes128CmacSubkey(block);
+  return authStore(block, authRecord->cmacK2);
+}
+
+void authInit(void) {
+  uint32_t epoch;
+
+  if(!AUTH_PAYLOAD || !authProvision()) {
+    return;										// frames go out unsealed, gateway drops them
+  }
+  if(authState.magic != AUTH_MAGIC) {
+    // power-on: RAM content is random, continue in a fresh epoch
+    epoch = authEpochNext();
+    if(epoch == 0) {
+      return;										// frames go out unsealed, gateway drops them
+    }
+    authState.counter = epoch << 16;
+    authState.magic = AUTH_MAGIC;
+  }
+  authReady = true;
+}
+
+uint8_t authSeal(uint8_t *frame, uint8_t len) {
+  uint32_t start = AONRTCCurrentCompareValueGet();
+  uint8_t *nonce = (uint8_t*)authNonce;
+  uint32_t counter, epoch;
+  uint8_t lenByte;
+
+  if(!authReady || len + AUTH_TRAILER_LEN > ADVLEN) {
+    return len;
+  }
+
+  // packet number used up: next epoch
+  if((authState.counter & 0xFFFF) == 0xFFFF) {
+    epoch = authEpochNext();
+    if(epoch == 0) {
+      authReady = false;
+      return len;
+    }
+    authState.counter = epoch << 16;
+  }
+  counter = authState.counter++;
+
+  lenByte = frame[0];
+  frame[0] = len + AUTH_TRAILER_LEN - 1;
+  frame[len]     = counter >> 8;
+  frame[len + 1] = counter;
+
+  memcpy(nonce, radioDeviceAddress(), 6);
+  nonce[6]  = counter >> 24;
+  nonce[7]  = counter >> 16;
+  nonce[8]  = counter >> 8;
+  nonce[9]  = counter;
+  nonce[10] = 0;
+  nonce[11] = 0;
+  nonce[12] = 0;
+  if(!aes128CcmMic(authRecord, nonce, frame, len + AUTH_CTR_LEN, &frame[len + AUTH_CTR_LEN], AUTH_MIC_LEN)) {
+    frame[0] = lenByte;								// engine failed: unsealed, counter stays used
+    return len;
+  }
+
+  g_auth_ticks += AONRTCCurrentCompareValueGet() - start;
+  g_auth_seals++;
+  return len + AUTH_TRAILER_LEN;
+}
+
+uint16_t authEpoch(void) {
+  if(!authReady) {
+    return 0;
+  }
+  // authSeal() moves on first when the packet number is used up
+  return (authState.counter >> 16) + ((authState.counter & 0xFFFF) == 0xFFFF);
+}
+
+uint16_t authSealedEpoch(void) {
+  // the gateway knows it as lastCounter >> 16 (downlink sequence numbers)
+  return authReady ? authState.counter >> 16 : 0;
+}
+
+bool authCmac(const uint8_t *msg, uint8_t len, uint8_t *mac, uint8_t macLen) {
+  return authReady && aes128Cmac(authRecord, msg, len, mac, macLen);
+}
@@ -0,0 +1,68 @@
+/*
+ * auth.h
+ *
+ * Payload authentication (AUTH_PAYLOAD in config.h)
+ * -------------------------------------------------
+ * AES-CCM with a 4 byte MIC, authentication only: the frame stays readable, the whole
+ * AdvData (including the updated AD length and the counter) is the additional data.
+ * Computed by aes128.c: crypto engine, ROM or C (AES128_BACKEND).
+ *
+ * Sealed frame (BLE AdvData):
+ *   [0]        AD length, covers the trailer
+ *   [1..n-1]   frame as encoded (CRC-16 over the unsealed frame)
+ *   [n..n+1]   counter, low 16 bits (big endian)
+ *   [n+2..n+5] MIC
+ *
+ * Nonce (13 bytes): device address (6, as in AdvA) | counter (4, big endian) | 0 0 0
+ * counter = epoch << 16 | packet number. The epoch is the number of cleared bits in the
+ * auth flash page: one more bit after every power-on and every 65535 packets, so a
+ * counter value never comes back. Between power-ons the counter lives in no-init RAM.
+ *
+ * Auth page (AUTH_PAGE_BASE, see cc26x0f128.cmd):
+ *   [0..207]   key record (aes128_key_t): the per-device key, round keys and CMAC
+ *              subkeys programmed by authInit() on the first start with the key
+ *   [208..]    epoch bits
+ * The image contains no key. Provisioning, once per bike:
+ *   1. gateway/authkey.py <address> --hex key.hex: new random key, the address is
+ *      FCFG1 MAC_BLE_0 (AdvA), the gateway key file gets the line for auth.hpp
+ *   2. program the image, then key.hex (16 bytes at AUTH_PAGE_BASE); the flash
+ *      loader may erase only the sectors it writes
+ * Image updates keep the page. After anything that erases it (mass erase) the epochs
+ * start again: provision a new key (authkey.py --replace) and reset the gateway state of
+ * the bike, never program an old key again (nonce reuse). Without a key authInit() leaves
+ * frames unsealed and the gateway drops them.
+ *
+ * Gateway: gateway/auth.hpp rebuilds the counter from the last accepted one and
+ * rejects replays. It tries a limited number of later epochs; a bike that powered on more
+ * often unheard is resynced by the epoch field of the diagnostics frame (authEpoch()).
+ * Until then its frames fail verification. With the epoch bits used up (about 31000
+ * power-ons) frames go out unsealed for good, provision a new key.
+ */
+
+#ifndef AUTH_H_
+#define AUTH_H_
+
+#include <stdint.h>
+#include "aes128.h"
+
+#define AUTH_PAGE_BASE				0x0001E000		// flash page below CCFG
+#define AUTH_PAGE_SIZE				0x1000
+#define AUTH_KEY_LEN				AES128_KEY_LEN
+#define AUTH_RECORD_LEN				sizeof(aes128_key_t)	// 208, word aligned epoch bits
+#define AUTH_CTR_LEN				2
+#define AUTH_MIC_LEN				4
+#define AUTH_TRAILER_LEN			(AUTH_CTR_LEN + AUTH_MIC_LEN)
+
+extern uint32_t g_auth_ticks;						// sum of seal times [RTC ticks]
+extern uint32_t g_auth_seals;
+
+
+// * Functions
+// ------------
+void authInit(void);								// once after reset
+uint8_t authSeal(uint8_t *frame, uint8_t len);		// returns the new length, len if not sealed
+uint16_t authEpoch(void);							// epoch of the next sealed frame, 0 if unsealed
+uint16_t authSealedEpoch(void);						// epoch of the last sealed frame, 0 if unsealed
+bool authCmac(const uint8_t *msg, uint8_t len, uint8_t *mac, uint8_t macLen);	// device key (downlink.h)
+
+#endif /* AUTH_H_ */
@@ -73,7 +73,11 @@
 MEMORY
 {
     /* Application stored in and executes from internal flash */
-    FLASH (RX) : origin = FLASH_BASE, length = FLASH_SIZE
+    FLASH (RX) : origin = FLASH_BASE, length = FLASH_SIZE - 0x2000
+    /* Payload authentication: per-device key and nonce epoch bits (auth.h), not in the image */
+    FLASH_AUTH (R) : origin = FLASH_BASE + FLASH_SIZE - 0x2000, length = 0x1000
+    /* Last page: CCFG */
+    FLASH_CCFG (RX) : origin = FLASH_BASE + FLASH_SIZE - 0x1000, length = 0x1000
     /* Application uses internal RAM for data */
     SRAM (RWX) : origin = RAM_BASE, length = RAM_SIZE
     /* Application can use GPRAM region as RAM if cache is disabled in the CCFG
@@ -94,7 +98,7 @@ SECTIONS
     .pinit          :   > FLASH
     .init_array     :   > FLASH
     .emb_text       :   > FLASH
-    .ccfg           :   > FLASH (HIGH)
+    .ccfg           :   > FLASH_CCFG (HIGH)
 
     .vtable         :   > SRAM
     .vtable_ram     :   > SRAM
@@ -104,6 +108,7 @@ SECTIONS
     .sysmem         :   > SRAM
     .stack          :   > SRAM (HIGH)
     .nonretenvar    :   > SRAM
+    .TI.noinit      :   > SRAM
     .gpram          :   > GPRAM
 }
 
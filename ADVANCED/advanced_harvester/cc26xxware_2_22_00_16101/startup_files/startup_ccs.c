@@ -82,7 +82,7 @@ static void SysTickIntHandler( void );
 extern void SysTickIntHandler( void );
 //static void GPIOIntHandler( void );
 extern void GPIOIntHandler( void );
-static void I2CIntHandler( void );
+//static void I2CIntHandler( void );
 extern void I2CIntHandler( void );
 //static void RFCCPE1IntHandler( void );
 extern void RFCCPE1IntHandler( void );
@@ -323,7 +323,7 @@ static void DebugMonIntHandler( void ){ while(1) {}}
 static void PendSVIntHandler( void ){ while(1) {}}
 static void SysTickIntHandler( void ){ while(1) {}}
 //static void GPIOIntHandler( void ){ while(1) {}}  // see main
-static void I2CIntHandler( void ){ while(1) {}}
+//static void I2CIntHandler( void ){ while(1) {}}  // see board-i2c.c
 static void AONIntHandler( void ){ while(1) {}}
 
 static void UART0IntHandler( void ){ while(1) {}}
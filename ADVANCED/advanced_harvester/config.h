@@ -15,8 +15,8 @@
 #define WAKE_INTERVAL_MS 1000
 #define WAKE_INTERVAL_TICKS WAKE_INTERVAL_MS*65536/1000
 
-//Advertisment payload length in bytes
-#define ADVLEN 24
+//Advertisment payload length in bytes (BLE maximum, full format uses 24)
+#define ADVLEN 31
 
 
 // Sensortag IO Header
@@ -74,7 +74,151 @@ extern bool g_measurement_done;
 //* Radio data
 // ------------
 // Length of Data-Block
-#define ADVLEN 24
+#define ADVLEN 31
+
+// Link mode, selected at build time
+//  LINK_MODE_BLE:  BLE non-connectable adverts (any BLE scanner can receive)
+//  LINK_MODE_PROP: CMD_PROP_TX short packet on one frequency, own gateway only
+//                  (frame: preamble, sync word, length, payload, CRC-16; see gateway/prop_frame.h).
+//                  Builds only with SmartRF Studio settings, see prop_overrides.h
+#define LINK_MODE_BLE				0
+#define LINK_MODE_PROP				1
+#define LINK_MODE					LINK_MODE_BLE
+
+#define PROP_FREQUENCY_MHZ			2480			// center frequency of the proprietary link
+#define PROP_PREAMBLE_BYTES			4
+#define PROP_SYNC_WORD				0x930B51DE
+#define PROP_PKT_OFFSET				2				// payload without BLE AD length/type bytes
+#define PROP_PKT_LEN				(ADVLEN - 4)	// and without the checksum bytes (RF core adds CRC)
+
+// Uplink format: 0 = full 24 byte layout (gateway/schema/advanced_uplink.schema),
+// 1 = bit-packed variable length (payload_compact.h), advLen set per packet
+#define PAYLOAD_COMPACT				1
+
+// Frame types: speed frames (sequence, wheel period) between environment frames
+// (plus pressure, temperature), one ratio per speed band (see getData()): every
+// ratio-th transmission is an environment frame, 0 = never. Sensors are read only for these
+#define ENV_FRAME_RATIO				{0, 8, 4, 4, 2}
+
+// Cross-packet redundancy (compact format): each packet repeats sequence delta, wheel
+// period and pressure of the previous PAYLOAD_REDUNDANCY (0..2) packets, so the gateway
+// can fill isolated losses. With redundancy the middle band advertises on 2 channels
+// instead of 3 (delivery ratio see gateway/loss_sim.cpp)
+#define PAYLOAD_REDUNDANCY			1
+#define REDUNDANCY_2CH				(PAYLOAD_COMPACT && PAYLOAD_REDUNDANCY > 0)
+
+// Deadband: skip a transmission while wheel period, pressure and temperature are within
+// these thresholds of the last sent values. After DEADBAND_HEARTBEAT without a
+// transmission the next one is sent anyway
+#define DEADBAND_TX					1
+#define DEADBAND_TIMEDIFF			0x00000100		// wheel period [1/65536 s], ~3 % at 25 km/h
+#define DEADBAND_PRESSURE			20				// [Pa], ~1.7 m altitude
+#define DEADBAND_TEMPERATURE		50				// [0.01 degC]
+#define DEADBAND_HEARTBEAT			0x001E0000		// 30 s (RTC format, see WAKE_INTERVAL)
+
+// Ride aggregates (compact format, see ride.h): revolutions, moving time and min/max
+// wheel period since the last transmission, total distance and moving time. Wheel
+// periods above RIDE_MOVING_MAX count as standing still
+#define RIDE_AGGREGATES				PAYLOAD_COMPACT
+#define RIDE_MOVING_MAX				0x00040000		// 4 s, ~1.9 km/h at 2100 mm
+
+// Raw sensor mode (compact format): environment frames carry the 20 bit BMP280 ADC words,
+// the compensation runs on the gateway (gateway/bmp280.hpp). The calibration block goes
+// out in its own frame (gateway/schema/advanced_calib.schema) with the first transmission
+// after reset and then every SENSOR_RAW_CALIB_RATIO-th transmission
+#define SENSOR_RAW					0
+#define SENSOR_RAW_CALIB_RATIO		64
+#define DEADBAND_PRESSURE_RAW		120				// raw counts, ~20 Pa
+#define DEADBAND_TEMPERATURE_RAW	1600			// raw counts, ~0.5 degC
+
+// Sensor acquisition (acquire.h): the sensors of ACQUIRE_SENSORS convert in parallel, the
+// CPU waits in standby (idle with RF keep-alive) until the slowest is done and reads all of
+// them in one I2C session, before the RF core boots. 0: BMP280 read loop in setData(), the
+// old code. g_acquire_awake / g_acquire_span (CPU time, trigger to result) compare both.
+// HDC1000 humidity goes into the data frames, TMP007 and OPT3001 only into g_acquire
+#define SENSOR_ACQUIRE				1
+#define ACQUIRE_SENSORS				(ACQUIRE_BMP280)	// | ACQUIRE_HDC1000 | ACQUIRE_TMP007 | ACQUIRE_OPT3001
+
+// Sensor register shadow (sensor-common.c): the configuration registers last written, per
+// sensor, kept in standby. Configuration writes (TMP007 on/off, acquire batches) are skipped
+// when the register already holds the value, triggers always go out. Cleared after every
+// reset (sensorsInit() writes all) and per sensor on a bus error. g_diag.i2cSaved counts the bytes
+// skipped (diagnostics frame, per wake: i2cSaved / wakes)
+#define SENSOR_SHADOW				1
+
+// CPU-active cycles per acquireRead() into g_acquire_read_cycles, with ACQUIRE_BMP280 only
+// the cost of a BMP280 read (DWT cycle counter, stops while the CPU sleeps between the I2C
+// interrupts). Debug builds only
+#define ACQUIRE_CYCLES				0
+
+// Diagnostics frame (diag.h, gateway/schema/advanced_diag.schema): health counters after
+// reset and then every DIAG_FRAME_RATIO-th (max. 255) transmission. DIAG_EM8500 reads the
+// EM8500 status register for it (SPI, about 20 ms of CPU delays in spi.c)
+#define DIAG_FRAME					1
+#define DIAG_FRAME_RATIO			250
+#define DIAG_EM8500					0
+
+// Software coulomb counter (system.c): on-time per power state from RTC deltas times the
+// current table gives the charge per activity [uC]. Sent in the energy frame
+// (gateway/schema/advanced_energy.schema) after each diagnostics frame. If the average
+// current over ENERGY_WINDOW exceeds the budget of the speed band, getData() halves the
+// transmission rate and drops the burst-drain profile
+#define ENERGY_ACCOUNTING			1
+#define ENERGY_CURRENT_UA			{5550, 150, 2950, 550, 1}	// RF, XOSC, CPU, IDLE, standby [uA]: datasheet typ., calibrate per board
+#define ENERGY_WINDOW				0x00080000		// 8 s (RTC format)
+#define ENERGY_BUDGET_UA			{40, 80, 150, 250, 400}		// harvester output per speed band [uA]
+
+// Payload authentication (auth.h): AES-CCM MIC (4 bytes) and nonce counter appended to
+// every frame. Calibration, diagnostics and energy frames go out in two parts so that each
+// fits with the trailer. Needs DIAG_FRAME: the gateway resyncs the nonce epoch from it.
+// The key is not in the image, provision every bike (auth.h, gateway/authkey.py); without
+// one frames go out unsealed. g_auth_ticks / g_auth_seals compare the AES128_BACKEND choices
+#define AUTH_PAYLOAD				1
+
+// AES benchmark (aes_bench.h): self test and cycles per byte of the linked AES after reset,
+// crypto engine with MBEDTLS_AES_ALT (mbedtls/config.h), aes.c without. Debug builds only
+#define AES_BENCH					0
+
+// Sensor conversion benchmark (convert_bench.h): cycles per conversion of the integer
+// driver conversions against the float code they replaced, all raw codes, after reset.
+// Links the float runtime again. Debug builds only
+#define CONVERT_BENCH				0
+
+// AES-128 for the payload (aes128.h): AES128_SOFT (CPU, encrypt only, rounds on the key
+// record provisioned in the auth page), AES128_ROM (CPU, code in ROM, key setup per call)
+// or AES128_ENGINE (crypto engine, PERIPH powered and key loaded per call). None links
+// mbedtls, host builds always take AES128_SOFT
+#define AES128_BACKEND				AES128_SOFT
+
+// Advertising rounds (3 channels each) in the burst-drain radio profile
+#define BURST_DRAIN_ROUNDS			2
+
+// RF keep-alive: above this speed the RF core, XOSC and synthesizer stay on between
+// wakes (MCU idles instead of standby) and only the CMD_BLE_ADV_NC chain is sent
+#define RF_KEEP_ALIVE				1
+#define RF_KEEP_ALIVE_TIMEDIFF		0x00001E80		// wheel period < 40 km/h band
+
+// Downlink: scan window after every DOWNLINK_SCAN_RATIO-th transmission, only in
+// the high energy bands (wheel period < DOWNLINK_SCAN_TIMEDIFF). See downlink.h, frames
+// are authenticated with the AUTH_PAYLOAD key
+#define DOWNLINK_SCAN				(LINK_MODE == LINK_MODE_BLE && AUTH_PAYLOAD)
+#define DOWNLINK_SCAN_RATIO			8
+#define DOWNLINK_SCAN_TIMEDIFF		0x00002400		// higher 25 km/h
+#define DOWNLINK_SCAN_WINDOW_US		10000			// scan window length [us]
+
+// RAT slot transmit: the advertising chain starts with TRIG_ABSTIME on a fixed grid
+// (RAT_SLOT_PERIOD, RTC ticks) instead of TRIG_NOW, so the TX instant no longer
+// depends on sensor read time or XOSC settle. Each device uses one of RAT_SLOT_COUNT
+// phases (from its MAC), the gateway can open its receiver only in these slots.
+// Costs on average half a slot period of idle wait with the RF core on.
+#define RAT_SLOT_TX					0
+#define RAT_SLOT_PERIOD				0x00000400		// 15.6 ms, power of 2
+#define RAT_SLOT_COUNT				8				// phases per period
+#define RAT_SLOT_GUARD				0x00000040		// ~1 ms, earliest slot after now
+#define RAT_SLOT_SETUP_LEAD_US		250				// CMD_RADIO_SETUP starts this much before the slot
+
+// Default wheel circumference, replaced by downlink [mm]
+#define WHEEL_CIRCUMFERENCE_MM		2100
 
 //extern char payload[ADVLEN]; 						// data buffer
 //extern volatile bool rfBootDone;					// communication flag
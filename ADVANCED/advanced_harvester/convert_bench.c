@@ -0,0 +1,94 @@
+/*
+ * convert_bench.c
+ *
+ * Integer against float sensor conversions, see convert_bench.h
+ */
+
+#include <convert_bench.h>
+#include <config.h>
+#include "hdc-1000-sensor.h"
+#include "tmp-007-sensor.h"
+#include "opt-3001-sensor.h"
+#include <inc/hw_cpu_dwt.h>
+#include <inc/hw_cpu_scs.h>
+#include <inc/hw_memmap.h>
+#include <inc/hw_types.h>
+#include <driverLib/cpu.h>
+
+#if CONVERT_BENCH
+
+#include <convert_float.h>
+
+#define CONVERT_BENCH_CODES			65536UL
+#define convertBenchCycles()		HWREG(CPU_DWT_BASE + CPU_DWT_O_CYCCNT)
+
+convert_bench_t g_convert_bench;
+
+
+// Both results of one kernel on raw, cycles of each added to the sums
+static void convertBenchRun(uint8_t kernel, uint16_t raw, uint32_t overhead, int32_t fixed[2], int32_t ref[2],
+                            uint32_t *fixedSum, uint32_t *floatSum) {
+  uint32_t start, mid;
+
+  switch(kernel) {
+  case CONVERT_BENCH_HDC:
+    start = convertBenchCycles();
+    convert_raw_hdc_1000(raw, raw, &fixed[0], &fixed[1]);
+    mid = convertBenchCycles();
+    convertFloatHdc(raw, raw, &ref[0], &ref[1]);
+    break;
+  case CONVERT_BENCH_TMP:
+    start = convertBenchCycles();
+    convert_tmp_007(raw, raw, &fixed[0], &fixed[1]);
+    mid = convertBenchCycles();
+    convertFloatTmp(raw, raw, &ref[0], &ref[1]);
+    break;
+  default:
+    start = convertBenchCycles();
+    fixed[0] = (int32_t)convert_opt_3001(raw);
+    mid = convertBenchCycles();
+    ref[0] = (int32_t)convertFloatOpt(raw);
+    fixed[1] = ref[1] = 0;
+    break;
+  }
+  *floatSum += convertBenchCycles() - mid - overhead;
+  *fixedSum += mid - start - overhead;
+}
+
+void convertBench(void) {
+  int32_t fixed[2], ref[2];
+  uint32_t fixedSum, floatSum, overhead, diff, code;
+  uint8_t kernel, i;
+
+  // DWT cycle counter, needs trace enabled
+  HWREG(CPU_SCS_BASE + CPU_SCS_O_DEMCR) |= CPU_SCS_DEMCR_TRCENA;
+  HWREG(CPU_DWT_BASE + CPU_DWT_O_CYCCNT) = 0;
+  HWREG(CPU_DWT_BASE + CPU_DWT_O_CTRL) |= CPU_DWT_CTRL_CYCCNTENA;
+
+  CPUcpsid();										// no interrupts in the measurement
+  overhead = convertBenchCycles();					// of the counter reads around a call
+  overhead = convertBenchCycles() - overhead;
+
+  for(kernel = 0; kernel < CONVERT_BENCH_KERNELS; kernel++) {
+    fixedSum = floatSum = 0;
+    for(code = 0; code < CONVERT_BENCH_CODES; code++) {
+      convertBenchRun(kernel, (uint16_t)code, overhead, fixed, ref, &fixedSum, &floatSum);
+      for(i = 0; i < 2; i++) {
+        if(fixed[i] != ref[i]) {
+          diff = (fixed[i] > ref[i]) ? (uint32_t)(fixed[i] - ref[i]) : (uint32_t)(ref[i] - fixed[i]);
+          if(diff > g_convert_bench.maxDiff[kernel]) {
+            g_convert_bench.maxDiff[kernel] = diff;
+          }
+        }
+      }
+      if(fixed[0] != ref[0] || fixed[1] != ref[1]) {
+        g_convert_bench.differ[kernel]++;
+      }
+    }
+    g_convert_bench.fixedCycles[kernel] = fixedSum / CONVERT_BENCH_CODES;
+    g_convert_bench.floatCycles[kernel] = floatSum / CONVERT_BENCH_CODES;
+  }
+  CPUcpsie();
+}
+
+#endif
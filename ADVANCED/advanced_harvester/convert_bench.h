@@ -0,0 +1,42 @@
+/*
+ * convert_bench.h
+ *
+ * Sensor conversion benchmark (CONVERT_BENCH in config.h)
+ * -------------------------------------------------------
+ * Runs once after reset: the integer conversions of the drivers (convert_raw_hdc_1000(),
+ * convert_tmp_007(), convert_opt_3001()) and the float code they replaced (convert_float.h),
+ * for every raw code 0..65535, cycles per conversion from the DWT cycle counter. Both
+ * results of every code are compared on the way (runtime float of the TI RTS); the
+ * exhaustive check with the exact values is gateway/convert_check.c. Results in
+ * g_convert_bench, read them with the debugger.
+ *
+ * The float code links the float runtime again (__aeabi_f*, __aeabi_d*, exp2): the flash
+ * without it is the linker map of a build with CONVERT_BENCH 0 against one with 1, or
+ * against the last build with the float drivers.
+ */
+
+#ifndef CONVERT_BENCH_H_
+#define CONVERT_BENCH_H_
+
+#include <stdint.h>
+
+#define CONVERT_BENCH_HDC			0				// T and RH
+#define CONVERT_BENCH_TMP			1				// object and ambient
+#define CONVERT_BENCH_OPT			2
+#define CONVERT_BENCH_KERNELS		3
+
+typedef struct {
+  uint32_t fixedCycles[CONVERT_BENCH_KERNELS];		// per conversion, mean over all raw codes
+  uint32_t floatCycles[CONVERT_BENCH_KERNELS];
+  uint32_t differ[CONVERT_BENCH_KERNELS];			// raw codes with a different result
+  uint32_t maxDiff[CONVERT_BENCH_KERNELS];			// largest difference [LSB of the result]
+} convert_bench_t;
+
+extern convert_bench_t g_convert_bench;
+
+
+// * Functions
+// ------------
+void convertBench(void);							// once after reset, takes a few seconds
+
+#endif /* CONVERT_BENCH_H_ */
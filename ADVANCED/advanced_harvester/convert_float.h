@@ -0,0 +1,50 @@
+/*
+ * convert_float.h
+ *
+ * Float sensor conversions as they were in the drivers before the integer ones
+ * (convert_raw_hdc_1000(), convert_tmp_007(), convert_opt_3001()), results as value_*()
+ * returned them. Reference for the cycle bench on the target (convert_bench.c) and the
+ * exhaustive check on the host (gateway/convert_check.c); both include this file, the
+ * drivers do not. Links the float runtime (__aeabi_f*, __aeabi_d*, exp2).
+ */
+
+#ifndef CONVERT_FLOAT_H_
+#define CONVERT_FLOAT_H_
+
+#include <stdint.h>
+#include <math.h>
+
+static void convertFloatHdc(uint16_t temp_raw, uint16_t hum_raw, int32_t *temp, int32_t *hum) {
+  float t, h;
+
+  t = ((double)(int16_t)temp_raw / 65536) * 165 - 40;
+  h = ((double)hum_raw / 65536) * 100;
+  *temp = (int32_t)(t * 100);
+  *hum = (int32_t)(h * 100);
+}
+
+static void convertFloatTmp(uint16_t raw_temp, uint16_t raw_obj_temp, int32_t *obj, int32_t *amb) {
+  const float SCALE_LSB = 0.03125;
+  float t;
+  int it;
+
+  it = (int)((raw_obj_temp) >> 2);
+  t = ((float)(it)) * SCALE_LSB;
+  *obj = (int32_t)(t * 1000);
+
+  it = (int)((raw_temp) >> 2);
+  t = (float)it;
+  *amb = (int32_t)(t * SCALE_LSB * 1000);
+}
+
+static uint32_t convertFloatOpt(uint16_t raw_data) {
+  uint16_t e, m;
+  float v;
+
+  m = raw_data & 0x0FFF;
+  e = (raw_data & 0xF000) >> 12;
+  v = m * (0.01 * exp2(e));
+  return (uint32_t)(v * 100);
+}
+
+#endif /* CONVERT_FLOAT_H_ */
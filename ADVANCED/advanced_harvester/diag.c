@@ -0,0 +1,34 @@
+/*
+ * diag.c
+ *
+ * Health counters in no-init RAM, see diag.h
+ */
+
+#include <string.h>
+#include <diag.h>
+#include <driverLib/sys_ctrl.h>
+
+#define DIAG_MAGIC					0xD1A6C0DE
+
+// not cleared by the C startup (placed in .TI.noinit, see cc26x0f128.cmd)
+#pragma NOINIT(g_diag)
+diag_t g_diag;
+
+
+void diagInit(void) {
+
+  if(g_diag.magic != DIAG_MAGIC) {
+    // power-on: RAM content is random
+    memset(&g_diag, 0, sizeof(g_diag));
+    g_diag.magic = DIAG_MAGIC;
+  } else if(g_diag.resets < 0xFFFF) {
+    g_diag.resets++;
+  }
+  g_diag.resetCause = (uint8_t)SysCtrlResetSourceGet();
+}
+
+void diagWakeEnd(uint32_t duration) {
+  if(duration > g_diag.maxWake) {
+    g_diag.maxWake = duration;
+  }
+}
@@ -0,0 +1,44 @@
+/*
+ * diag.h
+ *
+ * Firmware health counters (DIAG_FRAME in config.h)
+ * -------------------------------------------------
+ * Kept in a no-init RAM section, so they survive standby and warm resets
+ * (watchdog, system reset, brown-out). A magic word tells a power-on from a
+ * warm reset, diagInit() counts the resets and stores the reset cause.
+ * Updates on the hot path are single increments (DIAG_COUNT).
+ *
+ * Sent every DIAG_FRAME_RATIO-th transmission in place of a data frame,
+ * format: gateway/schema/advanced_diag.schema, advanced_diag_2.schema
+ */
+
+#ifndef DIAG_H_
+#define DIAG_H_
+
+#include <stdint.h>
+
+typedef struct {
+  uint32_t magic;									// DIAG_MAGIC once initialised
+  uint32_t wakes;									// main loop iterations
+  uint32_t txWakes;									// wakes with a transmission
+  uint32_t sensorReads;								// BMP280 read cycles
+  uint16_t i2cFailures;								// failed register reads/writes
+  uint16_t bmpRetries;								// extra rounds of the BMP280 read loop
+  uint16_t i2cSaved;								// I2C bytes skipped by the register shadow (sensor-common.c)
+  uint32_t maxWake;									// longest wake [1/65536 s]
+  uint16_t resets;									// warm resets since power-on
+  uint8_t resetCause;								// SysCtrlResetSourceGet() of the last reset
+  uint8_t em8500Status;								// last EM8500 status register
+} diag_t;
+
+extern diag_t g_diag;
+
+#define DIAG_COUNT(field)		(g_diag.field++)
+
+
+// * Functions
+// ------------
+void diagInit(void);								// once after reset
+void diagWakeEnd(uint32_t duration);				// wake length in RTC ticks
+
+#endif /* DIAG_H_ */
@@ -0,0 +1,162 @@
+/*
+ * downlink.c
+ *
+ * Receive buffer and parser for the gateway configuration advert.
+ * Frame format see downlink.h
+ */
+
+#include <string.h>
+#include <config.h>
+#include <downlink.h>
+#include <auth.h>
+#include <radio_files/rfc_api/data_entry.h>
+
+// Received element: length byte, 2 byte BLE header, AdvA, AdvData
+#define RX_HEADER_LEN				3
+#define RX_ADVA_LEN					6
+#define RX_ADVDATA_MAX				31
+#define RX_ENTRY_DATA_LEN			(RX_HEADER_LEN + RX_ADVA_LEN + RX_ADVDATA_MAX)
+#define RX_ENTRY_WORDS				((8 + RX_ENTRY_DATA_LEN + 3) / 4)
+#define RX_ENTRIES					4			// other adverts in range may take entries too
+
+#define DOWNLINK_MAGIC				0xD0C7C0DE
+#define DOWNLINK_MAC_START			4			// CMAC over [4..23]
+#define DOWNLINK_MAC_LEN			(DOWNLINK_AD_LEN + 1 - DOWNLINK_TAG_LEN - DOWNLINK_MAC_START)
+
+// Defaults until a gateway sends new values (same as the former constants in getData())
+tuning_t g_tuning = {
+  .countMax           = {2, 2, 10, 100, 250},
+  .txPowerIB          = 0x21,				// 0 dBm
+  .txPowerGC          = 0x1,
+  .wheelCircumference = WHEEL_CIRCUMFERENCE_MM,
+};
+
+// Circular queue of general rx entries, data follows the 8 byte entry header
+#pragma data_alignment=4
+static uint32_t rxEntries[RX_ENTRIES][RX_ENTRY_WORDS];
+
+#pragma data_alignment=4
+dataQueue_t downlinkQueue = {
+  .pCurrEntry = (uint8_t*)rxEntries[0],
+  .pLastEntry = NULL,
+};
+
+// last accepted sequence number, survives warm resets (.TI.noinit), magic tells a power-on
+#pragma NOINIT(downlinkLast)
+static struct {
+  uint32_t magic;
+  uint32_t seq;
+} downlinkLast;
+
+
+// Tuning values of a frame within the accepted ranges (downlink.h)
+static bool downlinkValid(const uint8_t *ad) {
+  uint16_t wheel = ((uint16_t)ad[22] << 8) | ad[23];
+  uint8_t i;
+
+  for(i = 0; i < DOWNLINK_SPEED_BANDS; i++) {
+    if(ad[15 + i] < DOWNLINK_COUNT_MAX_MIN) {
+      return false;
+    }
+  }
+  return ad[20] >= DOWNLINK_TX_IB_MIN && ad[20] <= DOWNLINK_TX_IB_MAX && ad[21] <= DOWNLINK_TX_GC_MAX
+         && wheel >= DOWNLINK_WHEEL_MIN_MM && wheel <= DOWNLINK_WHEEL_MAX_MM;
+}
+
+// Tag of the frame under the device key, false without one (auth.h)
+static bool downlinkAuthentic(const uint8_t *ad) {
+  uint8_t mac[DOWNLINK_TAG_LEN];
+  uint8_t diff = 0;
+  uint8_t i;
+
+  if(!authCmac(&ad[DOWNLINK_MAC_START], DOWNLINK_MAC_LEN, mac, DOWNLINK_TAG_LEN)) {
+    return false;
+  }
+  for(i = 0; i < DOWNLINK_TAG_LEN; i++) {
+    diff |= mac[i] ^ ad[DOWNLINK_MAC_START + DOWNLINK_MAC_LEN + i];	// constant time
+  }
+  return diff == 0;
+}
+
+// Check one received element, true if it is a new tuning frame for us
+static bool downlinkParse(const uint8_t *rx, const uint8_t *ownAddress) {
+
+  // element length covers BLE header, AdvA and AdvData
+  if(rx[0] < (RX_HEADER_LEN - 1) + RX_ADVA_LEN + 1 + DOWNLINK_AD_LEN) {
+    return false;
+  }
+  return downlinkApply(&rx[RX_HEADER_LEN + RX_ADVA_LEN], ownAddress);
+}
+
+
+bool downlinkApply(const uint8_t *ad, const uint8_t *ownAddress) {
+  uint32_t seq;
+
+  if(ad[0] != DOWNLINK_AD_LEN || ad[1] != 0xFF || ad[2] != 0xDE || ad[3] != 0xBA
+     || ad[4] != DOWNLINK_CMD_TUNING) {
+    return false;
+  }
+
+  // addressed to this bike?
+  if(memcmp(&ad[5], ownAddress, 6) != 0) {
+    return false;
+  }
+
+  // power-on: RAM content is random, the new epoch rejects every older frame anyway
+  if(downlinkLast.magic != DOWNLINK_MAGIC) {
+    downlinkLast.seq = 0;
+    downlinkLast.magic = DOWNLINK_MAGIC;
+  }
+
+  // gateway repeats the advert, apply only once; recorded frames of this or an older
+  // epoch never again
+  seq = ((uint32_t)ad[11] << 24) | ((uint32_t)ad[12] << 16) | ((uint32_t)ad[13] << 8) | ad[14];
+  if((seq >> 16) != authSealedEpoch() || seq <= downlinkLast.seq) {
+    return false;
+  }
+
+  // all or nothing: a broken frame must not leave half a configuration
+  if(!downlinkValid(ad) || !downlinkAuthentic(ad)) {
+    return false;
+  }
+
+  downlinkLast.seq = seq;
+  memcpy(g_tuning.countMax, &ad[15], DOWNLINK_SPEED_BANDS);
+  g_tuning.txPowerIB = ad[20];
+  g_tuning.txPowerGC = ad[21];
+  g_tuning.wheelCircumference = ((uint16_t)ad[22] << 8) | ad[23];
+
+  return true;
+}
+
+
+void downlinkArm(void) {
+  rfCoreHal_dataEntry_t *entry;
+  uint8_t i;
+
+  for(i = 0; i < RX_ENTRIES; i++) {
+    entry = (rfCoreHal_dataEntry_t*)rxEntries[i];
+    entry->pNextEntry   = (uint8_t*)rxEntries[(i + 1) % RX_ENTRIES];
+    entry->status       = DATA_ENTRY_PENDING;
+    entry->config.type  = DATA_ENTRY_TYPE_GEN;
+    entry->config.lenSz = 1;						// one length byte in front of the element
+    entry->length       = RX_ENTRY_DATA_LEN;
+  }
+
+  downlinkQueue.pCurrEntry = (uint8_t*)rxEntries[0];
+  downlinkQueue.pLastEntry = NULL;
+}
+
+bool downlinkProcess(const uint8_t *ownAddress) {
+  rfCoreHal_dataEntry_t *entry;
+  bool changed = false;
+  uint8_t i;
+
+  for(i = 0; i < RX_ENTRIES; i++) {
+    entry = (rfCoreHal_dataEntry_t*)rxEntries[i];
+    if(entry->status == DATA_ENTRY_FINISHED) {
+      changed |= downlinkParse(&entry->data, ownAddress);
+    }
+  }
+  return changed;
+}
@@ -0,0 +1,70 @@
+/*
+ * downlink.h
+ *
+ * Gateway to bike configuration downlink
+ * --------------------------------------
+ * After the advertising chain a short CMD_BLE_SCANNER window listens on one
+ * channel (high energy only, every DOWNLINK_SCAN_RATIO transmissions).
+ * A gateway advert addressed to our MAC (FCFG1_O_MAC_BLE_0) carries new
+ * tuning parameters, which replace the compiled-in defaults in g_tuning.
+ *
+ * Gateway advert, AdvData (after AdvA):
+ *   [0]      AD length (= DOWNLINK_AD_LEN)
+ *   [1]      0xFF (manufacturer specific)
+ *   [2..3]   0xDE 0xBA
+ *   [4]      DOWNLINK_CMD_TUNING
+ *   [5..10]  target MAC, byte order as sent in AdvA (LSB first)
+ *   [11..14] sequence number (big endian): epoch << 16 | config number
+ *   [15..19] count_max for speed band 0..4 (see getData())
+ *   [20]     tx power IB, [21] tx power GC (CMD_RADIO_SETUP, see pa_table_cc26xx.c)
+ *   [22..23] wheel circumference in mm (big endian)
+ *   [24..27] AES-CMAC (RFC 4493) of [4..23] under the device key (auth.h), first 4 bytes
+ * Accepted only with a valid tag, the epoch of the last sealed uplink frame (gateway:
+ * lastCounter >> 16) and a sequence number above the last accepted one. The number
+ * survives warm resets, a power-on moves to a new epoch: a recorded frame never applies
+ * again. g_tuning is back to the defaults after any reset, the gateway sends the config
+ * again with the next number (diagnostics frame: resets). [4] = 0xC0 keeps the CMAC
+ * input apart from the CCM blocks of the uplink MIC under the same key (B0 flags 0x49).
+ * A frame with a value outside the DOWNLINK_*_MIN/MAX ranges is dropped as a
+ * whole, g_tuning keeps the values it had. Needs AUTH_PAYLOAD; gateway encoder:
+ * gateway/downlink.hpp
+ */
+
+#ifndef DOWNLINK_H_
+#define DOWNLINK_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <radio_files/rfc_api/mailbox.h>
+
+#define DOWNLINK_CMD_TUNING			0xC0
+#define DOWNLINK_AD_LEN				27
+#define DOWNLINK_TAG_LEN			4
+#define DOWNLINK_SPEED_BANDS		5
+
+// accepted ranges
+#define DOWNLINK_COUNT_MAX_MIN		2				// count_max / 2 is the sensor read (see setData())
+#define DOWNLINK_TX_IB_MIN			0x01			// IB 0: PA without bias current
+#define DOWNLINK_TX_IB_MAX			0x31			// +5 dBm at GC 0, top of the CC26xx PA table
+#define DOWNLINK_TX_GC_MAX			0x03
+#define DOWNLINK_WHEEL_MIN_MM		1000
+#define DOWNLINK_WHEEL_MAX_MM		3000
+
+typedef struct {
+  uint8_t countMax[DOWNLINK_SPEED_BANDS];			// count_max per speed band
+  uint8_t txPowerIB;
+  uint8_t txPowerGC;
+  uint16_t wheelCircumference;						// [mm]
+} tuning_t;
+
+extern tuning_t g_tuning;
+extern dataQueue_t downlinkQueue;					// rx queue of the scanner command
+
+
+// * Functions
+// ------------
+void downlinkArm(void);								// reset rx entry before the scan window
+bool downlinkProcess(const uint8_t *ownAddress);	// parse received advert, true if g_tuning changed
+bool downlinkApply(const uint8_t *ad, const uint8_t *ownAddress);	// one AdvData, true if applied
+
+#endif /* DOWNLINK_H_ */
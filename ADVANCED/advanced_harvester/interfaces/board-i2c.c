@@ -47,6 +47,8 @@
 #define BOARD_IOID_SDA_HP         		IOID_8 	/**< Interface 1 SDA: MPU */
 #define BOARD_IOID_SCL_HP         		IOID_9 	/**< Interface 1 SCL: MPU */
 
+#define BOARD_I2C_FAST_MODE             true    /**< 400 kHz, false: 100 kHz */
+
 
 /*---------------------------------------------------------------------------*/
 #define NO_INTERFACE 0xFF
@@ -54,6 +56,29 @@
 static uint8_t slave_addr = 0x00;
 static uint8_t interface = NO_INTERFACE;
 /*---------------------------------------------------------------------------*/
+/*
+ * Transaction list in progress, advanced byte by byte by I2CIntHandler().
+ * Within an op the write phase (if any) ends in a repeated start into the
+ * read phase (if any). The ops follow each other with a repeated start, STOP
+ * comes after the last one only, or after a NACK
+ */
+#define XFER_IDLE  0
+#define XFER_WRITE 1
+#define XFER_READ  2
+
+static struct {
+  const board_i2c_op_t *ops;
+  uint8_t count;
+  uint8_t op;
+  uint8_t pos;
+  volatile uint8_t phase;
+  uint32_t failed;
+  board_i2c_callback_t callback;
+} xfer = { NULL, 0, 0, 0, XFER_IDLE, 0, NULL };
+
+static board_i2c_op_t single;   /* board_i2c_transfer() */
+static volatile bool xfer_done = true;
+/*---------------------------------------------------------------------------*/
 static bool
 accessible(void)
 {
@@ -79,14 +104,20 @@ board_i2c_wakeup()
   while((ti_lib_prcm_power_domain_status(PRCM_DOMAIN_SERIAL)
         != PRCM_DOMAIN_POWER_ON));
 
-  /* Enable the clock to I2C */
+  /* Enable the clock to I2C, also in sleep: the CPU waits for the ISR there */
   ti_lib_prcm_peripheral_run_enable(PRCM_PERIPH_I2C0);
+  ti_lib_prcm_peripheral_sleep_enable(PRCM_PERIPH_I2C0);
   ti_lib_prcm_load_set();
   while(!ti_lib_prcm_load_get());
 
   /* Enable and initialize the I2C master module */
   ti_lib_i2c_master_init_exp_clk(I2C0_BASE, ti_lib_sys_ctrl_clock_get(),
-                                 true);
+                                 BOARD_I2C_FAST_MODE);
+
+  /* One interrupt per byte (or address) on the bus */
+  ti_lib_i2c_master_int_clear(I2C0_BASE);
+  ti_lib_i2c_master_int_enable(I2C0_BASE);
+  ti_lib_int_enable(INT_I2C);
 }
 /*---------------------------------------------------------------------------*/
 static bool
@@ -102,16 +133,181 @@ i2c_status()
   return status == I2C_MASTER_ERR_NONE;
 }
 /*---------------------------------------------------------------------------*/
+static void
+complete(void)
+{
+  board_i2c_callback_t callback = xfer.callback;
+
+  xfer.phase = XFER_IDLE;
+  xfer_done = true;
+  if(callback != NULL) {
+    callback(xfer.failed == 0);
+  }
+}
+/*---------------------------------------------------------------------------*/
+/*
+ * Issue the command for the next byte of the current op: (repeated) START on
+ * the first byte of a phase, ACK on all but the last byte read, STOP after
+ * the last byte of the last op
+ */
+static void
+issue(void)
+{
+  const board_i2c_op_t *op = &xfer.ops[xfer.op];
+  bool last = (xfer.op == xfer.count - 1);
+  uint32_t cmd = I2C_MCTRL_RUN;
+
+  if(xfer.pos == 0) {
+    ti_lib_i2c_master_slave_addr_set(I2C0_BASE, op->addr,
+                                     xfer.phase == XFER_READ);
+    cmd |= I2C_MCTRL_START;
+  }
+
+  if(xfer.phase == XFER_WRITE) {
+    ti_lib_i2c_master_data_put(I2C0_BASE, op->wdata[xfer.pos]);
+    if(last && op->rlen == 0 && xfer.pos == op->wlen - 1) {
+      cmd |= I2C_MCTRL_STOP;
+    }
+  } else if(xfer.pos < op->rlen - 1) {
+    cmd |= I2C_MCTRL_ACK;
+  } else if(last) {
+    cmd |= I2C_MCTRL_STOP;
+  }
+
+  ti_lib_i2c_master_control(I2C0_BASE, cmd);
+}
+/*---------------------------------------------------------------------------*/
+static void
+next_op(void)
+{
+  xfer.op++;
+  if(xfer.op == xfer.count) {
+    complete();
+    return;
+  }
+
+  xfer.pos = 0;
+  xfer.phase = xfer.ops[xfer.op].wlen ? XFER_WRITE : XFER_READ;
+  issue();
+}
+/*---------------------------------------------------------------------------*/
+/**
+ * \brief I2C master interrupt: the last command is done, issue the next one
+ *
+ * Vector in startup_ccs.c
+ */
+void
+I2CIntHandler(void)
+{
+  const board_i2c_op_t *op;
+
+  if(!ti_lib_i2c_master_int_status(I2C0_BASE, true)) {
+    return;
+  }
+  ti_lib_i2c_master_int_clear(I2C0_BASE);
+
+  if(xfer.phase == XFER_IDLE) {
+    return;
+  }
+  op = &xfer.ops[xfer.op];
+
+  /*
+   * NACK or lost arbitration: STOP is sent by i2c_status(), the next op
+   * starts with a new START once the STOP is out
+   */
+  if(!i2c_status()) {
+    xfer.failed |= 1UL << xfer.op;
+    while(ti_lib_i2c_master_busy(I2C0_BASE));
+    ti_lib_i2c_master_int_clear(I2C0_BASE);
+    next_op();
+    return;
+  }
+
+  if(xfer.phase == XFER_WRITE) {
+    xfer.pos++;
+    if(xfer.pos < op->wlen) {
+      issue();
+    } else if(op->rlen > 0) {
+      xfer.phase = XFER_READ;
+      xfer.pos = 0;
+      issue();
+    } else {
+      next_op();
+    }
+    return;
+  }
+
+  op->rdata[xfer.pos++] = ti_lib_i2c_master_data_get(I2C0_BASE);
+  if(xfer.pos < op->rlen) {
+    issue();
+  } else {
+    next_op();
+  }
+}
+/*---------------------------------------------------------------------------*/
+static bool
+submit(const board_i2c_op_t *ops, uint8_t count,
+       board_i2c_callback_t callback)
+{
+  if(xfer.phase != XFER_IDLE || count == 0 || count > BOARD_I2C_BATCH_MAX) {
+    return false;
+  }
+
+  xfer.ops = ops;
+  xfer.count = count;
+  xfer.op = 0;
+  xfer.pos = 0;
+  xfer.failed = 0;
+  xfer.callback = callback;
+  xfer_done = false;
+
+  /* Check if another master has access */
+  while(ti_lib_i2c_master_bus_busy(I2C0_BASE));
+  ti_lib_i2c_master_int_clear(I2C0_BASE);
+
+  xfer.phase = ops[0].wlen ? XFER_WRITE : XFER_READ;
+  issue();
+
+  return true;
+}
+/*---------------------------------------------------------------------------*/
+/*
+ * CPU sleep until the transaction is done. Interrupts are masked around the
+ * check, a pending I2C interrupt still ends the WFI, so none is missed. Also
+ * works from code that runs with interrupts masked, the state is restored
+ */
+static bool
+wait_done(void)
+{
+  bool masked = ti_lib_int_master_disable();
+
+  while(!xfer_done) {
+    ti_lib_prcm_sleep();
+    ti_lib_int_master_enable();
+    ti_lib_int_master_disable();
+  }
+  if(!masked) {
+    ti_lib_int_master_enable();
+  }
+
+  return xfer.failed == 0;
+}
+/*---------------------------------------------------------------------------*/
 void
 board_i2c_shutdown()
 {
   interface = NO_INTERFACE;
 
+  ti_lib_int_disable(INT_I2C);
   if(accessible()) {
+    ti_lib_i2c_master_int_disable(I2C0_BASE);
     ti_lib_i2c_master_disable(I2C0_BASE);
   }
+  xfer.phase = XFER_IDLE;
+  xfer_done = true;
 
   ti_lib_prcm_peripheral_run_disable(PRCM_PERIPH_I2C0);
+  ti_lib_prcm_peripheral_sleep_disable(PRCM_PERIPH_I2C0);
   ti_lib_prcm_load_set();
   while(!ti_lib_prcm_load_get());
 
@@ -134,172 +330,70 @@ board_i2c_shutdown()
 }
 /*---------------------------------------------------------------------------*/
 bool
-board_i2c_write(uint8_t *data, uint8_t len)
+board_i2c_transfer(const uint8_t *wdata, uint8_t wlen, uint8_t *rdata,
+                   uint8_t rlen, board_i2c_callback_t callback)
 {
-  uint32_t i;
-  bool success;
-
-  /* Write slave address */
-  ti_lib_i2c_master_slave_addr_set(I2C0_BASE, slave_addr, false);
-
-  /* Write first byte */
-  ti_lib_i2c_master_data_put(I2C0_BASE, data[0]);
+  if(xfer.phase != XFER_IDLE || (wlen == 0 && rlen == 0)) {
+    return false;
+  }
 
-  /* Check if another master has access */
-  while(ti_lib_i2c_master_bus_busy(I2C0_BASE));
+  single.addr = slave_addr;
+  single.wdata = wdata;
+  single.wlen = wlen;
+  single.rdata = rdata;
+  single.rlen = rlen;
 
-  /* Assert RUN + START */
-  ti_lib_i2c_master_control(I2C0_BASE, I2C_MASTER_CMD_BURST_SEND_START);
-  while(ti_lib_i2c_master_busy(I2C0_BASE));
-  success = i2c_status();
-
-  for(i = 1; i < len && success; i++) {
-    /* Write next byte */
-    ti_lib_i2c_master_data_put(I2C0_BASE, data[i]);
-    if(i < len - 1) {
-      /* Clear START */
-      ti_lib_i2c_master_control(I2C0_BASE, I2C_MASTER_CMD_BURST_SEND_CONT);
-      while(ti_lib_i2c_master_busy(I2C0_BASE));
-      success = i2c_status();
-    }
-  }
+  return submit(&single, 1, callback);
+}
+/*---------------------------------------------------------------------------*/
+uint32_t
+board_i2c_batch(const board_i2c_op_t *ops, uint8_t count)
+{
+  /* Interface and wakeup once for the list, the ops carry the addresses */
+  board_i2c_select(BOARD_I2C_INTERFACE_0, ops[0].addr);
 
-  /* Assert stop */
-  if(success) {
-    /* Assert STOP */
-    ti_lib_i2c_master_control(I2C0_BASE, I2C_MASTER_CMD_BURST_SEND_FINISH);
-    while(ti_lib_i2c_master_busy(I2C0_BASE));
-    success = i2c_status();
-    while(ti_lib_i2c_master_bus_busy(I2C0_BASE));
+  if(!submit(ops, count, NULL)) {
+    return 0xFFFFFFFF;
   }
+  wait_done();
 
-  return success;
+  return xfer.failed;
+}
+/*---------------------------------------------------------------------------*/
+uint8_t
+board_i2c_slave(void)
+{
+  return slave_addr;
+}
+/*---------------------------------------------------------------------------*/
+bool
+board_i2c_idle(void)
+{
+  return xfer.phase == XFER_IDLE;
+}
+/*---------------------------------------------------------------------------*/
+bool
+board_i2c_write(uint8_t *data, uint8_t len)
+{
+  return board_i2c_transfer(data, len, NULL, 0, NULL) && wait_done();
 }
 /*---------------------------------------------------------------------------*/
 bool
 board_i2c_write_single(uint8_t data)
 {
-  bool success;
-
-  /* Write slave address */
-  ti_lib_i2c_master_slave_addr_set(I2C0_BASE, slave_addr, false);
-
-  /* Write first byte */
-  ti_lib_i2c_master_data_put(I2C0_BASE, data);
-
-  /* Check if another master has access */
-  while(ti_lib_i2c_master_bus_busy(I2C0_BASE));
-
-  /* Assert RUN + START + STOP */
-  ti_lib_i2c_master_control(I2C0_BASE, I2C_MASTER_CMD_SINGLE_SEND);
-  while(ti_lib_i2c_master_busy(I2C0_BASE));
-  success = i2c_status();
-
-  return success;
+  return board_i2c_transfer(&data, 1, NULL, 0, NULL) && wait_done();
 }
 /*---------------------------------------------------------------------------*/
 bool
 board_i2c_read(uint8_t *data, uint8_t len)
 {
-  uint8_t i;
-  bool success;
-
-  /* Set slave address */
-  ti_lib_i2c_master_slave_addr_set(I2C0_BASE, slave_addr, true);
-
-  /* Check if another master has access */
-  while(ti_lib_i2c_master_bus_busy(I2C0_BASE));
-
-  /* Assert RUN + START + ACK */
-  ti_lib_i2c_master_control(I2C0_BASE, I2C_MASTER_CMD_BURST_RECEIVE_START);
-
-  i = 0;
-  success = true;
-  while(i < (len - 1) && success) {
-    while(ti_lib_i2c_master_busy(I2C0_BASE));
-    success = i2c_status();
-    if(success) {
-      data[i] = ti_lib_i2c_master_data_get(I2C0_BASE);
-      ti_lib_i2c_master_control(I2C0_BASE, I2C_MASTER_CMD_BURST_RECEIVE_CONT);
-      i++;
-    }
-  }
-
-  if(success) {
-    while(ti_lib_i2c_master_busy(I2C0_BASE));
-    success = i2c_status();
-    if(success) {
-      data[len - 1] = ti_lib_i2c_master_data_get(I2C0_BASE);
-      ti_lib_i2c_master_control(I2C0_BASE, I2C_MASTER_CMD_BURST_RECEIVE_FINISH);
-      while(ti_lib_i2c_master_bus_busy(I2C0_BASE));
-    }
-  }
-
-  return success;
+  return board_i2c_transfer(NULL, 0, data, len, NULL) && wait_done();
 }
 /*---------------------------------------------------------------------------*/
 bool
 board_i2c_write_read(uint8_t *wdata, uint8_t wlen, uint8_t *rdata, uint8_t rlen)
 {
-  uint32_t i;
-  bool success;
-
-  /* Set slave address for write */
-  ti_lib_i2c_master_slave_addr_set(I2C0_BASE, slave_addr, false);
-
-  /* Write first byte */
-  ti_lib_i2c_master_data_put(I2C0_BASE, wdata[0]);
-
-  /* Check if another master has access */
-  while(ti_lib_i2c_master_bus_busy(I2C0_BASE));
-
-  /* Assert RUN + START */
-  ti_lib_i2c_master_control(I2C0_BASE, I2C_MASTER_CMD_BURST_SEND_START);
-  while(ti_lib_i2c_master_busy(I2C0_BASE));
-  success = i2c_status();
-
-  for(i = 1; i < wlen && success; i++) {
-    /* Write next byte */
-    ti_lib_i2c_master_data_put(I2C0_BASE, wdata[i]);
-    if(i < wlen - 1) {
-      /* Clear START */
-      ti_lib_i2c_master_control(I2C0_BASE, I2C_MASTER_CMD_BURST_SEND_CONT);
-      while(ti_lib_i2c_master_busy(I2C0_BASE));
-      success = i2c_status();
-    }
-  }
-  if(!success) {
-    return false;
-  }
-
-  /* Set slave address for read */
-  ti_lib_i2c_master_slave_addr_set(I2C0_BASE, slave_addr, true);
-
-  /* Assert ACK */
-  ti_lib_i2c_master_control(I2C0_BASE, I2C_MASTER_CMD_BURST_RECEIVE_START);
-
-  i = 0;
-  while(i < (rlen - 1) && success) {
-    while(ti_lib_i2c_master_busy(I2C0_BASE));
-    success = i2c_status();
-    if(success) {
-      rdata[i] = ti_lib_i2c_master_data_get(I2C0_BASE);
-      ti_lib_i2c_master_control(I2C0_BASE, I2C_MASTER_CMD_BURST_RECEIVE_CONT);
-      i++;
-    }
-  }
-
-  if(success) {
-    while(ti_lib_i2c_master_busy(I2C0_BASE));
-    success = i2c_status();
-    if(success) {
-      rdata[rlen - 1] = ti_lib_i2c_master_data_get(I2C0_BASE);
-      ti_lib_i2c_master_control(I2C0_BASE, I2C_MASTER_CMD_BURST_RECEIVE_FINISH);
-      while(ti_lib_i2c_master_bus_busy(I2C0_BASE));
-    }
-  }
-
-  return success;
+  return board_i2c_transfer(wdata, wlen, rdata, rlen, NULL) && wait_done();
 }
 /*---------------------------------------------------------------------------*/
 void
@@ -332,7 +426,7 @@ board_i2c_select(uint8_t new_interface, uint8_t address)
 
     /* Enable and initialize the I2C master module */
     ti_lib_i2c_master_init_exp_clk(I2C0_BASE, ti_lib_sys_ctrl_clock_get(),
-                                   true);
+                                   BOARD_I2C_FAST_MODE);
   }
 }
 /*---------------------------------------------------------------------------*/
@@ -48,6 +48,29 @@
 #define BOARD_I2C_INTERFACE_0     0
 #define BOARD_I2C_INTERFACE_1     1
 /*---------------------------------------------------------------------------*/
+/**
+ * \brief Completion of a board_i2c_transfer(), called from the I2C ISR
+ * \param success False on NACK or lost arbitration
+ */
+typedef void (*board_i2c_callback_t)(bool success);
+/*---------------------------------------------------------------------------*/
+/**
+ * \brief One entry of a board_i2c_batch() list: a write, a read or a write +
+ *        repeated start + read on one slave
+ *
+ * At least one of wlen and rlen is not 0. Typically a register access: the
+ * register address (and the value) as wdata, the contents read into rdata.
+ */
+typedef struct board_i2c_op {
+  uint8_t addr;               /**< 7 bit slave address */
+  const uint8_t *wdata;
+  uint8_t wlen;
+  uint8_t *rdata;
+  uint8_t rlen;
+} board_i2c_op_t;
+
+#define BOARD_I2C_BATCH_MAX       32 /**< Ops per list, bits of the result */
+/*---------------------------------------------------------------------------*/
 /**
  * \brief Put the I2C controller in a known state
  *
@@ -68,6 +91,11 @@
  */
 void board_i2c_select(uint8_t interface, uint8_t slave_addr);
 
+/**
+ * \brief The slave selected by the last board_i2c_select()
+ */
+uint8_t board_i2c_slave(void);
+
 /**
  * \brief Burst read from an I2C device
  * \param buf Pointer to a buffer where the read data will be stored
@@ -102,6 +130,42 @@ bool board_i2c_write_single(uint8_t data);
 bool board_i2c_write_read(uint8_t *wdata, uint8_t wlen, uint8_t *rdata,
                           uint8_t rlen);
 
+/**
+ * \brief Start a write, a read or a write + repeated start + read
+ * \param wdata Pointer to the buffer to be written
+ * \param wlen Number of bytes to write, 0 for a read only
+ * \param rdata Pointer to a buffer where the read data will be stored
+ * \param rlen Number of bytes to read, 0 for a write only
+ * \param callback Called from the I2C ISR when done, NULL for none
+ * \return False if a transfer or batch is still running
+ *
+ * Returns once the first command is issued, the I2C ISR sends and receives
+ * the rest byte by byte. The buffers must stay valid until the transfer is
+ * done, board_i2c_idle() or the callback tells. The read and write functions
+ * above are built on this one and sleep the CPU until it is done.
+ */
+bool board_i2c_transfer(const uint8_t *wdata, uint8_t wlen, uint8_t *rdata,
+                        uint8_t rlen, board_i2c_callback_t callback);
+
+/**
+ * \brief True when no board_i2c_transfer() is running
+ */
+bool board_i2c_idle(void);
+
+/**
+ * \brief Run a list of accesses to the sensors on interface 0
+ * \param ops The list, see board_i2c_op_t
+ * \param count Number of ops, up to BOARD_I2C_BATCH_MAX
+ * \return Bit i set if op i failed (NACK), 0 if all succeeded
+ *
+ * The ops follow each other with repeated starts, across slave addresses,
+ * with a single STOP at the end: no board_i2c_select() and no bus release
+ * per access. A NACKed op ends with a STOP, the next one starts anew. The
+ * peripheral is woken up if needed and left on, board_i2c_shutdown() when
+ * the session is over. Sleeps the CPU until the list is done.
+ */
+uint32_t board_i2c_batch(const board_i2c_op_t *ops, uint8_t count);
+
 /**
  * \brief Enables the I2C peripheral with defaults
  *
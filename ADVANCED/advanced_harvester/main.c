@@ -67,7 +67,9 @@
 #include "hdc-1000-sensor.h"							// humitiy
 #include "opt-3001-sensor.h"
 #include "interfaces/board-i2c.h"
-#include "mbedtls/aes.h"
+#include "acquire.h"
+#include "aes_bench.h"
+#include "convert_bench.h"
 
 #define SENSOR_HUMIDITY_I2C_ADDRESS     0x43			// -> hdc-1000-sensor.c
 #define SENSOR_TEMPERATURE_I2C_ADDRESS  0x44			// temp-007-sensor.c
@@ -80,6 +82,7 @@
 #define LO_UINT16(a) ((a) & 0xFF)
 #define SWAP(v) ((LO_UINT16(v) << 8) | HI_UINT16(v))
 #define CONV_RDY_BIT                    0x4000
+#define ABS_DIFF(a, b) (((a) > (b)) ? ((a) - (b)) : ((b) - (a)))
 
 
 // GPIO
@@ -88,6 +91,48 @@
 
 // RF-Chip (M0)
 #include "radio.h"
+#include "downlink.h"
+#include "payload_advanced_uplink.h"
+#include "payload_compact.h"
+#include "payload_advanced_speed.h"
+#include "ride.h"
+#include "payload_advanced_calib.h"
+#include "payload_advanced_calib_2.h"
+#include "diag.h"
+#include "payload_advanced_diag.h"
+#include "payload_advanced_diag_2.h"
+#include "payload_advanced_energy.h"
+#include "payload_advanced_energy_2.h"
+#include "auth.h"
+#if PAYLOAD_ADVANCED_UPLINK_LEN > ADVLEN
+#error "ADVLEN too short for gateway/schema/advanced_uplink.schema"
+#endif
+#if AUTH_PAYLOAD && PAYLOAD_ADVANCED_UPLINK_LEN + AUTH_TRAILER_LEN > ADVLEN
+#error "ADVLEN too short for the authenticated uplink frame"
+#endif
+#if AUTH_PAYLOAD && (PAYLOAD_ADVANCED_CALIB_LEN + AUTH_TRAILER_LEN > ADVLEN || \
+                     PAYLOAD_ADVANCED_CALIB_2_LEN + AUTH_TRAILER_LEN > ADVLEN || \
+                     PAYLOAD_ADVANCED_DIAG_LEN + AUTH_TRAILER_LEN > ADVLEN || \
+                     PAYLOAD_ADVANCED_DIAG_2_LEN + AUTH_TRAILER_LEN > ADVLEN || \
+                     PAYLOAD_ADVANCED_ENERGY_LEN + AUTH_TRAILER_LEN > ADVLEN || \
+                     PAYLOAD_ADVANCED_ENERGY_2_LEN + AUTH_TRAILER_LEN > ADVLEN)
+#error "ADVLEN too short for the authenticated calibration, diagnostics or energy frame parts"
+#endif
+#if AUTH_PAYLOAD && !DIAG_FRAME
+#error "AUTH_PAYLOAD needs DIAG_FRAME: the gateway resyncs the nonce epoch from the diagnostics frame"
+#endif
+#if DOWNLINK_SCAN && !AUTH_PAYLOAD
+#error "DOWNLINK_SCAN needs AUTH_PAYLOAD: tuning frames are checked with the device key"
+#endif
+#if AUTH_PAYLOAD && LINK_MODE != LINK_MODE_BLE
+#error "AUTH_PAYLOAD needs LINK_MODE_BLE (prop packets drop the last two bytes)"
+#endif
+#if RIDE_AGGREGATES && !PAYLOAD_COMPACT
+#error "RIDE_AGGREGATES needs the compact format"
+#endif
+#if SENSOR_RAW && !PAYLOAD_COMPACT
+#error "SENSOR_RAW needs the compact format"
+#endif
 #include <driverLib/rfc.h>								// Set up RFC interrupts
 
 // radio transmittion
@@ -97,6 +142,13 @@ extern volatile bool rfAdvertisingDone;
 
 // get and store data
 char payload[ADVLEN];					// shared data buffer
+uint8_t payload_len = ADVLEN;			// bytes used in payload (compact format varies)
+
+#if PAYLOAD_COMPACT
+compactReading_t tx_reading;			// reading encoded in payload
+compactReading_t tx_history[COMPACT_MAX_HISTORY];	// last sent readings, most recent first
+uint8_t tx_history_len = 0;
+#endif
 static uint16_t sequenceNumber = 0x0;
 uint32_t g_timestamp1, g_timestamp2;
 uint32_t g_timediff = 0;
@@ -114,8 +166,48 @@ bool g_humidity_active;
 bool g_sensor_set;
 static uint32_t pressure = 0;
 static uint16_t temperature = 0;
+static uint32_t raw_temperature = 0;	// BMP280 ADC word (SENSOR_RAW), pressure holds the raw word then
+static uint16_t humidity = 0;			// HDC1000 [0.01 %RH] (SENSOR_ACQUIRE)
+static bool humidity_read = false;
 
 long g_current_energy_state;
+uint8_t energy_band = 0;				// speed band 0..4 from getData()
+
+// deadband: last sent values
+bool tx_sent_once = false;
+uint32_t last_tx_time;					// RTC of last transmission
+uint32_t last_tx_timediff;
+uint32_t last_tx_pressure = 0;			// last sent sensor values (0 = none yet)
+uint16_t last_tx_temperature;
+uint32_t last_tx_raw_temperature;
+uint32_t g_tx_suppressed = 0;			// transmissions skipped by the deadband
+
+// frame scheduler: speed frames, every env_frame_ratio[band]-th an environment frame
+static const uint8_t env_frame_ratio[DOWNLINK_SPEED_BANDS] = ENV_FRAME_RATIO;
+bool env_frame = false;					// next transmission is an environment frame
+uint8_t frames_since_env = 0;
+bool calib_frame = false;				// next transmission is the calibration frame (SENSOR_RAW)
+uint8_t frames_since_calib = SENSOR_RAW_CALIB_RATIO;	// first transmission after reset
+bool diag_frame = false;				// next transmission is the diagnostics frame (DIAG_FRAME)
+uint8_t frames_since_diag = DIAG_FRAME_RATIO;	// first transmission after reset
+bool energy_frame = false;				// next transmission is the energy frame (ENERGY_ACCOUNTING)
+bool aux_frame = false;					// calibration, diagnostics or energy frame instead of data
+uint8_t aux_part = 0;					// part of it in the next transmission: 0, 1 (two parts, see schemas)
+static const uint16_t energy_budget[DOWNLINK_SPEED_BANDS] = ENERGY_BUDGET_UA;
+uint8_t radio_profile = RADIO_PROFILE_FULL_3CH;
+
+// RF keep-alive session
+bool rf_keep_alive = false;				// requested for this wake (getData)
+bool rf_session_booted = false;			// RF core booted, RAT running, XOSC on
+bool rf_session_setup = false;			// CMD_RADIO_SETUP done, synth still on
+bool wake_cold;							// RF core booted in this wake
+uint32_t wake_start;					// RTC at start of setData
+uint32_t g_tx_ticks_cold = 0;			// last wake-to-TX-done time [RTC ticks, 1/65536 s]
+uint32_t g_tx_ticks_warm = 0;
+
+// gateway downlink
+bool downlink_scan = false;				// scan window appended to this transmission
+uint8_t downlink_tx_count = 0;			// transmissions since last scan window
 
 // RTC
 #include <rtc.h>
@@ -155,6 +247,11 @@ void GPIOIntHandler(void){
   if(g_timediff < 0x0000000400){
 	  g_timediff = 0;
   }
+#if RIDE_AGGREGATES
+  if(g_timediff != 0){
+	  rideAddRevolution(g_timediff);
+  }
+#endif
   count++;												// count interrupts (= reed switch)
 
   /* Read interrupt flags */
@@ -186,6 +283,8 @@ void GPIOIntHandler(void){
 
 void sensorsInit(void){
 
+	sensor_shadow_init();							// empty after reset: the writes below all go out
+
 	//Turn off TMP007
     configure_tmp_007(0);
 
@@ -205,6 +304,8 @@ void sensorsInit(void){
 
 	configure_bmp_280(0);
 
+	acquireInit();
+
 	//Power off Serial domain (Powered on in sensor configurations!)
 	PRCMPowerDomainOff(PRCM_DOMAIN_SERIAL);
 	while((PRCMPowerDomainStatus(PRCM_DOMAIN_SERIAL) != PRCM_DOMAIN_POWER_OFF));
@@ -220,6 +321,8 @@ void initSensortag(void){
 
 	uint8_t payload[ADVLEN];
 
+	  diagInit();										// before anything can fail
+
 	  //Disable JTAG to allow for Standby
 	  AONWUCJtagPowerOff();
 
@@ -232,6 +335,7 @@ void initSensortag(void){
 	  powerDivideInfClkDS(PRCM_INFRCLKDIVDS_RATIO_DIV32);
 
 	  initRTC();										// for speed measurement
+	  energyMcuState(ENERGY_CPU);						// coulomb counter runs on the RTC
 
 	  powerEnablePeriph();
 	  powerEnableGPIOClockRunMode();
@@ -248,6 +352,9 @@ void initSensortag(void){
 	  IOCPortConfigureSet(BOARD_IOID_DP0 , IOC_PORT_GPIO, IOC_IOMODE_NORMAL | IOC_RISING_EDGE | IOC_INT_ENABLE | IOC_IOPULL_DOWN | IOC_INPUT_ENABLE | IOC_WAKE_ON_HIGH);
 
 	  HWREG(AON_EVENT_BASE + AON_EVENT_O_MCUWUSEL) = AON_EVENT_MCUWUSEL_WU0_EV_PAD;  //Does not work with AON_EVENT_MCUWUSEL_WU0_EV_PAD4 --> WHY??
+	  // WU1: RTC channel 0, end of the sensor conversions (rtcWakeAt)
+	  HWREG(AON_EVENT_BASE + AON_EVENT_O_MCUWUSEL) = (HWREG(AON_EVENT_BASE + AON_EVENT_O_MCUWUSEL) & ~AON_EVENT_MCUWUSEL_WU1_EV_M)
+	                                                 | AON_EVENT_MCUWUSEL_WU1_EV_RTC_CH0;
 
 	  IntEnable(INT_EDGE_DETECT);
 
@@ -259,6 +366,13 @@ void initSensortag(void){
 
 	  initInterrupts();
 	  initRadio();
+	  authInit();										// after a power-on: next epoch from flash
+#if AES_BENCH
+	  aesBench();
+#endif
+#if CONVERT_BENCH
+	  convertBench();
+#endif
 
 	  // Turn off FLASH in idle mode
 	  powerDisableFlashInIdle();
@@ -282,42 +396,85 @@ void getData(void){
 	// ---------------------------------------------
 
 
+	DIAG_COUNT(wakes);
+
 	// set energy state from velocity
 	// ----------------------------------
-	count_max = 2;									// default (wenig Energie => bis 15 km/h)
+	count_max = g_tuning.countMax[0];				// default (wenig Energie => bis 15 km/h)
+	radio_profile = RADIO_PROFILE_COMPACT_1CH;		// only one channel at low energy
+	rf_keep_alive = false;
 	g_sensor_set = false;
-	pressure = 0;
-	temperature = 0;
+	energy_band = 0;
 
 	// Middle energy
 	if(g_timediff < 0x00003E00 ){					// from 15 km/h - 25 km/h
 		g_sensor_set = true;
+		energy_band = 1;
+		count_max = g_tuning.countMax[1];
+		radio_profile = REDUNDANCY_2CH ? RADIO_PROFILE_DUAL_2CH : RADIO_PROFILE_FULL_3CH;
 	}
 	// High energy
 	if(g_timediff < 0x00002400 ){					// higher 25 km/h
 		g_sensor_set = true;
-		count_max = 10;								// LTS ldt sich, VSUP bricht nicht mehr ab
+		energy_band = 2;
+		count_max = g_tuning.countMax[2];								// LTS ldt sich, VSUP bricht nicht mehr ab
 	}												// Sensoren werden nicht mehr ausgelesen
 													// sowohl bei count = 50 wie bei count = 10
 	if(g_timediff < 0x00002080 ){
 
 		g_sensor_set = true;
-		count_max = 100;
+		energy_band = 3;
+		count_max = g_tuning.countMax[3];
 	}
 
 	if(g_timediff < 0x00001E80 ){
 			//g_current_energy_state = HIGH_ENERGY;		// higher 40 km/h
 			g_sensor_set = true;
-			count_max = 250;
+			energy_band = 4;
+			count_max = g_tuning.countMax[4];
+			radio_profile = RADIO_PROFILE_BURST_DRAIN;	// surplus energy: repeat adverts
 	}
 
-}
+	// Estimated consumption above what the harvester delivers in this band: half the
+	// transmission rate, no repeated adverts (software coulomb counter, system.c)
+	if(ENERGY_ACCOUNTING && energyAverageCurrent() > energy_budget[energy_band]){
+		count_max = (count_max < 128) ? count_max * 2 : 255;
+		if(radio_profile == RADIO_PROFILE_BURST_DRAIN){
+			radio_profile = RADIO_PROFILE_FULL_3CH;
+		}
+	}
 
-void setData(void){
+	// Frame type of the next transmission. Sensors are only read for environment frames
+	env_frame = g_sensor_set && env_frame_ratio[energy_band] != 0
+				&& frames_since_env + 1 >= env_frame_ratio[energy_band];
+
+	// Auxiliary frames go out in two parts (each fits with the auth trailer), the flags stay
+	// for the second
+	if(aux_part == 0){
+		// raw sensor mode: the gateway needs the calibration block to compensate
+		calib_frame = SENSOR_RAW && frames_since_calib >= SENSOR_RAW_CALIB_RATIO;
+		// health counters, after the calibration frame if both are due
+		diag_frame = DIAG_FRAME && !calib_frame && frames_since_diag >= DIAG_FRAME_RATIO;
+		// charge per activity, right after the diagnostics frame
+		energy_frame = ENERGY_ACCOUNTING && DIAG_FRAME && !calib_frame && !diag_frame && frames_since_diag == 0;
+	}
+	aux_frame = calib_frame || diag_frame || energy_frame;
+	if(aux_frame){
+		env_frame = false;							// moves to the next transmission
+	}
+	g_sensor_set = env_frame;
 
-		rfBootDone  = 0;
-	    rfSetupDone = 0;
-	    rfAdvertisingDone = 0;
+	// Short wheel period: keep RF core and synth on until energy drops again
+	if(RF_KEEP_ALIVE && g_timediff != 0 && g_timediff < RF_KEEP_ALIVE_TIMEDIFF){
+		rf_keep_alive = true;
+	}
+
+	radioSelectProfile(radio_profile);
+
+}
+
+// Boot RF core (patch, RAT) and switch to XOSC. Skipped while an RF keep-alive session runs
+void bootRadio(void){
 
 	    //Wait until RF Core PD is ready before accessing radio
 	    waitUntilRFCReady();
@@ -328,12 +485,11 @@ void setData(void){
 	    waitUntilAUXReady();
 
 	    //Enable 24MHz XTAL
-	    OSCHF_TurnOnXosc();
+	    powerTurnOnXosc();
 
 	    //IDLE until BOOT_DONE interrupt from RFCore is triggered
 	    while( ! rfBootDone) {
-	      powerDisableCPU();
-	      PRCMDeepSleep();
+	      powerIdle();
 	    }
 
 	    //This code runs after BOOT_DONE interrupt has woken up the CPU again
@@ -353,107 +509,115 @@ void setData(void){
 	    while( !OSCHF_AttemptToSwitchToXosc())
 	    {}
 
-	    powerEnablePeriph();
-	    powerEnableGPIOClockRunMode();
+	    rf_session_booted = true;
+}
 
-	     /* Wait for domains to power on */
-	     while((PRCMPowerDomainStatus(PRCM_DOMAIN_PERIPH) != PRCM_DOMAIN_POWER_ON));
+// RAT time of the next transmit slot. The slot grid is kept on the RTC because the RAT
+// restarts with every cold boot. Per-device phase from the MAC
+uint32_t nextSlotRat(void){
 
+	const uint8_t *mac = radioDeviceAddress();
+	uint32_t phase = ((mac[0] | (mac[1] << 8)) % RAT_SLOT_COUNT) * (RAT_SLOT_PERIOD / RAT_SLOT_COUNT);
+	uint32_t rtcNow, ratNow, slot;
 
-	     // for energy sparing: read sensors out only all count/2-times
-	     if( count >= (count_max/2) && !readed_sensors && g_sensor_set){
-	    	 readed_sensors=true;
-			 enable_bmp_280(1);
+	rtcNow = AONRTCCurrentCompareValueGet();
+	ratNow = radioRatNow();
 
-			 do{
-				pressure = value_bmp_280(BMP_280_SENSOR_TYPE_PRESS);  //  read and converts in pascal (96'000 Pa)
-				temperature = value_bmp_280(BMP_280_SENSOR_TYPE_TEMP);
-			 }while((pressure == 0x80000000) );
+	// next grid point (+ phase) after now + guard
+	slot = ((rtcNow + RAT_SLOT_GUARD - phase) / RAT_SLOT_PERIOD + 1) * RAT_SLOT_PERIOD + phase;
 
-	     }
+	// RTC 1/65536 s -> RAT 1/4 us: x * 4'000'000 / 65536 = x * 15625 / 256
+	return ratNow + (slot - rtcNow) * 15625 / 256;
+}
 
-	    powerDisablePeriph();
-		// Disable clock for GPIO in CPU run mode
-		HWREGBITW(PRCM_BASE + PRCM_O_GPIOCLKGR, PRCM_GPIOCLKGR_CLK_EN_BITN) = 0;
-		// Load clock settings
-		HWREGBITW(PRCM_BASE + PRCM_O_CLKLOADCTL, PRCM_CLKLOADCTL_LOAD_BITN) = 1;
+// Calibration frame: BMP280 register block 0x88..0x9F (little endian) as read at init,
+// part aux_part
+void encodeCalibFrame(void){
 
+	const uint8_t *c = calibration_bmp_280();
 
-		uint8_t p;
-	    p = 0;
-
-	    // header
-	    payload[p++] = ADVLEN-1;
-	    payload[p++] = 0x03;
-	    payload[p++] = 0xDE;
-	    payload[p++] = 0xBA;
-	    payload[p++] = (char) (sequenceNumber >> 8);
-	    payload[p++] = (char) sequenceNumber;
-
-	    // speed
-	    payload[p++] = (char) (g_timediff >> 24) & 0x000000FF;
-	    payload[p++] = (char) (g_timediff >> 16) & 0x000000FF;
-	    payload[p++] = (char) (g_timediff >> 8) & 0x000000FF;
-	    payload[p++] = (char) g_timediff  & 0x000000FF;
-
-	    // pressure
-	    payload[p++] = 0;
-	    payload[p++] = (char) ((pressure >> 16) & 0x000000FF);
-	    payload[p++] = (char) ((pressure >> 8) & 0x000000FF);
-	    payload[p++] = (char) (pressure  & 0x000000FF);
-
-	    // temperature
-	    payload[p++] = 0;
-	    payload[p++] = 0;
-	    payload[p++] = (char) (temperature >> 8);
-	 	payload[p++] = (char) temperature & 0x00FF;
-
-	 	// humidity
-	   	payload[p++] = 0;
-	   	payload[p++] = 0;
-	   	payload[p++] = 0; //(char) (humidity >> 8);
-	   	payload[p++] = 0; //(char) humidity;
-
-	   	// checksum
-	   	payload[p++] = 0;  // checksum
-	   	payload[p++] = 0;
+	if(aux_part == 0){
+		payloadAdvancedCalib_t calib;
 
-	   	sequenceNumber++;
+		calib.dig_t1 = c[0]  | (c[1] << 8);
+		calib.dig_t2 = c[2]  | (c[3] << 8);
+		calib.dig_t3 = c[4]  | (c[5] << 8);
+		calib.dig_p1 = c[6]  | (c[7] << 8);
+		calib.dig_p2 = c[8]  | (c[9] << 8);
+		calib.dig_p3 = c[10] | (c[11] << 8);
+		payloadAdvancedCalibEncode((uint8_t*)payload, &calib);
+		payload_len = PAYLOAD_ADVANCED_CALIB_LEN;
+	}
+	else{
+		payloadAdvancedCalib2_t calib;
+
+		calib.dig_p4 = c[12] | (c[13] << 8);
+		calib.dig_p5 = c[14] | (c[15] << 8);
+		calib.dig_p6 = c[16] | (c[17] << 8);
+		calib.dig_p7 = c[18] | (c[19] << 8);
+		calib.dig_p8 = c[20] | (c[21] << 8);
+		calib.dig_p9 = c[22] | (c[23] << 8);
+		payloadAdvancedCalib2Encode((uint8_t*)payload, &calib);
+		payload_len = PAYLOAD_ADVANCED_CALIB_2_LEN;
+	}
 }
 
+// Diagnostics frame: health counters (diag.h), part aux_part
+void encodeDiagFrame(void){
 
-void sendData(void){
+	if(aux_part == 0){
+		payloadAdvancedDiag_t diag;
 
-    //Start radio setup and linked advertisment
-   	// for energy sparing: only each 100 time send data
-    if(count >= count_max){
-    	count = 0;
-    	readed_sensors=false;
-    	radioUpdateAdvData(ADVLEN, payload);
-    	radioSetupAndTransmit();
-
-		//Wait in IDLE for CMD_DONE interrupt after radio setup. ISR will disable radio interrupts
-		while( ! rfSetupDone) {
-		  powerDisableCPU();
-		  PRCMDeepSleep();
-		}
-		//Disable flash in IDLE after CMD_RADIO_SETUP is done (radio setup reads FCFG trim values)
-		powerDisableFlashInIdle();
+		diag.epoch        = AUTH_PAYLOAD ? authEpoch() : 0;
+		diag.wakes        = g_diag.wakes;
+		diag.txWakes      = g_diag.txWakes;
+		diag.sensorReads  = g_diag.sensorReads;
+		diag.i2cFailures  = g_diag.i2cFailures;
+		diag.bmpRetries   = g_diag.bmpRetries;
+		payloadAdvancedDiagEncode((uint8_t*)payload, &diag);
+		payload_len = PAYLOAD_ADVANCED_DIAG_LEN;
+	}
+	else{
+		payloadAdvancedDiag2_t diag;
+
+		diag.i2cSaved     = g_diag.i2cSaved;
+		diag.maxWake      = (g_diag.maxWake > 0xFFFFFF) ? 0xFFFFFF : g_diag.maxWake;
+		diag.resets       = g_diag.resets;
+		diag.resetCause   = g_diag.resetCause;
+		diag.em8500Status = g_diag.em8500Status;
+		payloadAdvancedDiag2Encode((uint8_t*)payload, &diag);
+		payload_len = PAYLOAD_ADVANCED_DIAG_2_LEN;
+	}
+}
 
-		//Wait in IDLE for LAST_CMD_DONE after 3 adv packets
-		while( ! rfAdvertisingDone) {
-		  powerDisableCPU();
-		  PRCMDeepSleep();
-		}
+// Energy frame: charge per activity since reset (software coulomb counter, system.c),
+// part aux_part
+void encodeEnergyFrame(void){
 
-		//Request radio to not force on system bus any more
-		radioCmdBusRequest(false);
-    }
+	if(aux_part == 0){
+		payloadAdvancedEnergy_t energy;
 
+		energy.rf      = energyCharge(ENERGY_RF);
+		energy.xosc    = energyCharge(ENERGY_XOSC);
+		energy.cpu     = energyCharge(ENERGY_CPU);
+		energy.idle    = energyCharge(ENERGY_IDLE);
+		payloadAdvancedEnergyEncode((uint8_t*)payload, &energy);
+		payload_len = PAYLOAD_ADVANCED_ENERGY_LEN;
+	}
+	else{
+		payloadAdvancedEnergy2_t energy;
+		uint32_t average = energyAverageCurrent();
+
+		energy.standby = energyCharge(ENERGY_STANDBY);
+		energy.averageCurrent = (average > 0xFFFF) ? 0xFFFF : average;
+		payloadAdvancedEnergy2Encode((uint8_t*)payload, &energy);
+		payload_len = PAYLOAD_ADVANCED_ENERGY_2_LEN;
+	}
 }
 
-
-void sleep(void){
+// Standby until the next wake-up event (reed switch, RTC channel 0). RF core and XOSC go
+// off, the next transmission boots the RF core again
+void standby(void){
 
 	    // Standby procedure
 
@@ -483,12 +647,14 @@ void sleep(void){
 
 	    // Enter Standby
 
+	    energyMcuState(ENERGY_STANDBY);
 	    powerDisableCPU();
 	    PRCMDeepSleep();
 
 	    SysCtrlAonUpdate();
 	    SysCtrlAdjustRechargeAfterPowerDown();
 	    SysCtrlAonSync();
+	    energyMcuState(ENERGY_CPU);
 
 		// Wakeup from RTC every 100ms, code starts execution from here
 
@@ -501,6 +667,375 @@ void sleep(void){
 
 	    //MCU will not request to be powered down on DeepSleep -> System goes only to IDLE
 	    powerDisableMcuPdReq();
+}
+
+// Sleep until RTC time t: standby, idle while an RF keep-alive session runs
+void sleepUntil(uint32_t t){
+
+	if((int32_t)(t - AONRTCCurrentCompareValueGet()) < RTC_WAKE_MIN){
+		while((int32_t)(t - AONRTCCurrentCompareValueGet()) > 0);
+		return;
+	}
+	rtcWakeAt(t);
+	// a reed interrupt wakes up early, the RTC channel stays armed
+	while((int32_t)(t - AONRTCCurrentCompareValueGet()) > 0){
+		if(rf_session_booted){
+			powerIdle();
+		}
+		else{
+			standby();
+		}
+	}
+}
+
+// Environment sensors (acquire.h): all conversions at once, CPU sleeps until the slowest
+// is done, results in one I2C session
+void acquireSensors(void){
+
+	sleepUntil(acquireStart(ACQUIRE_SENSORS));
+	acquireRead();
+
+	if(g_acquire.valid & ACQUIRE_BMP280){
+		pressure = SENSOR_RAW ? g_acquire.rawPressure : g_acquire.pressure;
+		temperature = (uint16_t)g_acquire.temperature;
+		raw_temperature = g_acquire.rawTemperature;
+	}
+	if(g_acquire.valid & ACQUIRE_HDC1000){
+		humidity = (uint16_t)g_acquire.humidity;
+		humidity_read = true;
+	}
+}
+
+void setData(void){
+
+		rfBootDone  = 0;
+	    rfSetupDone = 0;
+	    rfAdvertisingDone = 0;
+
+	    wake_start = AONRTCCurrentCompareValueGet();
+
+#if SENSOR_ACQUIRE
+	    // sensors first: the CPU can go to standby while they convert, the RF core is not booted yet
+	    if( count >= (count_max/2) && !readed_sensors && g_sensor_set){
+	    	readed_sensors=true;
+	    	DIAG_COUNT(sensorReads);
+	    	acquireSensors();
+	    }
+#endif
+
+	    wake_cold = !rf_session_booted;
+	    if(wake_cold){
+	    	bootRadio();
+	    }
+	    else{
+	    	// RF core still booted from last wake: only re-arm interrupts and bus request
+	    	initRadioInts();
+	    	radioCmdBusRequest(true);
+	    }
+
+	    powerEnablePeriph();
+	    powerEnableGPIOClockRunMode();
+
+	     /* Wait for domains to power on */
+	     while((PRCMPowerDomainStatus(PRCM_DOMAIN_PERIPH) != PRCM_DOMAIN_POWER_ON));
+
+
+#if !SENSOR_ACQUIRE
+	     // for energy sparing: read sensors out only all count/2-times
+	     if( count >= (count_max/2) && !readed_sensors && g_sensor_set){
+	    	 readed_sensors=true;
+			 g_acquire_span = AONRTCCurrentCompareValueGet();
+			 enable_bmp_280(1);
+			 DIAG_COUNT(sensorReads);
+
+#if SENSOR_RAW
+			 // one register read once the forced measurement is done, no compensation on the MCU
+			 while(!ready_bmp_280() || !value_raw_bmp_280(&pressure, &raw_temperature)){
+				 DIAG_COUNT(bmpRetries);
+			 }
+#else
+			 do{
+				pressure = value_bmp_280(BMP_280_SENSOR_TYPE_PRESS);  //  read and converts in pascal (96'000 Pa)
+				temperature = value_bmp_280(BMP_280_SENSOR_TYPE_TEMP);
+				if(pressure == 0x80000000){
+					DIAG_COUNT(bmpRetries);
+				}
+			 }while((pressure == 0x80000000) );
+#endif
+			 g_acquire_span = AONRTCCurrentCompareValueGet() - g_acquire_span;
+			 g_acquire_awake = g_acquire_span;
+	     }
+#endif
+
+	     // harvester status for the diagnostics frame, peripherals are still powered
+	     if(DIAG_EM8500 && diag_frame && aux_part == 1 && count >= count_max){
+	    	 g_diag.em8500Status = readStatusRegisterEM8500();
+	     }
+
+	    powerDisablePeriph();
+		// Disable clock for GPIO in CPU run mode
+		HWREGBITW(PRCM_BASE + PRCM_O_GPIOCLKGR, PRCM_GPIOCLKGR_CLK_EN_BITN) = 0;
+		// Load clock settings
+		HWREGBITW(PRCM_BASE + PRCM_O_CLKLOADCTL, PRCM_CLKLOADCTL_LOAD_BITN) = 1;
+
+
+		if(diag_frame){
+			encodeDiagFrame();
+		}
+		else if(energy_frame){
+			encodeEnergyFrame();
+		}
+#if PAYLOAD_COMPACT
+		else if(calib_frame){
+			encodeCalibFrame();
+		}
+		else{
+			// bit-packed, only fields read in this cycle (payload_compact.h)
+			// raw on every frame of a SENSOR_RAW build: it also tells the history pressures
+			tx_reading.flags       = SENSOR_RAW ? COMPACT_RAW : 0;
+			tx_reading.seq         = sequenceNumber;
+			tx_reading.timediff    = g_timediff;
+			tx_reading.pressure    = pressure;
+			tx_reading.temperature = (int16_t)temperature;
+			tx_reading.humidity    = humidity / 10;
+			tx_reading.rawTemperature = raw_temperature;
+			if(env_frame && pressure != 0){
+				tx_reading.flags |= COMPACT_HAS_PRESSURE | COMPACT_HAS_TEMPERATURE;
+			}
+			if(env_frame && humidity_read){
+				tx_reading.flags |= COMPACT_HAS_HUMIDITY;
+			}
+#if RIDE_AGGREGATES
+			// ride window up to now, handed back in sendData() if it is not transmitted.
+			// Empty unless taken in this cycle: the window of the last frame was sent already
+			memset(&tx_reading.ride, 0, sizeof(tx_reading.ride));
+			if(count >= count_max){
+				rideWindowTake(&tx_reading.ride);
+				rideTotalsGet(&tx_reading.rideTotals);
+				tx_reading.flags |= COMPACT_HAS_RIDE;
+			}
+#endif
+			payload_len = payloadCompactEncode((uint8_t*)payload, &tx_reading, tx_history,
+											   (tx_history_len < PAYLOAD_REDUNDANCY) ? tx_history_len : PAYLOAD_REDUNDANCY);
+		}
+#else
+		else if(env_frame){
+			// environment frame: gateway/schema/advanced_uplink.schema
+			payloadAdvancedUplink_t uplink;
+
+			uplink.seq         = sequenceNumber;
+			uplink.timediff    = g_timediff;
+			uplink.pressure    = pressure;
+			uplink.temperature = temperature;
+			uplink.humidity    = humidity;			// 0 without HDC1000 in ACQUIRE_SENSORS
+			payloadAdvancedUplinkEncode((uint8_t*)payload, &uplink);
+			payload_len = PAYLOAD_ADVANCED_UPLINK_LEN;
+		}
+		else{
+			// speed frame: gateway/schema/advanced_speed.schema
+			payloadAdvancedSpeed_t speed;
+
+			speed.seq      = sequenceNumber;
+			speed.timediff = g_timediff;
+			payloadAdvancedSpeedEncode((uint8_t*)payload, &speed);
+			payload_len = PAYLOAD_ADVANCED_SPEED_LEN;
+		}
+#endif
+
+	   	sequenceNumber++;
+}
+
+
+// True if the payload is within the deadband of the last sent one and no heartbeat is due
+bool deadbandHolds(void){
+
+	if(!tx_sent_once || AONRTCCurrentCompareValueGet() - last_tx_time >= DEADBAND_HEARTBEAT){
+		return false;
+	}
+	if(ABS_DIFF(g_timediff, last_tx_timediff) > DEADBAND_TIMEDIFF){
+		return false;
+	}
+	// sensors sampled in this cycle (environment frame)
+	if(pressure != 0){
+#if SENSOR_RAW
+		if(last_tx_pressure == 0 || ABS_DIFF(pressure, last_tx_pressure) > DEADBAND_PRESSURE_RAW
+		   || ABS_DIFF(raw_temperature, last_tx_raw_temperature) > DEADBAND_TEMPERATURE_RAW){
+			return false;
+		}
+#else
+		if(last_tx_pressure == 0 || ABS_DIFF(pressure, last_tx_pressure) > DEADBAND_PRESSURE
+		   || ABS_DIFF((int16_t)temperature, (int16_t)last_tx_temperature) > DEADBAND_TEMPERATURE){
+			return false;
+		}
+#endif
+	}
+	return true;
+}
+
+void sendData(void){
+
+	bool suppress;
+
+    //Start radio setup and linked advertisment
+   	// for energy sparing: only each 100 time send data
+    if(count >= count_max){
+    	count = 0;
+    	readed_sensors=false;
+
+    	// nothing changed: stay silent. Sequence number keeps counting, the next packet
+    	// (history entry) shows the gateway that the gap was suppressed and not lost
+    	suppress = DEADBAND_TX && !aux_frame && deadbandHolds();
+
+    	if(!suppress && !aux_frame){
+    		last_tx_time = AONRTCCurrentCompareValueGet();
+    		last_tx_timediff = g_timediff;
+    		if(pressure != 0){
+    			last_tx_pressure = pressure;
+    			last_tx_temperature = temperature;
+    			last_tx_raw_temperature = raw_temperature;
+    		}
+    		tx_sent_once = true;
+    	}
+
+    	// sensor values are used, next cycle samples again (only if it is an environment frame)
+    	pressure = 0;
+    	temperature = 0;
+    	humidity = 0;
+    	humidity_read = false;
+    	if(aux_frame && aux_part == 0){
+    		aux_part = 1;									// second part next, counters after it
+    	}
+    	else{
+    		aux_part = 0;
+    		if(env_frame){
+    			frames_since_env = 0;
+    		}
+    		else if(frames_since_env < 0xFF){
+    			frames_since_env++;
+    		}
+    		if(calib_frame){
+    			frames_since_calib = 0;
+    		}
+    		else if(frames_since_calib < 0xFF){
+    			frames_since_calib++;
+    		}
+    		if(diag_frame){
+    			frames_since_diag = 0;
+    		}
+    		else if(frames_since_diag < 0xFF){
+    			frames_since_diag++;
+    		}
+    	}
+
+#if RIDE_AGGREGATES
+    	// window goes into the next transmitted ride section
+    	if(!aux_frame && (suppress || !(tx_reading.flags & COMPACT_HAS_RIDE))){
+    		rideWindowReturn(&tx_reading.ride);
+    		memset(&tx_reading.ride, 0, sizeof(tx_reading.ride));
+    	}
+#endif
+
+    	if(suppress){
+    		g_tx_suppressed++;
+    		return;
+    	}
+
+    	DIAG_COUNT(txWakes);
+    	payload_len = authSeal((uint8_t*)payload, payload_len);
+    	radioUpdateAdvData(payload_len, payload);
+
+#if PAYLOAD_COMPACT
+    	// key fields go into the next packets as redundancy copy
+    	if(!aux_frame){
+    		memmove(&tx_history[1], &tx_history[0], (COMPACT_MAX_HISTORY - 1) * sizeof(compactReading_t));
+    		tx_history[0] = tx_reading;
+    		if(tx_history_len < COMPACT_MAX_HISTORY){
+    			tx_history_len++;
+    		}
+    	}
+#endif
+
+    	// keep-alive: set up the synth once, then send the advertising chain only
+    	if(rf_keep_alive){
+    		radioSelectProfile(rf_session_setup ? RADIO_PROFILE_KEEP_ADV : RADIO_PROFILE_KEEP_SETUP);
+    	}
+
+    	// downlink: listen for the gateway after every DOWNLINK_SCAN_RATIO-th transmission at high energy
+    	downlink_scan = false;
+    	if(DOWNLINK_SCAN && g_timediff != 0 && g_timediff < DOWNLINK_SCAN_TIMEDIFF){
+    		if(++downlink_tx_count >= DOWNLINK_SCAN_RATIO){
+    			downlink_tx_count = 0;
+    			downlink_scan = true;
+    			downlinkArm();
+    			radioSelectProfile((rf_keep_alive && rf_session_setup) ? RADIO_PROFILE_KEEP_ADV_SCAN : RADIO_PROFILE_FULL_3CH_SCAN);
+    		}
+    	}
+
+    	// fixed TX slot: RF core waits for the RAT, CPU sleeps below until CMD_DONE
+    	if(RAT_SLOT_TX){
+    		radioScheduleTransmit(nextSlotRat());
+    	}
+    	// radio setup reads FCFG trims: flash on in IDLE. A warm wake turned it off after the
+    	// last setup, and keep-setup or a dropped keep-alive still start with one
+    	if(radioActiveHasSetup()){
+    		powerEnableFlashInIdle();
+    	}
+    	energyOn(ENERGY_RF);
+    	radioSetupAndTransmit();
+
+		//Wait in IDLE for CMD_DONE interrupt after radio setup. ISR will disable radio interrupts
+		while( ! rfSetupDone) {
+		  powerIdle();
+		}
+		//Disable flash in IDLE after CMD_RADIO_SETUP is done (radio setup reads FCFG trim values)
+		powerDisableFlashInIdle();
+
+		//Wait in IDLE for LAST_CMD_DONE after 3 adv packets
+		while( ! rfAdvertisingDone) {
+		  powerIdle();
+		}
+		energyOff(ENERGY_RF);
+
+		//Request radio to not force on system bus any more
+		radioCmdBusRequest(false);
+
+		// full-3ch-scan ends with FS powerdown, next keep-alive TX has to set up the synth again
+		rf_session_setup = rf_keep_alive && (radioActiveProfile() != RADIO_PROFILE_FULL_3CH_SCAN);
+
+		// new tuning from the gateway: count_max is picked up in next getData(), TX power needs new chains
+		if(downlink_scan && downlinkProcess(radioDeviceAddress())){
+			radioSetTxPower(g_tuning.txPowerIB, g_tuning.txPowerGC);
+			rf_session_setup = false;
+		}
+
+		// wake-to-TX-done time, cold boot vs. warm keep-alive session
+		if(wake_cold){
+			g_tx_ticks_cold = AONRTCCurrentCompareValueGet() - wake_start;
+		}
+		else{
+			g_tx_ticks_warm = AONRTCCurrentCompareValueGet() - wake_start;
+		}
+    }
+
+}
+
+
+void sleep(void){
+
+	    diagWakeEnd(AONRTCCurrentCompareValueGet() - wake_start);
+
+	    // RF keep-alive: RF core, XOSC and AUX stay on, so only IDLE is possible.
+	    // Next reed interrupt wakes the CPU with the radio ready to transmit
+	    if(rf_keep_alive && rf_session_booted){
+	    	powerIdle();
+	    	return;
+	    }
+
+	    // Energy dropped (or no keep-alive): full power down, next wake boots the RF core again
+	    rf_session_booted = false;
+	    rf_session_setup = false;
+
+	    standby();
 
 }
 
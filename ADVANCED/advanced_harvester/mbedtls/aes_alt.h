@@ -0,0 +1,98 @@
+/**
+ * \file aes_alt.h
+ *
+ * \brief AES on the CC26xx crypto engine (MBEDTLS_AES_ALT, aes_alt.c)
+ *
+ *  The engine does AES-128 only: 192 and 256 bit keys are refused with
+ *  MBEDTLS_ERR_AES_INVALID_KEY_LENGTH. ECB, CBC and CTR run as one DMA
+ *  job per call, CFB uses single ECB blocks. The PERIPH power domain is
+ *  switched on for the call if it is off. Not reentrant (one engine).
+ */
+#ifndef MBEDTLS_AES_ALT_H
+#define MBEDTLS_AES_ALT_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define MBEDTLS_ERR_AES_HW_ACCEL_FAILED                   -0x0025  /**< Crypto engine key store or DMA bus error. */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * \brief          AES context structure
+ *
+ * \note           The key is loaded into the engine key store on every
+ *                 call, the store is lost with the PERIPH domain
+ */
+typedef struct
+{
+    uint32_t key[4];            /*!<  AES-128 key, word aligned for the key store DMA */
+}
+mbedtls_aes_context;
+
+void mbedtls_aes_init( mbedtls_aes_context *ctx );
+
+void mbedtls_aes_free( mbedtls_aes_context *ctx );
+
+int mbedtls_aes_setkey_enc( mbedtls_aes_context *ctx, const unsigned char *key,
+                    unsigned int keybits );
+
+int mbedtls_aes_setkey_dec( mbedtls_aes_context *ctx, const unsigned char *key,
+                    unsigned int keybits );
+
+int mbedtls_aes_crypt_ecb( mbedtls_aes_context *ctx,
+                    int mode,
+                    const unsigned char input[16],
+                    unsigned char output[16] );
+
+#if defined(MBEDTLS_CIPHER_MODE_CBC)
+int mbedtls_aes_crypt_cbc( mbedtls_aes_context *ctx,
+                    int mode,
+                    size_t length,
+                    unsigned char iv[16],
+                    const unsigned char *input,
+                    unsigned char *output );
+#endif /* MBEDTLS_CIPHER_MODE_CBC */
+
+#if defined(MBEDTLS_CIPHER_MODE_CFB)
+int mbedtls_aes_crypt_cfb128( mbedtls_aes_context *ctx,
+                       int mode,
+                       size_t length,
+                       size_t *iv_off,
+                       unsigned char iv[16],
+                       const unsigned char *input,
+                       unsigned char *output );
+
+int mbedtls_aes_crypt_cfb8( mbedtls_aes_context *ctx,
+                    int mode,
+                    size_t length,
+                    unsigned char iv[16],
+                    const unsigned char *input,
+                    unsigned char *output );
+#endif /*MBEDTLS_CIPHER_MODE_CFB */
+
+#if defined(MBEDTLS_CIPHER_MODE_CTR)
+int mbedtls_aes_crypt_ctr( mbedtls_aes_context *ctx,
+                       size_t length,
+                       size_t *nc_off,
+                       unsigned char nonce_counter[16],
+                       unsigned char stream_block[16],
+                       const unsigned char *input,
+                       unsigned char *output );
+#endif /* MBEDTLS_CIPHER_MODE_CTR */
+
+void mbedtls_aes_encrypt( mbedtls_aes_context *ctx,
+                          const unsigned char input[16],
+                          unsigned char output[16] );
+
+void mbedtls_aes_decrypt( mbedtls_aes_context *ctx,
+                          const unsigned char input[16],
+                          unsigned char output[16] );
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* aes_alt.h */
@@ -224,8 +224,13 @@
  *
  * Uncomment a macro to enable alternate implementation of the corresponding
  * module.
+ *
+ * advanced_harvester: the CC26xx crypto engine (aes_alt.c, AES-128 only) on the
+ * target, aes.c on the host. Comment out for the software AES on the target.
  */
-//#define MBEDTLS_AES_ALT
+#if defined(__TI_COMPILER_VERSION__)
+#define MBEDTLS_AES_ALT
+#endif
 //#define MBEDTLS_ARC4_ALT
 //#define MBEDTLS_BLOWFISH_ALT
 //#define MBEDTLS_CAMELLIA_ALT
@@ -868,8 +873,10 @@
  * \def MBEDTLS_SELF_TEST
  *
  * Enable the checkup functions (*_self_test).
+ *
+ * advanced_harvester: called by aes_bench.c only, otherwise dropped by the linker.
  */
-//#define MBEDTLS_SELF_TEST
+#define MBEDTLS_SELF_TEST
 
 /**
  * \def MBEDTLS_SHA256_SMALLER
@@ -0,0 +1,67 @@
+/*
+ * payload_advanced_calib.h
+ *
+ * Generated by gateway/payloadgen.py from schema/advanced_calib.schema - do not edit.
+ */
+
+#ifndef PAYLOAD_ADVANCED_CALIB_H_
+#define PAYLOAD_ADVANCED_CALIB_H_
+
+#include <stdint.h>
+
+#define PAYLOAD_ADVANCED_CALIB_LEN		19
+
+typedef struct {
+  uint16_t dig_t1;
+  uint16_t dig_t2;
+  uint16_t dig_t3;
+  uint16_t dig_p1;
+  uint16_t dig_p2;
+  uint16_t dig_p3;
+} payloadAdvancedCalib_t;
+
+#ifndef PAYLOAD_CRC16_DEFINED
+#define PAYLOAD_CRC16_DEFINED
+// CRC-16/CCITT-FALSE (poly 0x1021, init 0xFFFF), 4 bit table
+static const uint16_t payloadCrc16Table[16] = {0x0000, 0x1021, 0x2042, 0x3063, 0x4084, 0x50A5, 0x60C6, 0x70E7, 0x8108, 0x9129, 0xA14A, 0xB16B, 0xC18C, 0xD1AD, 0xE1CE, 0xF1EF};
+
+static inline uint16_t payloadCrc16(const uint8_t *data, uint8_t len) {
+  uint16_t crc = 0xFFFF;
+  uint8_t i;
+
+  for(i = 0; i < len; i++) {
+    crc = (crc << 4) ^ payloadCrc16Table[(crc >> 12) ^ (data[i] >> 4)];
+    crc = (crc << 4) ^ payloadCrc16Table[(crc >> 12) ^ (data[i] & 0x0F)];
+  }
+  return crc;
+}
+#endif
+
+// Encode into buf (PAYLOAD_ADVANCED_CALIB_LEN bytes)
+static inline void payloadAdvancedCalibEncode(uint8_t *buf, const payloadAdvancedCalib_t *v) {
+  uint16_t crc;
+
+  buf[0] = 18;
+  buf[1] = 0x16;
+  buf[2] = 0xDE;
+  buf[3] = 0xBB;
+  buf[4] = 0x01;
+  buf[5] = (uint8_t)(v->dig_t1 >> 8);
+  buf[6] = (uint8_t)v->dig_t1;
+  buf[7] = (uint8_t)(v->dig_t2 >> 8);
+  buf[8] = (uint8_t)v->dig_t2;
+  buf[9] = (uint8_t)(v->dig_t3 >> 8);
+  buf[10] = (uint8_t)v->dig_t3;
+  buf[11] = (uint8_t)(v->dig_p1 >> 8);
+  buf[12] = (uint8_t)v->dig_p1;
+  buf[13] = (uint8_t)(v->dig_p2 >> 8);
+  buf[14] = (uint8_t)v->dig_p2;
+  buf[15] = (uint8_t)(v->dig_p3 >> 8);
+  buf[16] = (uint8_t)v->dig_p3;
+
+  crc = payloadCrc16(buf, 17);
+  buf[17] = (uint8_t)(crc >> 8);
+  buf[18] = (uint8_t)crc;
+}
+
+#endif /* PAYLOAD_ADVANCED_CALIB_H_ */
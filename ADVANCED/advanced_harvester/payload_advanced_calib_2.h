@@ -0,0 +1,67 @@
+/*
+ * payload_advanced_calib_2.h
+ *
+ * Generated by gateway/payloadgen.py from schema/advanced_calib_2.schema - do not edit.
+ */
+
+#ifndef PAYLOAD_ADVANCED_CALIB_2_H_
+#define PAYLOAD_ADVANCED_CALIB_2_H_
+
+#include <stdint.h>
+
+#define PAYLOAD_ADVANCED_CALIB_2_LEN		19
+
+typedef struct {
+  uint16_t dig_p4;
+  uint16_t dig_p5;
+  uint16_t dig_p6;
+  uint16_t dig_p7;
+  uint16_t dig_p8;
+  uint16_t dig_p9;
+} payloadAdvancedCalib2_t;
+
+#ifndef PAYLOAD_CRC16_DEFINED
+#define PAYLOAD_CRC16_DEFINED
+// CRC-16/CCITT-FALSE (poly 0x1021, init 0xFFFF), 4 bit table
+static const uint16_t payloadCrc16Table[16] = {0x0000, 0x1021, 0x2042, 0x3063, 0x4084, 0x50A5, 0x60C6, 0x70E7, 0x8108, 0x9129, 0xA14A, 0xB16B, 0xC18C, 0xD1AD, 0xE1CE, 0xF1EF};
+
+static inline uint16_t payloadCrc16(const uint8_t *data, uint8_t len) {
+  uint16_t crc = 0xFFFF;
+  uint8_t i;
+
+  for(i = 0; i < len; i++) {
+    crc = (crc << 4) ^ payloadCrc16Table[(crc >> 12) ^ (data[i] >> 4)];
+    crc = (crc << 4) ^ payloadCrc16Table[(crc >> 12) ^ (data[i] & 0x0F)];
+  }
+  return crc;
+}
+#endif
+
+// Encode into buf (PAYLOAD_ADVANCED_CALIB_2_LEN bytes)
+static inline void payloadAdvancedCalib2Encode(uint8_t *buf, const payloadAdvancedCalib2_t *v) {
+  uint16_t crc;
+
+  buf[0] = 18;
+  buf[1] = 0x16;
+  buf[2] = 0xDE;
+  buf[3] = 0xBB;
+  buf[4] = 0x02;
+  buf[5] = (uint8_t)(v->dig_p4 >> 8);
+  buf[6] = (uint8_t)v->dig_p4;
+  buf[7] = (uint8_t)(v->dig_p5 >> 8);
+  buf[8] = (uint8_t)v->dig_p5;
+  buf[9] = (uint8_t)(v->dig_p6 >> 8);
+  buf[10] = (uint8_t)v->dig_p6;
+  buf[11] = (uint8_t)(v->dig_p7 >> 8);
+  buf[12] = (uint8_t)v->dig_p7;
+  buf[13] = (uint8_t)(v->dig_p8 >> 8);
+  buf[14] = (uint8_t)v->dig_p8;
+  buf[15] = (uint8_t)(v->dig_p9 >> 8);
+  buf[16] = (uint8_t)v->dig_p9;
+
+  crc = payloadCrc16(buf, 17);
+  buf[17] = (uint8_t)(crc >> 8);
+  buf[18] = (uint8_t)crc;
+}
+
+#endif /* PAYLOAD_ADVANCED_CALIB_2_H_ */
@@ -0,0 +1,73 @@
+/*
+ * payload_advanced_diag.h
+ *
+ * Generated by gateway/payloadgen.py from schema/advanced_diag.schema - do not edit.
+ */
+
+#ifndef PAYLOAD_ADVANCED_DIAG_H_
+#define PAYLOAD_ADVANCED_DIAG_H_
+
+#include <stdint.h>
+
+#define PAYLOAD_ADVANCED_DIAG_LEN		25
+
+typedef struct {
+  uint16_t epoch;		// auth epoch (auth.h), the gateway resyncs its nonce counter from it (auth.hpp); 0 without AUTH_PAYLOAD
+  uint32_t wakes;		// main loop iterations since power-on
+  uint32_t txWakes;		// wakes with a transmission
+  uint32_t sensorReads;		// BMP280 read cycles
+  uint16_t i2cFailures;		// failed I2C register reads/writes
+  uint16_t bmpRetries;		// extra rounds of the BMP280 read loop
+} payloadAdvancedDiag_t;
+
+#ifndef PAYLOAD_CRC16_DEFINED
+#define PAYLOAD_CRC16_DEFINED
+// CRC-16/CCITT-FALSE (poly 0x1021, init 0xFFFF), 4 bit table
+static const uint16_t payloadCrc16Table[16] = {0x0000, 0x1021, 0x2042, 0x3063, 0x4084, 0x50A5, 0x60C6, 0x70E7, 0x8108, 0x9129, 0xA14A, 0xB16B, 0xC18C, 0xD1AD, 0xE1CE, 0xF1EF};
+
+static inline uint16_t payloadCrc16(const uint8_t *data, uint8_t len) {
+  uint16_t crc = 0xFFFF;
+  uint8_t i;
+
+  for(i = 0; i < len; i++) {
+    crc = (crc << 4) ^ payloadCrc16Table[(crc >> 12) ^ (data[i] >> 4)];
+    crc = (crc << 4) ^ payloadCrc16Table[(crc >> 12) ^ (data[i] & 0x0F)];
+  }
+  return crc;
+}
+#endif
+
+// Encode into buf (PAYLOAD_ADVANCED_DIAG_LEN bytes)
+static inline void payloadAdvancedDiagEncode(uint8_t *buf, const payloadAdvancedDiag_t *v) {
+  uint16_t crc;
+
+  buf[0] = 24;
+  buf[1] = 0x16;
+  buf[2] = 0xDE;
+  buf[3] = 0xBC;
+  buf[4] = 0x01;
+  buf[5] = (uint8_t)(v->epoch >> 8);
+  buf[6] = (uint8_t)v->epoch;
+  buf[7] = (uint8_t)(v->wakes >> 24);
+  buf[8] = (uint8_t)(v->wakes >> 16);
+  buf[9] = (uint8_t)(v->wakes >> 8);
+  buf[10] = (uint8_t)v->wakes;
+  buf[11] = (uint8_t)(v->txWakes >> 24);
+  buf[12] = (uint8_t)(v->txWakes >> 16);
+  buf[13] = (uint8_t)(v->txWakes >> 8);
+  buf[14] = (uint8_t)v->txWakes;
+  buf[15] = (uint8_t)(v->sensorReads >> 24);
+  buf[16] = (uint8_t)(v->sensorReads >> 16);
+  buf[17] = (uint8_t)(v->sensorReads >> 8);
+  buf[18] = (uint8_t)v->sensorReads;
+  buf[19] = (uint8_t)(v->i2cFailures >> 8);
+  buf[20] = (uint8_t)v->i2cFailures;
+  buf[21] = (uint8_t)(v->bmpRetries >> 8);
+  buf[22] = (uint8_t)v->bmpRetries;
+
+  crc = payloadCrc16(buf, 23);
+  buf[23] = (uint8_t)(crc >> 8);
+  buf[24] = (uint8_t)crc;
+}
+
+#endif /* PAYLOAD_ADVANCED_DIAG_H_ */
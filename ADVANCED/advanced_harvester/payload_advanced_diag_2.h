@@ -0,0 +1,63 @@
+/*
+ * payload_advanced_diag_2.h
+ *
+ * Generated by gateway/payloadgen.py from schema/advanced_diag_2.schema - do not edit.
+ */
+
+#ifndef PAYLOAD_ADVANCED_DIAG_2_H_
+#define PAYLOAD_ADVANCED_DIAG_2_H_
+
+#include <stdint.h>
+
+#define PAYLOAD_ADVANCED_DIAG_2_LEN		16
+
+typedef struct {
+  uint16_t i2cSaved;		// I2C bytes not sent thanks to the sensor register shadow, saturates
+  uint32_t maxWake;		// longest wake [1/65536 s], saturates at 0xFFFFFF
+  uint16_t resets;		// warm resets since power-on
+  uint8_t resetCause;		// RSTSRC_*: 0 power-on, 1 pin, 2-4 VDDS/VDD/VDDR loss, 5 clock loss, 6 sysreset, 7 warm
+  uint8_t em8500Status;		// last EM8500 status register (0x29)
+} payloadAdvancedDiag2_t;
+
+#ifndef PAYLOAD_CRC16_DEFINED
+#define PAYLOAD_CRC16_DEFINED
+// CRC-16/CCITT-FALSE (poly 0x1021, init 0xFFFF), 4 bit table
+static const uint16_t payloadCrc16Table[16] = {0x0000, 0x1021, 0x2042, 0x3063, 0x4084, 0x50A5, 0x60C6, 0x70E7, 0x8108, 0x9129, 0xA14A, 0xB16B, 0xC18C, 0xD1AD, 0xE1CE, 0xF1EF};
+
+static inline uint16_t payloadCrc16(const uint8_t *data, uint8_t len) {
+  uint16_t crc = 0xFFFF;
+  uint8_t i;
+
+  for(i = 0; i < len; i++) {
+    crc = (crc << 4) ^ payloadCrc16Table[(crc >> 12) ^ (data[i] >> 4)];
+    crc = (crc << 4) ^ payloadCrc16Table[(crc >> 12) ^ (data[i] & 0x0F)];
+  }
+  return crc;
+}
+#endif
+
+// Encode into buf (PAYLOAD_ADVANCED_DIAG_2_LEN bytes)
+static inline void payloadAdvancedDiag2Encode(uint8_t *buf, const payloadAdvancedDiag2_t *v) {
+  uint16_t crc;
+
+  buf[0] = 15;
+  buf[1] = 0x16;
+  buf[2] = 0xDE;
+  buf[3] = 0xBC;
+  buf[4] = 0x02;
+  buf[5] = (uint8_t)(v->i2cSaved >> 8);
+  buf[6] = (uint8_t)v->i2cSaved;
+  buf[7] = (uint8_t)(v->maxWake >> 16);
+  buf[8] = (uint8_t)(v->maxWake >> 8);
+  buf[9] = (uint8_t)v->maxWake;
+  buf[10] = (uint8_t)(v->resets >> 8);
+  buf[11] = (uint8_t)v->resets;
+  buf[12] = (uint8_t)v->resetCause;
+  buf[13] = (uint8_t)v->em8500Status;
+
+  crc = payloadCrc16(buf, 14);
+  buf[14] = (uint8_t)(crc >> 8);
+  buf[15] = (uint8_t)crc;
+}
+
+#endif /* PAYLOAD_ADVANCED_DIAG_2_H_ */
@@ -0,0 +1,69 @@
+/*
+ * payload_advanced_energy.h
+ *
+ * Generated by gateway/payloadgen.py from schema/advanced_energy.schema - do not edit.
+ */
+
+#ifndef PAYLOAD_ADVANCED_ENERGY_H_
+#define PAYLOAD_ADVANCED_ENERGY_H_
+
+#include <stdint.h>
+
+#define PAYLOAD_ADVANCED_ENERGY_LEN		23
+
+typedef struct {
+  uint32_t rf;		// radio command chains [uC]
+  uint32_t xosc;		// 24 MHz XOSC on [uC]
+  uint32_t cpu;		// CPU active [uC]
+  uint32_t idle;		// CPU off, MCU powered [uC]
+} payloadAdvancedEnergy_t;
+
+#ifndef PAYLOAD_CRC16_DEFINED
+#define PAYLOAD_CRC16_DEFINED
+// CRC-16/CCITT-FALSE (poly 0x1021, init 0xFFFF), 4 bit table
+static const uint16_t payloadCrc16Table[16] = {0x0000, 0x1021, 0x2042, 0x3063, 0x4084, 0x50A5, 0x60C6, 0x70E7, 0x8108, 0x9129, 0xA14A, 0xB16B, 0xC18C, 0xD1AD, 0xE1CE, 0xF1EF};
+
+static inline uint16_t payloadCrc16(const uint8_t *data, uint8_t len) {
+  uint16_t crc = 0xFFFF;
+  uint8_t i;
+
+  for(i = 0; i < len; i++) {
+    crc = (crc << 4) ^ payloadCrc16Table[(crc >> 12) ^ (data[i] >> 4)];
+    crc = (crc << 4) ^ payloadCrc16Table[(crc >> 12) ^ (data[i] & 0x0F)];
+  }
+  return crc;
+}
+#endif
+
+// Encode into buf (PAYLOAD_ADVANCED_ENERGY_LEN bytes)
+static inline void payloadAdvancedEnergyEncode(uint8_t *buf, const payloadAdvancedEnergy_t *v) {
+  uint16_t crc;
+
+  buf[0] = 22;
+  buf[1] = 0x16;
+  buf[2] = 0xDE;
+  buf[3] = 0xBD;
+  buf[4] = 0x01;
+  buf[5] = (uint8_t)(v->rf >> 24);
+  buf[6] = (uint8_t)(v->rf >> 16);
+  buf[7] = (uint8_t)(v->rf >> 8);
+  buf[8] = (uint8_t)v->rf;
+  buf[9] = (uint8_t)(v->xosc >> 24);
+  buf[10] = (uint8_t)(v->xosc >> 16);
+  buf[11] = (uint8_t)(v->xosc >> 8);
+  buf[12] = (uint8_t)v->xosc;
+  buf[13] = (uint8_t)(v->cpu >> 24);
+  buf[14] = (uint8_t)(v->cpu >> 16);
+  buf[15] = (uint8_t)(v->cpu >> 8);
+  buf[16] = (uint8_t)v->cpu;
+  buf[17] = (uint8_t)(v->idle >> 24);
+  buf[18] = (uint8_t)(v->idle >> 16);
+  buf[19] = (uint8_t)(v->idle >> 8);
+  buf[20] = (uint8_t)v->idle;
+
+  crc = payloadCrc16(buf, 21);
+  buf[21] = (uint8_t)(crc >> 8);
+  buf[22] = (uint8_t)crc;
+}
+
+#endif /* PAYLOAD_ADVANCED_ENERGY_H_ */
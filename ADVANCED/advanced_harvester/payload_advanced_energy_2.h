@@ -0,0 +1,57 @@
+/*
+ * payload_advanced_energy_2.h
+ *
+ * Generated by gateway/payloadgen.py from schema/advanced_energy_2.schema - do not edit.
+ */
+
+#ifndef PAYLOAD_ADVANCED_ENERGY_2_H_
+#define PAYLOAD_ADVANCED_ENERGY_2_H_
+
+#include <stdint.h>
+
+#define PAYLOAD_ADVANCED_ENERGY_2_LEN		13
+
+typedef struct {
+  uint32_t standby;		// standby [uC]
+  uint16_t averageCurrent;		// over the last ENERGY_WINDOW [uA], saturates at 0xFFFF
+} payloadAdvancedEnergy2_t;
+
+#ifndef PAYLOAD_CRC16_DEFINED
+#define PAYLOAD_CRC16_DEFINED
+// CRC-16/CCITT-FALSE (poly 0x1021, init 0xFFFF), 4 bit table
+static const uint16_t payloadCrc16Table[16] = {0x0000, 0x1021, 0x2042, 0x3063, 0x4084, 0x50A5, 0x60C6, 0x70E7, 0x8108, 0x9129, 0xA14A, 0xB16B, 0xC18C, 0xD1AD, 0xE1CE, 0xF1EF};
+
+static inline uint16_t payloadCrc16(const uint8_t *data, uint8_t len) {
+  uint16_t crc = 0xFFFF;
+  uint8_t i;
+
+  for(i = 0; i < len; i++) {
+    crc = (crc << 4) ^ payloadCrc16Table[(crc >> 12) ^ (data[i] >> 4)];
+    crc = (crc << 4) ^ payloadCrc16Table[(crc >> 12) ^ (data[i] & 0x0F)];
+  }
+  return crc;
+}
+#endif
+
+// Encode into buf (PAYLOAD_ADVANCED_ENERGY_2_LEN bytes)
+static inline void payloadAdvancedEnergy2Encode(uint8_t *buf, const payloadAdvancedEnergy2_t *v) {
+  uint16_t crc;
+
+  buf[0] = 12;
+  buf[1] = 0x16;
+  buf[2] = 0xDE;
+  buf[3] = 0xBD;
+  buf[4] = 0x02;
+  buf[5] = (uint8_t)(v->standby >> 24);
+  buf[6] = (uint8_t)(v->standby >> 16);
+  buf[7] = (uint8_t)(v->standby >> 8);
+  buf[8] = (uint8_t)v->standby;
+  buf[9] = (uint8_t)(v->averageCurrent >> 8);
+  buf[10] = (uint8_t)v->averageCurrent;
+
+  crc = payloadCrc16(buf, 11);
+  buf[11] = (uint8_t)(crc >> 8);
+  buf[12] = (uint8_t)crc;
+}
+
+#endif /* PAYLOAD_ADVANCED_ENERGY_2_H_ */
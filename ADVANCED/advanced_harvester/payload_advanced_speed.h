@@ -0,0 +1,56 @@
+/*
+ * payload_advanced_speed.h
+ *
+ * Generated by gateway/payloadgen.py from schema/advanced_speed.schema - do not edit.
+ */
+
+#ifndef PAYLOAD_ADVANCED_SPEED_H_
+#define PAYLOAD_ADVANCED_SPEED_H_
+
+#include <stdint.h>
+
+#define PAYLOAD_ADVANCED_SPEED_LEN		12
+
+typedef struct {
+  uint16_t seq;		// sequence number
+  uint32_t timediff;		// wheel period [1/65536 s]
+} payloadAdvancedSpeed_t;
+
+#ifndef PAYLOAD_CRC16_DEFINED
+#define PAYLOAD_CRC16_DEFINED
+// CRC-16/CCITT-FALSE (poly 0x1021, init 0xFFFF), 4 bit table
+static const uint16_t payloadCrc16Table[16] = {0x0000, 0x1021, 0x2042, 0x3063, 0x4084, 0x50A5, 0x60C6, 0x70E7, 0x8108, 0x9129, 0xA14A, 0xB16B, 0xC18C, 0xD1AD, 0xE1CE, 0xF1EF};
+
+static inline uint16_t payloadCrc16(const uint8_t *data, uint8_t len) {
+  uint16_t crc = 0xFFFF;
+  uint8_t i;
+
+  for(i = 0; i < len; i++) {
+    crc = (crc << 4) ^ payloadCrc16Table[(crc >> 12) ^ (data[i] >> 4)];
+    crc = (crc << 4) ^ payloadCrc16Table[(crc >> 12) ^ (data[i] & 0x0F)];
+  }
+  return crc;
+}
+#endif
+
+// Encode into buf (PAYLOAD_ADVANCED_SPEED_LEN bytes)
+static inline void payloadAdvancedSpeedEncode(uint8_t *buf, const payloadAdvancedSpeed_t *v) {
+  uint16_t crc;
+
+  buf[0] = 11;
+  buf[1] = 0x16;
+  buf[2] = 0xDE;
+  buf[3] = 0xBA;
+  buf[4] = (uint8_t)(v->seq >> 8);
+  buf[5] = (uint8_t)v->seq;
+  buf[6] = (uint8_t)(v->timediff >> 24);
+  buf[7] = (uint8_t)(v->timediff >> 16);
+  buf[8] = (uint8_t)(v->timediff >> 8);
+  buf[9] = (uint8_t)v->timediff;
+
+  crc = payloadCrc16(buf, 10);
+  buf[10] = (uint8_t)(crc >> 8);
+  buf[11] = (uint8_t)crc;
+}
+
+#endif /* PAYLOAD_ADVANCED_SPEED_H_ */
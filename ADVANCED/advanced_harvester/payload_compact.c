@@ -0,0 +1,166 @@
+/*
+ * payload_compact.c
+ *
+ * Encoder for the bit-packed uplink, format see payload_compact.h
+ */
+
+#include <string.h>
+#include <stdbool.h>
+#include <payload_compact.h>
+#include <payload_advanced_uplink.h>		// payloadCrc16()
+
+#define COMPACT_HEADER_LEN			4
+#define COMPACT_MAX_BITS			((COMPACT_MAX_LEN - COMPACT_HEADER_LEN - 2) * 8)
+
+
+// Append the n lowest bits of value, MSB first. Buffer must be zeroed
+static void putBits(uint8_t *buf, uint16_t *pos, uint32_t value, uint8_t n) {
+  while(n > 0) {
+    n--;
+    if(*pos < COMPACT_MAX_BITS && (value & ((uint32_t)1 << n))) {
+      buf[*pos >> 3] |= 0x80 >> (*pos & 7);
+    }
+    (*pos)++;
+  }
+}
+
+// Zero all bits from pos on (drop an entry that did not fit)
+static void clearBits(uint8_t *buf, uint16_t pos) {
+  if(pos & 7) {
+    buf[pos >> 3] &= 0xFF << (8 - (pos & 7));
+    pos = (pos + 7) & ~7;
+  }
+  memset(&buf[pos >> 3], 0, (COMPACT_MAX_BITS - pos) >> 3);
+}
+
+// Varint in groups of 7 data bits + continue bit
+static void putVarint8(uint8_t *buf, uint16_t *pos, uint32_t v) {
+  while(v >= 0x80) {
+    putBits(buf, pos, 0x80 | (v & 0x7F), 8);
+    v >>= 7;
+  }
+  putBits(buf, pos, v, 8);
+}
+
+// Varint in groups of 3 data bits + continue bit, for small deltas
+static void putVarint4(uint8_t *buf, uint16_t *pos, uint32_t v) {
+  while(v >= 0x8) {
+    putBits(buf, pos, 0x8 | (v & 0x7), 4);
+    v >>= 3;
+  }
+  putBits(buf, pos, v, 4);
+}
+
+static uint32_t zigzag(int32_t v) {
+  return ((uint32_t)v << 1) ^ (uint32_t)(v >> 31);
+}
+
+static uint32_t pressureOffset(uint32_t pressure) {
+  uint32_t v = (pressure > COMPACT_PRESSURE_BASE) ? pressure - COMPACT_PRESSURE_BASE : 0;
+  return (v > 0x1FFFF) ? 0x1FFFF : v;
+}
+
+// Pressure as sent: offset to the base in Pa, or the raw ADC word as is
+static uint32_t pressureField(uint8_t flags, uint32_t pressure) {
+  return (flags & COMPACT_RAW) ? (pressure & 0xFFFFF) : pressureOffset(pressure);
+}
+
+
+uint8_t payloadCompactEncode(uint8_t *buf, compactReading_t *r, const compactReading_t *history, uint8_t nHistory) {
+  uint8_t *bits = &buf[COMPACT_HEADER_LEN];
+  uint16_t pos = 0;
+  uint16_t flagsPos, countPos, entryPos;
+  uint16_t newerSeq = r->seq;
+  uint8_t count = 0;
+  int16_t t;
+  uint8_t len, i;
+  uint16_t crc;
+  uint8_t pressureBits = (r->flags & COMPACT_RAW) ? 20 : 17;
+
+  memset(bits, 0, COMPACT_MAX_BITS / 8);
+
+  flagsPos = pos;
+  pos += 5;										// presence, written below
+  countPos = pos;
+  pos += 2;										// history count, written below
+  putBits(bits, &pos, r->seq, 16);
+  putVarint8(bits, &pos, r->timediff);			// 2 groups in the normal speed range
+
+  if(r->flags & COMPACT_HAS_PRESSURE) {
+    putBits(bits, &pos, pressureField(r->flags, r->pressure), pressureBits);
+  }
+  if((r->flags & COMPACT_HAS_TEMPERATURE) && (r->flags & COMPACT_RAW)) {
+    putBits(bits, &pos, r->rawTemperature & 0xFFFFF, 20);
+  }
+  else if(r->flags & COMPACT_HAS_TEMPERATURE) {
+    t = r->temperature / 10;
+    if(t > 2047) t = 2047;
+    if(t < -2048) t = -2048;
+    putBits(bits, &pos, (uint16_t)t & 0xFFF, 12);
+  }
+  if(r->flags & COMPACT_HAS_HUMIDITY) {
+    putBits(bits, &pos, (r->humidity > 1023) ? 1023 : r->humidity, 10);
+  }
+
+  // ride aggregates before the history: they stay correct over any number of losses
+  if(r->flags & COMPACT_HAS_RIDE) {
+    entryPos = pos;
+    putVarint8(bits, &pos, r->ride.revs);
+    putVarint8(bits, &pos, r->ride.ticks);
+    putVarint8(bits, &pos, r->ride.minPeriod);
+    putVarint8(bits, &pos, r->ride.maxPeriod - r->ride.minPeriod);
+    putVarint8(bits, &pos, r->rideTotals.distance);
+    putVarint8(bits, &pos, r->rideTotals.movingTime);
+
+    if(pos > COMPACT_MAX_BITS) {
+      clearBits(bits, entryPos);
+      pos = entryPos;
+      r->flags &= ~COMPACT_HAS_RIDE;
+    }
+  }
+  putBits(bits, &flagsPos, r->flags, 5);
+
+  // key fields of the previous packets, so the gateway can fill single losses
+  if(nHistory > COMPACT_MAX_HISTORY) {
+    nHistory = COMPACT_MAX_HISTORY;
+  }
+  for(i = 0; i < nHistory; i++) {
+    const compactReading_t *h = &history[i];
+    // the frame's COMPACT_RAW tells the kind of every pressure in it: drop one of the other kind
+    bool hasPressure = (h->flags & COMPACT_HAS_PRESSURE) && !((h->flags ^ r->flags) & COMPACT_RAW);
+
+    entryPos = pos;
+    putVarint4(bits, &pos, (uint16_t)(newerSeq - h->seq));
+    putVarint4(bits, &pos, zigzag((int32_t)(h->timediff - r->timediff)));
+    putBits(bits, &pos, hasPressure, 1);
+    if(hasPressure) {
+      if(r->flags & COMPACT_HAS_PRESSURE) {
+        putVarint4(bits, &pos, zigzag((int32_t)(pressureField(r->flags, h->pressure) - pressureField(r->flags, r->pressure))));
+      } else {
+        putBits(bits, &pos, pressureField(r->flags, h->pressure), pressureBits);
+      }
+    }
+
+    if(pos > COMPACT_MAX_BITS) {
+      clearBits(bits, entryPos);
+      pos = entryPos;
+      break;
+    }
+    newerSeq = h->seq;
+    count++;
+  }
+  putBits(bits, &countPos, count, 2);
+
+  len = COMPACT_HEADER_LEN + ((pos + 7) >> 3) + 2;
+
+  buf[0] = len - 1;
+  buf[1] = 0xFF;
+  buf[2] = 0xDE;
+  buf[3] = 0xBA;
+
+  crc = payloadCrc16(buf, len - 2);
+  buf[len - 2] = (uint8_t)(crc >> 8);
+  buf[len - 1] = (uint8_t)crc;
+
+  return len;
+}
@@ -0,0 +1,83 @@
+/*
+ * payload_compact.h
+ *
+ * Bit-packed, variable length uplink (PAYLOAD_COMPACT in config.h)
+ * -----------------------------------------------------------------
+ * AdvData:
+ *   [0]    AD length (= total length - 1)
+ *   [1]    0xFF (manufacturer specific, full format uses 0x03)
+ *   [2..3] 0xDE 0xBA
+ *   [4..]  bit stream, MSB first:
+ *            5 bit   presence: raw, ride, pressure, temperature, humidity
+ *            2 bit   number of history entries (0..2, see below)
+ *           16 bit   sequence number
+ *            v8      wheel period [1/65536 s]
+ *           17 bit   pressure - COMPACT_PRESSURE_BASE [Pa]     (if present)
+ *           12 bit   temperature, signed [0.1 degC]            (if present)
+ *                    raw: both are the 20 bit BMP280 ADC words instead (SENSOR_RAW),
+ *                    compensated by the gateway with the calibration frame
+ *                    (gateway/schema/advanced_calib.schema)
+ *           10 bit   humidity [0.1 %RH]                        (if present)
+ *          ride aggregates, see ride.h                          (if present):
+ *            v8      revolutions since the last ride section
+ *            v8      moving time since the last ride section [1/65536 s]
+ *            v8      shortest wheel period [1/65536 s] (0 = no moving revolution)
+ *            v8      longest minus shortest wheel period
+ *            v8      total distance [m]
+ *            v8      total moving time [s]
+ *          history entries, previous packet first (PAYLOAD_REDUNDANCY):
+ *            v4      sequence number delta to the newer packet
+ *            v4      wheel period, zigzag delta to this packet's wheel period
+ *            1 bit   pressure present, then
+ *            v4      zigzag delta to this packet's pressure    (if this packet has one)
+ *            17 bit  pressure - COMPACT_PRESSURE_BASE          (otherwise; raw: 20 bit word)
+ *          (raw applies to the history pressures as well, SENSOR_RAW builds set it on every
+ *           frame; an entry whose pressure is of the other kind is sent without it)
+ *          (v8 = varint: groups of 7 data bits + 1 continue bit, v4 = groups of 3 data
+ *           bits + 1 continue bit, both least significant group first. A ride section or
+ *           history entries that do not fit into COMPACT_MAX_LEN are left out)
+ *          zero padding to the next byte
+ *   [n-2..n-1] CRC-16/CCITT-FALSE over all bytes before it
+ *
+ * 11 bytes without sensors, 15 with pressure and temperature (full format: 24),
+ * a history entry adds about 2 bytes, the ride section 10 - 16 bytes.
+ * Gateway decoder: gateway/payload_compact.hpp
+ */
+
+#ifndef PAYLOAD_COMPACT_H_
+#define PAYLOAD_COMPACT_H_
+
+#include <stdint.h>
+#include <config.h>
+#include <ride.h>
+#include <auth.h>
+
+#define COMPACT_RAW					0x10		// pressure/temperature are raw ADC words
+#define COMPACT_HAS_RIDE			0x8
+#define COMPACT_HAS_PRESSURE		0x4
+#define COMPACT_HAS_TEMPERATURE		0x2
+#define COMPACT_HAS_HUMIDITY		0x1
+
+#define COMPACT_PRESSURE_BASE		30000		// 17 bit offset covers 300 - 1310 hPa
+#define COMPACT_MAX_LEN				(ADVLEN - (AUTH_PAYLOAD ? AUTH_TRAILER_LEN : 0))	// room for the auth trailer
+#define COMPACT_MAX_HISTORY			2
+
+typedef struct {
+  uint8_t flags;								// COMPACT_HAS_*
+  uint16_t seq;
+  uint32_t timediff;							// wheel period [1/65536 s]
+  uint32_t pressure;							// [Pa], raw word with COMPACT_RAW
+  int16_t temperature;							// [0.01 degC], as from value_bmp_280()
+  uint32_t rawTemperature;						// raw word (COMPACT_RAW)
+  uint16_t humidity;							// [0.1 %RH]
+  rideWindow_t ride;							// (COMPACT_HAS_RIDE)
+  rideTotals_t rideTotals;
+} compactReading_t;
+
+
+// Encode into buf (at least COMPACT_MAX_LEN bytes), returns the AdvData length.
+// COMPACT_HAS_RIDE is cleared in r if the ride section did not fit.
+// history: nHistory previously sent readings, most recent first (NULL if none)
+uint8_t payloadCompactEncode(uint8_t *buf, compactReading_t *r, const compactReading_t *history, uint8_t nHistory);
+
+#endif /* PAYLOAD_COMPACT_H_ */
@@ -2,17 +2,27 @@
 #include <inc/hw_memmap.h>
 #include <inc/hw_rfc_dbell.h>
 #include <inc/hw_rfc_pwr.h>
+#include <inc/hw_rfc_rat.h>
 #include <inc/hw_fcfg1.h>
 #include <radio_files/rfc_api/common_cmd.h>
 #include <radio_files/rfc_api/ble_cmd.h>
+#include <radio_files/rfc_api/prop_cmd.h>
 #include <radio_files/rfc_api/mailbox.h>
 #include <radio_files/patches/ble/apply_patch.h>
 #include <radio_files/overrides/ble_overrides.h>
 
 
 #include <config.h>
+#if LINK_MODE == LINK_MODE_PROP
+#include <radio_files/overrides/prop_overrides.h>
+#if !PROP_OVERRIDES_SMARTRF
+#error "LINK_MODE_PROP: PHY settings not verified, export them from SmartRF Studio first (prop_overrides.h)"
+#endif
+#endif
 #include <driverLib/prcm.h>
 #include <radio.h>
+#include <radio_chain.h>
+#include <downlink.h>
 #include <system.h>
 
 volatile bool rfBootDone          = 0;
@@ -39,46 +49,22 @@ rfCoreHal_bleAdvPar_t cmdAdvParam = {
 #pragma data_alignment=4
 rfCoreHal_bleAdvOutput_t advOutput = {0};
 
+// Downlink scan window after the advertisments (see downlink.h)
 #pragma data_alignment=4
-rfCoreHal_CMD_BLE_ADV_NC_t cmdAdv2 =  {
-  .commandNo                  = CMD_BLE_ADV_NC,
-  .pNextOp                    = NULL,
-  .condition.rule             = COND_ALWAYS,
-  .startTrigger.triggerType   = TRIG_NOW,
-  .channel                    = 39,
-  .pParams                    = (uint8_t*)&cmdAdvParam,
-  .pOutput                    = (uint8_t*)&advOutput,
-};
-
-#pragma data_alignment=4
-rfCoreHal_CMD_BLE_ADV_NC_t cmdAdv1 =  {
-  .commandNo                  = CMD_BLE_ADV_NC,
-  .pNextOp                    = NULL,
-  .condition.rule             = COND_ALWAYS,
-  .startTrigger.triggerType   = TRIG_NOW,
-  .channel                    = 38,
-  .pParams                    = (uint8_t*)&cmdAdvParam,
-  .pOutput                    = (uint8_t*)&advOutput,
-};
-
-
-#pragma data_alignment=4
-rfCoreHal_CMD_BLE_ADV_NC_t cmdAdv0 =  {
-  .commandNo                  = CMD_BLE_ADV_NC,
-  .pNextOp                    = NULL,
-  .condition.rule             = COND_ALWAYS,
-  .startTrigger.triggerType   = TRIG_NOW,
-  .channel                    = 37,
-  .pParams                    = (uint8_t*)&cmdAdvParam,
-  .pOutput                    = (uint8_t*)&advOutput,
+rfCoreHal_bleScannerPar_t cmdScanParam = {
+  .pRxQ                       = &downlinkQueue,
+  .rxConfig.bAutoFlushIgnored = 1,
+  .rxConfig.bAutoFlushCrcErr  = 1,
+  .rxConfig.bIncludeLenByte   = 1,
+  .scanConfig.bActiveScan     = 0,              // passive, no scan requests
+  .pDeviceAddress             = (uint16_t*)&devAddress,
+  .timeoutTrigger.triggerType = TRIG_NEVER,
+  .endTrigger.triggerType     = TRIG_REL_START,
+  .endTime                    = DOWNLINK_SCAN_WINDOW_US * 4,  // RAT runs at 4 MHz
 };
 
 #pragma data_alignment=4
-rfCoreHal_CMD_FS_POWERDOWN_t cmdFsPd = {
-  .commandNo                = CMD_FS_POWERDOWN,
-  .startTrigger.triggerType = TRIG_NOW,
-  .condition.rule           = COND_NEVER,
-};
+rfCoreHal_bleScannerOutput_t scanOutput = {0};
 
 //#pragma data_alignment=4
 //rfCoreHal_CMD_RADIO_SETUP_t cmdSetup = {
@@ -96,12 +82,9 @@ rfCoreHal_CMD_FS_POWERDOWN_t cmdFsPd = {
 //
 //};
 
-#pragma data_alignment=4
+// Setup template, copied into every command chain. TX power can be changed by downlink
 rfCoreHal_CMD_RADIO_SETUP_t cmdSetup = {
   .commandNo                = CMD_RADIO_SETUP,
-  .pNextOp                  = (uint8_t*)&cmdAdv0,
-  .startTrigger.triggerType = TRIG_NOW,
-  .condition.rule           = COND_ALWAYS,
   .pRegOverride             = bleDifferentialOverrides,
   .config.frontEndMode      = 0x0, // Differential
   .config.biasMode          = 0x0, // Internal bias
@@ -111,19 +94,246 @@ rfCoreHal_CMD_RADIO_SETUP_t cmdSetup = {
   .mode                     = 0, //BLE mode
 };
 
+#if LINK_MODE == LINK_MODE_PROP
+// Proprietary 2.4 GHz PHY: 1 Mbps GFSK, 250 kHz deviation, 32 bit sync word, no whitening
+rfCoreHal_CMD_PROP_RADIO_SETUP_t cmdPropSetup = {
+  .commandNo                = CMD_PROP_RADIO_SETUP,
+  .modulation.modType       = 0x1, // GFSK
+  .modulation.deviation     = 1000, // 250 kHz in 250 Hz steps
+  .symbolRate.preScale      = 15,
+  .symbolRate.rateWord      = 0xA0000, // 24 MHz * rateWord / (preScale * 2^20) = 1 Mbps
+  .preamConf.nPreamBytes    = PROP_PREAMBLE_BYTES,
+  .preamConf.preamMode      = 0, // 0x55...
+  .formatConf.nSwBits       = 32,
+  .formatConf.bMsbFirst     = 1,
+  .formatConf.whitenMode    = 0,
+  .config.frontEndMode      = 0x0, // Differential
+  .config.biasMode          = 0x0, // Internal bias
+  .txPower.GC               = 0x1, // 0dbm
+  .txPower.IB               = 0x21, // 0dbm
+  .txPower.tempCoeff        = 0x31,
+  .pRegOverride             = propDifferentialOverrides,
+};
+
+const rfCoreHal_CMD_FS_t cmdFs = {
+  .commandNo                = CMD_FS,
+  .frequency                = PROP_FREQUENCY_MHZ,
+  .fractFreq                = 0,
+  .synthConf.bTxMode        = 1,
+};
+#endif
+
+// Command chains, one per profile (see radio.h)
+static radioChain_t radioProfiles[RADIO_PROFILE_COUNT];
+static radioChain_t *pActiveChain = &radioProfiles[RADIO_PROFILE_FULL_3CH];
+
+// Arena bytes of all profiles built below, per command rounded to words as
+// radioChainAlloc() takes them. Keep in step with radioBuildProfiles()
+#define RADIO_CMD_BYTES(type)		((sizeof(type) + 3) & ~3)
+#if LINK_MODE == LINK_MODE_PROP
+#define RADIO_PROFILES_BYTES		(2 * RADIO_CMD_BYTES(rfCoreHal_CMD_PROP_RADIO_SETUP_t)		/* prop-1ch, prop-keep-setup */ \
+									 + 2 * RADIO_CMD_BYTES(rfCoreHal_CMD_FS_t) \
+									 + 3 * RADIO_CMD_BYTES(rfCoreHal_CMD_PROP_TX_t)			/* + prop-keep-tx */ \
+									 + 1 * RADIO_CMD_BYTES(rfCoreHal_CMD_FS_POWERDOWN_t))
+#else
+#define RADIO_PROFILES_BYTES		(6 * RADIO_CMD_BYTES(rfCoreHal_CMD_RADIO_SETUP_t)			/* all but keep-adv(-scan) */ \
+									 + (18 + 3 * BURST_DRAIN_ROUNDS) * RADIO_CMD_BYTES(rfCoreHal_CMD_BLE_ADV_NC_t) \
+									 + 2 * RADIO_CMD_BYTES(rfCoreHal_CMD_BLE_SCANNER_t)		/* *-scan */ \
+									 + 5 * RADIO_CMD_BYTES(rfCoreHal_CMD_FS_POWERDOWN_t))	/* all but keep-* */
+#endif
+// Compile error here: the profiles do not fit, raise RADIO_CHAIN_ARENA_SIZE (radio_chain.h)
+typedef char radioProfilesFitArena[(RADIO_PROFILES_BYTES <= RADIO_CHAIN_ARENA_SIZE) ? 1 : -1];
+
+
+#if LINK_MODE == LINK_MODE_PROP
+// Proprietary link: one frequency, one packet. Profiles that differ only in BLE
+// channels or scan windows all send the same chain
+static bool radioBuildProfiles(void) {
+  radioChain_t *chain;
+  bool ok = true;
+
+  radioChainArenaReset();
+
+  // prop-1ch: setup, FS, one packet, FS off
+  chain = &radioProfiles[RADIO_PROFILE_COMPACT_1CH];
+  radioChainBegin(chain, "prop-1ch");
+  radioChainAddPropSetup(chain, &cmdPropSetup);
+  radioChainAddFs(chain, &cmdFs);
+  radioChainAddPropTx(chain, PROP_SYNC_WORD, (uint8_t*)&advData[PROP_PKT_OFFSET], PROP_PKT_LEN);
+  radioChainAddFsPowerdown(chain);
+  ok &= radioChainEnd(chain);
+  radioProfiles[RADIO_PROFILE_FULL_3CH]      = *chain;
+  radioProfiles[RADIO_PROFILE_BURST_DRAIN]   = *chain;
+  radioProfiles[RADIO_PROFILE_FULL_3CH_SCAN] = *chain;
+  radioProfiles[RADIO_PROFILE_DUAL_2CH]      = *chain;
+
+  // prop-keep-setup: setup, FS, one packet. Synth stays on
+  chain = &radioProfiles[RADIO_PROFILE_KEEP_SETUP];
+  radioChainBegin(chain, "prop-keep-setup");
+  radioChainAddPropSetup(chain, &cmdPropSetup);
+  radioChainAddFs(chain, &cmdFs);
+  radioChainAddPropTx(chain, PROP_SYNC_WORD, (uint8_t*)&advData[PROP_PKT_OFFSET], PROP_PKT_LEN);
+  ok &= radioChainEnd(chain);
+
+  // prop-keep-tx: one packet on the running synth
+  chain = &radioProfiles[RADIO_PROFILE_KEEP_ADV];
+  radioChainBegin(chain, "prop-keep-tx");
+  radioChainAddPropTx(chain, PROP_SYNC_WORD, (uint8_t*)&advData[PROP_PKT_OFFSET], PROP_PKT_LEN);
+  ok &= radioChainEnd(chain);
+  radioProfiles[RADIO_PROFILE_KEEP_ADV_SCAN] = *chain;
+  return ok;
+}
+#else
+// Build all profiles into the chain arena, false if one did not fit (emptied then)
+static bool radioBuildProfiles(void) {
+  radioChain_t *chain;
+  bool ok = true;
+  uint8_t n;
+
+  radioChainArenaReset();
+
+  // compact-1ch: setup, adv 37, FS off
+  chain = &radioProfiles[RADIO_PROFILE_COMPACT_1CH];
+  radioChainBegin(chain, "compact-1ch");
+  radioChainAddSetup(chain, &cmdSetup);
+  radioChainAddAdv(chain, 37, &cmdAdvParam, &advOutput);
+  radioChainAddFsPowerdown(chain);
+  ok &= radioChainEnd(chain);
+
+  // full-3ch: setup, adv 37/38/39, FS off
+  chain = &radioProfiles[RADIO_PROFILE_FULL_3CH];
+  radioChainBegin(chain, "full-3ch");
+  radioChainAddSetup(chain, &cmdSetup);
+  radioChainAddAdv(chain, 37, &cmdAdvParam, &advOutput);
+  radioChainAddAdv(chain, 38, &cmdAdvParam, &advOutput);
+  radioChainAddAdv(chain, 39, &cmdAdvParam, &advOutput);
+  radioChainAddFsPowerdown(chain);
+  ok &= radioChainEnd(chain);
+
+  // burst-drain: setup, BURST_DRAIN_ROUNDS x adv 37/38/39, FS off
+  chain = &radioProfiles[RADIO_PROFILE_BURST_DRAIN];
+  radioChainBegin(chain, "burst-drain");
+  radioChainAddSetup(chain, &cmdSetup);
+  for(n = 0; n < BURST_DRAIN_ROUNDS; n++) {
+    radioChainAddAdv(chain, 37, &cmdAdvParam, &advOutput);
+    radioChainAddAdv(chain, 38, &cmdAdvParam, &advOutput);
+    radioChainAddAdv(chain, 39, &cmdAdvParam, &advOutput);
+  }
+  radioChainAddFsPowerdown(chain);
+  ok &= radioChainEnd(chain);
+
+  // keep-setup: setup, adv 37/38/39. No FS powerdown, synth stays configured
+  chain = &radioProfiles[RADIO_PROFILE_KEEP_SETUP];
+  radioChainBegin(chain, "keep-setup");
+  radioChainAddSetup(chain, &cmdSetup);
+  radioChainAddAdv(chain, 37, &cmdAdvParam, &advOutput);
+  radioChainAddAdv(chain, 38, &cmdAdvParam, &advOutput);
+  radioChainAddAdv(chain, 39, &cmdAdvParam, &advOutput);
+  ok &= radioChainEnd(chain);
+
+  // keep-adv: adv 37/38/39 on the already running synth
+  chain = &radioProfiles[RADIO_PROFILE_KEEP_ADV];
+  radioChainBegin(chain, "keep-adv");
+  radioChainAddAdv(chain, 37, &cmdAdvParam, &advOutput);
+  radioChainAddAdv(chain, 38, &cmdAdvParam, &advOutput);
+  radioChainAddAdv(chain, 39, &cmdAdvParam, &advOutput);
+  ok &= radioChainEnd(chain);
+
+  // full-3ch-scan: setup, adv 37/38/39, scan window on 37, FS off
+  chain = &radioProfiles[RADIO_PROFILE_FULL_3CH_SCAN];
+  radioChainBegin(chain, "full-3ch-scan");
+  radioChainAddSetup(chain, &cmdSetup);
+  radioChainAddAdv(chain, 37, &cmdAdvParam, &advOutput);
+  radioChainAddAdv(chain, 38, &cmdAdvParam, &advOutput);
+  radioChainAddAdv(chain, 39, &cmdAdvParam, &advOutput);
+  radioChainAddScanner(chain, 37, &cmdScanParam, &scanOutput);
+  radioChainAddFsPowerdown(chain);
+  ok &= radioChainEnd(chain);
+
+  // keep-adv-scan: adv 37/38/39, scan window on 37, synth stays on
+  chain = &radioProfiles[RADIO_PROFILE_KEEP_ADV_SCAN];
+  radioChainBegin(chain, "keep-adv-scan");
+  radioChainAddAdv(chain, 37, &cmdAdvParam, &advOutput);
+  radioChainAddAdv(chain, 38, &cmdAdvParam, &advOutput);
+  radioChainAddAdv(chain, 39, &cmdAdvParam, &advOutput);
+  radioChainAddScanner(chain, 37, &cmdScanParam, &scanOutput);
+  ok &= radioChainEnd(chain);
+
+  // dual-2ch: setup, adv 37/38, FS off
+  chain = &radioProfiles[RADIO_PROFILE_DUAL_2CH];
+  radioChainBegin(chain, "dual-2ch");
+  radioChainAddSetup(chain, &cmdSetup);
+  radioChainAddAdv(chain, 37, &cmdAdvParam, &advOutput);
+  radioChainAddAdv(chain, 38, &cmdAdvParam, &advOutput);
+  radioChainAddFsPowerdown(chain);
+  ok &= radioChainEnd(chain);
+  return ok;
+}
+#endif
+
+// (Re)build the profiles. A profile that does not fit the arena is a build error
+// (RADIO_CHAIN_ARENA_SIZE), stop here instead of sending an empty chain
+static void radioBuild(void) {
+  if(!radioBuildProfiles()) {
+    while(1);
+  }
+}
+
+void radioSelectProfile(uint8_t profile) {
+  if(profile < RADIO_PROFILE_COUNT) {
+    pActiveChain = &radioProfiles[profile];
+  }
+}
+
+const char* radioProfileName(void) {
+  return pActiveChain->name;
+}
+
+uint8_t radioActiveProfile(void) {
+  return (uint8_t)(pActiveChain - radioProfiles);
+}
+
+// Active chain starts with a radio setup (reads FCFG trims from flash)
+bool radioActiveHasSetup(void) {
+  const rfCoreHal_radioOp_t *op = (const rfCoreHal_radioOp_t*)pActiveChain->pFirstOp;
+
+  return op != NULL && (op->commandNo == CMD_RADIO_SETUP || op->commandNo == CMD_PROP_RADIO_SETUP);
+}
+
+// Change TX power in the setup template and rebuild all chains.
+// Only call while no chain is running on the RF core
+void radioSetTxPower(uint8_t ib, uint8_t gc) {
+#if LINK_MODE == LINK_MODE_PROP
+  cmdPropSetup.txPower.IB = ib;
+  cmdPropSetup.txPower.GC = gc;
+#else
+  cmdSetup.txPower.IB = ib;
+  cmdSetup.txPower.GC = gc;
+#endif
+  radioBuild();
+}
+
+// MAC as sent in AdvA (FCFG1_O_MAC_BLE_0, LSB first)
+const uint8_t* radioDeviceAddress(void) {
+  return (const uint8_t*)&devAddress;
+}
 
 
 void initRadio(void) {
+#if LINK_MODE == LINK_MODE_PROP
+  // CC2650 has no proprietary-only RF core mode: proprietary 2.4 GHz runs in the
+  // multi-protocol mode (TI RF driver: RF_MODE_MULTIPLE)
+  HWREG(PRCM_BASE + PRCM_O_RFCMODESEL) = PRCM_RFCMODESEL_CURR_MODE5;
+#else
   // Set radio to BLE mode
-  HWREG(PRCM_BASE + PRCM_O_RFCMODESEL) = 0x1;
+  HWREG(PRCM_BASE + PRCM_O_RFCMODESEL) = PRCM_RFCMODESEL_CURR_MODE1;
+#endif
 
    //Set up MAC address. Currently using TI Provided adress
    devAddress = *((uint64_t*)(FCFG1_BASE+FCFG1_O_MAC_BLE_0));
 
-  //Chain advertisment commands.
-  cmdAdv0.pNextOp = (uint8_t *)&cmdAdv1;
-  cmdAdv1.pNextOp = (uint8_t *)&cmdAdv2;
-  cmdAdv2.pNextOp = (uint8_t *)&cmdFsPd;
+  //Build advertisment command chains
+  radioBuild();
 }
 
 void runRadio(void) {
@@ -143,7 +353,9 @@ static inline void radioWaitCommandOk(void) {
 
 //CM0 patching
 void radioPatch(void) {
-  applyPatch();
+#if LINK_MODE == LINK_MODE_BLE
+  applyPatch();							// BLE CPE patch, proprietary TX runs from ROM
+#endif
 }
 
 void radioCmdBusRequest(bool enabled) {
@@ -161,11 +373,21 @@ void radioCmdStartRAT(void) {
 }
 
 
+// Current radio timer value (4 MHz). RAT must be running (radioCmdStartRAT)
+uint32_t radioRatNow(void) {
+  return HWREG(RFC_RAT_BASE + RFC_RAT_O_RATCNT);
+}
+
+// Let the active chain transmit at RAT time txTime instead of immediately
+void radioScheduleTransmit(uint32_t txTime) {
+  radioChainSchedule(pActiveChain, txTime, RAT_SLOT_SETUP_LEAD_US * 4);
+}
+
 void radioSetupAndTransmit() {
-  radioSendCommand( (uint32_t)&cmdSetup);
+  radioSendCommand( (uint32_t)pActiveChain->pFirstOp);
 }
 
-//Update advertising byte based on IO inputs
+//Update advertising byte based on IO inputs. size may change from packet to packet (compact payload)
 void radioUpdateAdvData(int size, char* data) {
 
   int i;
@@ -173,6 +395,14 @@ void radioUpdateAdvData(int size, char* data) {
   {
 	  advData[i] = data[i];
   }
+  cmdAdvParam.advLen = size;
+
+#if LINK_MODE == LINK_MODE_PROP
+  // prop packet: AdvData without AD length/type and trailing checksum
+  for(i = 0; i < RADIO_PROFILE_COUNT; i++) {
+    radioChainSetPropLen(&radioProfiles[i], size - PROP_PKT_OFFSET - 2);
+  }
+#endif
 }
 
 
@@ -1,5 +1,16 @@
 #define BLE_ADV_PAYLOAD_BUF_LEN     64
 
+// Radio profiles: command chains built once in initRadio()
+#define RADIO_PROFILE_COMPACT_1CH	0			// setup, adv 37, FS off
+#define RADIO_PROFILE_FULL_3CH		1			// setup, adv 37/38/39, FS off
+#define RADIO_PROFILE_BURST_DRAIN	2			// setup, BURST_DRAIN_ROUNDS x adv 37/38/39, FS off
+#define RADIO_PROFILE_KEEP_SETUP	3			// setup, adv 37/38/39, FS stays on (keep-alive start)
+#define RADIO_PROFILE_KEEP_ADV		4			// adv 37/38/39 only (keep-alive, synth already set up)
+#define RADIO_PROFILE_FULL_3CH_SCAN	5			// setup, adv 37/38/39, downlink scan on 37, FS off
+#define RADIO_PROFILE_KEEP_ADV_SCAN	6			// adv 37/38/39, downlink scan on 37 (keep-alive)
+#define RADIO_PROFILE_DUAL_2CH		7			// setup, adv 37/38, FS off (cross-packet redundancy)
+#define RADIO_PROFILE_COUNT			8
+
 void initRadio(void);
 void runRadio(void);
 void initRadioInts(void);
@@ -12,3 +23,13 @@ void radioUpdateAdvData(int size, char* data);
 
 void radioCmdStartRAT(void);
 void radioSetupAndTransmit(void);
+uint32_t radioRatNow(void);
+void radioScheduleTransmit(uint32_t txTime);
+
+void radioSelectProfile(uint8_t profile);
+const char* radioProfileName(void);
+uint8_t radioActiveProfile(void);
+bool radioActiveHasSetup(void);
+
+void radioSetTxPower(uint8_t ib, uint8_t gc);
+const uint8_t* radioDeviceAddress(void);
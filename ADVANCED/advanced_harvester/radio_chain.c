@@ -0,0 +1,210 @@
+/*
+ * radio_chain.c
+ *
+ * Static arena and builder for RF core command chains.
+ * All chains are appended back to back into one arena, there is no free:
+ * build every profile once at init (radioChainArenaReset() starts over).
+ */
+
+#include <string.h>
+#include <radio_files/rfc_api/mailbox.h>
+#include <radio_chain.h>
+
+// Command arena. uint32_t array keeps every command 4-byte aligned for the RF core
+#pragma data_alignment=4
+static uint32_t chainArena[RADIO_CHAIN_ARENA_SIZE / 4];
+static uint16_t chainArenaUsed = 0;
+
+
+// Take len bytes (rounded up to whole words) from the arena for the next command of
+// chain. NULL if full, the chain is marked and radioChainEnd() drops it
+static void* radioChainAlloc(radioChain_t *chain, uint16_t len) {
+  uint16_t words = (len + 3) / 4;
+  void *p;
+
+  if(chain->overflow || chainArenaUsed + words * 4 > RADIO_CHAIN_ARENA_SIZE) {
+    chain->overflow = true;
+    return NULL;
+  }
+  p = &chainArena[chainArenaUsed / 4];
+  chainArenaUsed += words * 4;
+
+  memset(p, 0, words * 4);
+  return p;
+}
+
+// Append a command: the previous one continues to it, the new one ends the chain
+static void radioChainLink(radioChain_t *chain, rfCoreHal_radioOp_t *op) {
+
+  op->pNextOp                  = NULL;
+  op->startTrigger.triggerType = TRIG_NOW;
+  op->condition.rule           = COND_NEVER;
+
+  if(chain->pLastOp == NULL) {
+    chain->pFirstOp = (uint8_t*)op;
+  } else {
+    ((rfCoreHal_radioOp_t*)chain->pLastOp)->pNextOp        = (uint8_t*)op;
+    ((rfCoreHal_radioOp_t*)chain->pLastOp)->condition.rule = COND_ALWAYS;
+  }
+  chain->pLastOp = (uint8_t*)op;
+  chain->nOps++;
+}
+
+
+void radioChainArenaReset(void) {
+  chainArenaUsed = 0;
+}
+
+uint16_t radioChainArenaUsed(void) {
+  return chainArenaUsed;
+}
+
+void radioChainBegin(radioChain_t *chain, const char *name) {
+  chain->name     = name;
+  chain->pFirstOp = NULL;
+  chain->pLastOp  = NULL;
+  chain->nOps     = 0;
+  chain->overflow = false;
+}
+
+// Close a chain. One that ran out of arena is emptied (no partial chain is ever
+// linked to the doorbell), returns false then
+bool radioChainEnd(radioChain_t *chain) {
+  if(chain->overflow) {
+    chain->pFirstOp = NULL;
+    chain->pLastOp  = NULL;
+    chain->nOps     = 0;
+    return false;
+  }
+  return true;
+}
+
+// Copy of the setup template (overrides, tx power), placed in the arena
+rfCoreHal_CMD_RADIO_SETUP_t* radioChainAddSetup(radioChain_t *chain, const rfCoreHal_CMD_RADIO_SETUP_t *tmpl) {
+  rfCoreHal_CMD_RADIO_SETUP_t *cmd = radioChainAlloc(chain, sizeof(rfCoreHal_CMD_RADIO_SETUP_t));
+
+  if(cmd != NULL) {
+    memcpy(cmd, tmpl, sizeof(rfCoreHal_CMD_RADIO_SETUP_t));
+    cmd->commandNo = CMD_RADIO_SETUP;
+    radioChainLink(chain, (rfCoreHal_radioOp_t*)cmd);
+  }
+  return cmd;
+}
+
+// Non-connectable advertisment on one channel (37, 38 or 39)
+rfCoreHal_CMD_BLE_ADV_NC_t* radioChainAddAdv(radioChain_t *chain, uint8_t channel, rfCoreHal_bleAdvPar_t *pParams, rfCoreHal_bleAdvOutput_t *pOutput) {
+  rfCoreHal_CMD_BLE_ADV_NC_t *cmd = radioChainAlloc(chain, sizeof(rfCoreHal_CMD_BLE_ADV_NC_t));
+
+  if(cmd != NULL) {
+    cmd->commandNo = CMD_BLE_ADV_NC;
+    cmd->channel   = channel;
+    cmd->pParams   = (uint8_t*)pParams;
+    cmd->pOutput   = (uint8_t*)pOutput;
+    radioChainLink(chain, (rfCoreHal_radioOp_t*)cmd);
+  }
+  return cmd;
+}
+
+// Scan window on one channel, window length is set by the end trigger in pParams
+rfCoreHal_CMD_BLE_SCANNER_t* radioChainAddScanner(radioChain_t *chain, uint8_t channel, rfCoreHal_bleScannerPar_t *pParams, rfCoreHal_bleScannerOutput_t *pOutput) {
+  rfCoreHal_CMD_BLE_SCANNER_t *cmd = radioChainAlloc(chain, sizeof(rfCoreHal_CMD_BLE_SCANNER_t));
+
+  if(cmd != NULL) {
+    cmd->commandNo = CMD_BLE_SCANNER;
+    cmd->channel   = channel;
+    cmd->pParams   = (uint8_t*)pParams;
+    cmd->pOutput   = (uint8_t*)pOutput;
+    radioChainLink(chain, (rfCoreHal_radioOp_t*)cmd);
+  }
+  return cmd;
+}
+
+rfCoreHal_CMD_FS_POWERDOWN_t* radioChainAddFsPowerdown(radioChain_t *chain) {
+  rfCoreHal_CMD_FS_POWERDOWN_t *cmd = radioChainAlloc(chain, sizeof(rfCoreHal_CMD_FS_POWERDOWN_t));
+
+  if(cmd != NULL) {
+    cmd->commandNo = CMD_FS_POWERDOWN;
+    radioChainLink(chain, (rfCoreHal_radioOp_t*)cmd);
+  }
+  return cmd;
+}
+
+// Proprietary mode setup (modulation, symbol rate, frame format), copied from template
+rfCoreHal_CMD_PROP_RADIO_SETUP_t* radioChainAddPropSetup(radioChain_t *chain, const rfCoreHal_CMD_PROP_RADIO_SETUP_t *tmpl) {
+  rfCoreHal_CMD_PROP_RADIO_SETUP_t *cmd = radioChainAlloc(chain, sizeof(rfCoreHal_CMD_PROP_RADIO_SETUP_t));
+
+  if(cmd != NULL) {
+    memcpy(cmd, tmpl, sizeof(rfCoreHal_CMD_PROP_RADIO_SETUP_t));
+    cmd->commandNo = CMD_PROP_RADIO_SETUP;
+    radioChainLink(chain, (rfCoreHal_radioOp_t*)cmd);
+  }
+  return cmd;
+}
+
+// Synth to a fixed frequency (proprietary mode has no BLE channel numbers)
+rfCoreHal_CMD_FS_t* radioChainAddFs(radioChain_t *chain, const rfCoreHal_CMD_FS_t *tmpl) {
+  rfCoreHal_CMD_FS_t *cmd = radioChainAlloc(chain, sizeof(rfCoreHal_CMD_FS_t));
+
+  if(cmd != NULL) {
+    memcpy(cmd, tmpl, sizeof(rfCoreHal_CMD_FS_t));
+    cmd->commandNo = CMD_FS;
+    radioChainLink(chain, (rfCoreHal_radioOp_t*)cmd);
+  }
+  return cmd;
+}
+
+// One proprietary packet: preamble, sync word, length byte, payload, CRC
+rfCoreHal_CMD_PROP_TX_t* radioChainAddPropTx(radioChain_t *chain, uint32_t syncWord, uint8_t *pPkt, uint8_t pktLen) {
+  rfCoreHal_CMD_PROP_TX_t *cmd = radioChainAlloc(chain, sizeof(rfCoreHal_CMD_PROP_TX_t));
+
+  if(cmd != NULL) {
+    cmd->commandNo       = CMD_PROP_TX;
+    cmd->pktConf.bFsOff  = 0;						// FS powerdown is a separate command
+    cmd->pktConf.bUseCrc = 1;
+    cmd->pktConf.bVarLen = 1;						// length byte in front of the payload
+    cmd->pktLen          = pktLen;
+    cmd->syncWord        = syncWord;
+    cmd->pPkt            = pPkt;
+    radioChainLink(chain, (rfCoreHal_radioOp_t*)cmd);
+  }
+  return cmd;
+}
+
+// Start the first transmit command of the chain at txTime (RAT, TRIG_ABSTIME).
+// A leading setup starts setupLead earlier, FS and further commands follow with TRIG_NOW.
+// pastTrig: if the time has already passed the command starts at once
+void radioChainSchedule(radioChain_t *chain, ratmr_t txTime, ratmr_t setupLead) {
+  rfCoreHal_radioOp_t *op = (rfCoreHal_radioOp_t*)chain->pFirstOp;
+  bool txScheduled = false;
+
+  while(op != NULL) {
+    op->startTrigger.triggerType = TRIG_NOW;
+    op->startTrigger.pastTrig    = 1;
+
+    if(op == (rfCoreHal_radioOp_t*)chain->pFirstOp
+       && (op->commandNo == CMD_RADIO_SETUP || op->commandNo == CMD_PROP_RADIO_SETUP)) {
+      op->startTrigger.triggerType = TRIG_ABSTIME;
+      op->startTime                = txTime - setupLead;
+    }
+    else if(!txScheduled && op->commandNo != CMD_FS && op->commandNo != CMD_FS_POWERDOWN
+            && op->commandNo != CMD_PROP_RADIO_SETUP && op->commandNo != CMD_RADIO_SETUP) {
+      op->startTrigger.triggerType = TRIG_ABSTIME;
+      op->startTime                = txTime;
+      txScheduled = true;
+    }
+
+    op = (rfCoreHal_radioOp_t*)op->pNextOp;
+  }
+}
+
+// Payload length of all CMD_PROP_TX in the chain (variable length payloads)
+void radioChainSetPropLen(radioChain_t *chain, uint8_t pktLen) {
+  rfCoreHal_radioOp_t *op = (rfCoreHal_radioOp_t*)chain->pFirstOp;
+
+  while(op != NULL) {
+    if(op->commandNo == CMD_PROP_TX) {
+      ((rfCoreHal_CMD_PROP_TX_t*)op)->pktLen = pktLen;
+    }
+    op = (rfCoreHal_radioOp_t*)op->pNextOp;
+  }
+}
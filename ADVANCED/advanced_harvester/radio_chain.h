@@ -0,0 +1,55 @@
+/*
+ * radio_chain.h
+ *
+ * Builder for RF core command chains
+ * ----------------------------------
+ * Command chains (setup, advertising on N channels, optional scan window,
+ * FS powerdown) are assembled into a static, 4-byte aligned arena. The
+ * builder links pNextOp and the condition rules, so no command is wired by hand.
+ * Chains are built once at init, switching between them is a pointer change.
+ * A command that does not fit marks the chain as overflowed, radioChainEnd()
+ * then empties it: a chain is either complete or never sent.
+ */
+
+#ifndef RADIO_CHAIN_H_
+#define RADIO_CHAIN_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <radio_files/rfc_api/common_cmd.h>
+#include <radio_files/rfc_api/ble_cmd.h>
+#include <radio_files/rfc_api/prop_cmd.h>
+
+// Size of the command arena in bytes (multiple of 4)
+#define RADIO_CHAIN_ARENA_SIZE		896
+
+typedef struct {
+  const char *name;						// profile name, for debugging
+  uint8_t *pFirstOp;					// first command, sent to the doorbell
+  uint8_t *pLastOp;						// last appended command
+  uint8_t nOps;							// number of commands in chain
+  bool overflow;						// a command did not fit into the arena
+} radioChain_t;
+
+
+// * Functions
+// ------------
+void radioChainArenaReset(void);
+uint16_t radioChainArenaUsed(void);
+
+void radioChainBegin(radioChain_t *chain, const char *name);
+bool radioChainEnd(radioChain_t *chain);		// false (chain emptied) if a command did not fit
+
+rfCoreHal_CMD_RADIO_SETUP_t* radioChainAddSetup(radioChain_t *chain, const rfCoreHal_CMD_RADIO_SETUP_t *tmpl);
+rfCoreHal_CMD_BLE_ADV_NC_t* radioChainAddAdv(radioChain_t *chain, uint8_t channel, rfCoreHal_bleAdvPar_t *pParams, rfCoreHal_bleAdvOutput_t *pOutput);
+rfCoreHal_CMD_BLE_SCANNER_t* radioChainAddScanner(radioChain_t *chain, uint8_t channel, rfCoreHal_bleScannerPar_t *pParams, rfCoreHal_bleScannerOutput_t *pOutput);
+rfCoreHal_CMD_FS_POWERDOWN_t* radioChainAddFsPowerdown(radioChain_t *chain);
+
+rfCoreHal_CMD_PROP_RADIO_SETUP_t* radioChainAddPropSetup(radioChain_t *chain, const rfCoreHal_CMD_PROP_RADIO_SETUP_t *tmpl);
+rfCoreHal_CMD_FS_t* radioChainAddFs(radioChain_t *chain, const rfCoreHal_CMD_FS_t *tmpl);
+rfCoreHal_CMD_PROP_TX_t* radioChainAddPropTx(radioChain_t *chain, uint32_t syncWord, uint8_t *pPkt, uint8_t pktLen);
+
+void radioChainSchedule(radioChain_t *chain, ratmr_t txTime, ratmr_t setupLead);
+void radioChainSetPropLen(radioChain_t *chain, uint8_t pktLen);
+
+#endif /* RADIO_CHAIN_H_ */
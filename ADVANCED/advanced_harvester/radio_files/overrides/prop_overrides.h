@@ -0,0 +1,36 @@
+//*****************************************************************************
+//! @file       prop_overrides.h
+//! @brief      Overrides for the 2.4 GHz proprietary short-packet link
+//!
+//! Synth block taken over from ble_overrides.h (same PLL, same band).
+//! BLE specific entries (enhanced BLE shape, AGC reference) are left out.
+//!
+//! Not verified on air: LINK_MODE_PROP does not build until this list and the
+//! cmdPropSetup fields in radio.c are replaced by a SmartRF Studio 7 export
+//! (CC2650, proprietary mode, custom settings as cmdPropSetup declares them:
+//! GFSK 1 Mbps, 250 kHz deviation, 4 preamble bytes, 32 bit sync word
+//! PROP_SYNC_WORD, variable length, CRC on, no whitening, 2480 MHz) and one packet
+//! has been received with the export and checked with gateway/prop_frame.c.
+//! The export must not carry a CRC override: propCrc16() there assumes the RF
+//! core's CRC-16 (poly 0x1021, init 0xFFFF) over length byte and payload. Set
+//! PROP_OVERRIDES_SMARTRF to 1 with the export.
+//****************************************************************************/
+
+#include <stdint.h>
+
+#define PROP_OVERRIDES_SMARTRF		0
+
+
+// Overrides for proprietary 2.4 GHz, differential mode, TX only
+uint32_t propDifferentialOverrides[] = {
+  0x00354038, // Synth: Set RTRIM (POTAILRESTRIM) to 5
+  0x4001402D, // Synth: Correct CKVD latency setting (address)
+  0x00608402, // Synth: Correct CKVD latency setting (value)
+  0x4001405D, // Synth: Set ANADIV DIV_BIAS_MODE to PG1 (address)
+  0x1801F800, // Synth: Set ANADIV DIV_BIAS_MODE to PG1 (value)
+  0x000784A3, // Synth: Set FREF = 3.43 MHz (24 MHz / 7)
+  0xA47E0583, // Synth: Set loop bandwidth after lock to 80 kHz (K2)
+  0xEAE00603, // Synth: Set loop bandwidth after lock to 80 kHz (K3, LSB)
+  0x00010623, // Synth: Set loop bandwidth after lock to 80 kHz (K3, MSB)
+  0xFFFFFFFF, // End of override list
+};
@@ -0,0 +1,75 @@
+/*
+ * ride.c
+ *
+ * Ride aggregates from the reed interrupt, see ride.h
+ */
+
+#include <string.h>
+#include <stdbool.h>
+#include <config.h>
+#include <ride.h>
+#include <downlink.h>
+#include <driverLib/interrupt.h>
+
+static rideWindow_t window;
+static rideTotals_t totals;
+static uint16_t distanceCarry = 0;					// [mm] below one m
+static uint32_t movingCarry = 0;					// [1/65536 s] below one s
+
+
+// called from GPIOIntHandler with INT_EDGE_DETECT disabled
+void rideAddRevolution(uint32_t period) {
+
+  if(window.revs < 0xFFFF) {
+    window.revs++;
+  }
+
+  distanceCarry += g_tuning.wheelCircumference % 1000;
+  totals.distance += g_tuning.wheelCircumference / 1000;
+  if(distanceCarry >= 1000) {
+    distanceCarry -= 1000;
+    totals.distance++;
+  }
+
+  if(period > RIDE_MOVING_MAX) {
+    return;											// standing still or first revolution
+  }
+
+  window.ticks += period;
+  if(window.minPeriod == 0 || period < window.minPeriod) {
+    window.minPeriod = period;
+  }
+  if(period > window.maxPeriod) {
+    window.maxPeriod = period;
+  }
+
+  movingCarry += period;
+  totals.movingTime += movingCarry >> 16;
+  movingCarry &= 0xFFFF;
+}
+
+void rideWindowTake(rideWindow_t *w) {
+  IntDisable(INT_EDGE_DETECT);
+  *w = window;
+  memset(&window, 0, sizeof(window));
+  IntEnable(INT_EDGE_DETECT);
+}
+
+void rideWindowReturn(const rideWindow_t *w) {
+  IntDisable(INT_EDGE_DETECT);
+  window.revs = ((uint32_t)window.revs + w->revs > 0xFFFF) ? 0xFFFF : window.revs + w->revs;
+  window.ticks += w->ticks;
+  if(w->minPeriod != 0 && (window.minPeriod == 0 || w->minPeriod < window.minPeriod)) {
+    window.minPeriod = w->minPeriod;
+  }
+  if(w->maxPeriod > window.maxPeriod) {
+    window.maxPeriod = w->maxPeriod;
+  }
+  IntEnable(INT_EDGE_DETECT);
+}
+
+void rideTotalsGet(rideTotals_t *t) {
+  IntDisable(INT_EDGE_DETECT);
+  *t = totals;
+  IntEnable(INT_EDGE_DETECT);
+}
@@ -0,0 +1,44 @@
+/*
+ * ride.h
+ *
+ * Ride aggregates (RIDE_AGGREGATES in config.h)
+ * ---------------------------------------------
+ * Every reed interrupt adds one wheel revolution. Two sets of values are kept:
+ *  - window: revolutions, moving ticks and min/max wheel period since the last
+ *    transmission that carried them. A suppressed or dropped transmission hands
+ *    its window back, so no revolution is lost.
+ *  - totals: distance and moving time since reset. Lost packets do not corrupt
+ *    them, the next packet that arrives carries the current values.
+ * Integer only (no FPU): distance in mm with carry into m, time in RTC ticks
+ * with carry into s. The circumference comes from g_tuning (downlink.h).
+ *
+ * Wheel periods longer than RIDE_MOVING_MAX count as standing still: the
+ * revolution adds distance, but no moving time and no min/max period.
+ */
+
+#ifndef RIDE_H_
+#define RIDE_H_
+
+#include <stdint.h>
+
+typedef struct {
+  uint16_t revs;									// revolutions in window
+  uint32_t ticks;									// moving time in window [1/65536 s]
+  uint32_t minPeriod;								// shortest wheel period [1/65536 s], 0 if none
+  uint32_t maxPeriod;								// longest moving wheel period [1/65536 s]
+} rideWindow_t;
+
+typedef struct {
+  uint32_t distance;								// [m]
+  uint32_t movingTime;								// [s]
+} rideTotals_t;
+
+
+// * Functions
+// ------------
+void rideAddRevolution(uint32_t period);			// from the reed interrupt, period in RTC ticks
+void rideWindowTake(rideWindow_t *w);				// move the running window into w and restart it
+void rideWindowReturn(const rideWindow_t *w);		// merge a window that was not transmitted back
+void rideTotalsGet(rideTotals_t *t);
+
+#endif /* RIDE_H_ */
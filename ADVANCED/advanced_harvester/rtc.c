@@ -46,19 +46,33 @@ void initRTC(void) {
 //  //Set device to wake MCU from standby on RTC channel 2
 //  HWREG(AON_EVENT_BASE + AON_EVENT_O_MCUWUSEL) = AON_EVENT_MCUWUSEL_WU0_EV_RTC_CH2;
 
+  // Channel 0: one-shot wake (rtcWakeAt), MCU wake-up source WU1 (main.c)
+  AONRTCCombinedEventConfig(AON_RTC_CH0);
+  AONRTCChannelDisable(AON_RTC_CH0);
+
   //Enable RTC
   AONRTCEnable();
 
 }
 
+// Wake the MCU from standby or idle at time (RTC format, AONRTCCurrentCompareValueGet()),
+// at least RTC_WAKE_MIN ahead
+void rtcWakeAt(uint32_t time) {
+  // the counter steps by 2 (32768 Hz), an odd compare value would never match
+  AONRTCCompareValueSet(AON_RTC_CH0, (time + 1) & ~1u);
+  AONRTCEventClear(AON_RTC_CH0);
+  AONRTCChannelEnable(AON_RTC_CH0);
+}
+
 //RTC interrupt handler
 void AONRTCIntHandler(void) {
 
-  // Clear RTC event flag
+  // Clear RTC event flag, channel 0 is one-shot
+  AONRTCChannelDisable(AON_RTC_CH0);
   do{
-    AONRTCEventClear(AON_RTC_CH2);
+    AONRTCEventClear(AON_RTC_CH0);
   }
-  while( AONRTCEventGet(AON_RTC_CH2));
+  while( AONRTCEventGet(AON_RTC_CH0));
 
 }
 
@@ -1,3 +1,8 @@
+#include <stdint.h>
+
+#define RTC_WAKE_MIN				0x00000010		// ~0.25 ms, compare has to lie ahead of the counter
+
 void initRTC(void);
+void rtcWakeAt(uint32_t time);
 
 void updateRTCWakeUpTime(long energy_state);
@@ -86,7 +86,7 @@
 /*---------------------------------------------------------------------------*/
 /* Misc. */
 #define MEAS_DATA_SIZE                      6
-#define CALIB_DATA_SIZE                     24
+#define CALIB_DATA_SIZE                     BMP_280_CALIB_DATA_SIZE
 /*---------------------------------------------------------------------------*/
 #define RES_OFF                             0
 #define RES_ULTRA_LOW_POWER                 1
@@ -100,6 +100,9 @@
 #define PM_FORCED                           1
 #define PM_NORMAL                           3
 /*---------------------------------------------------------------------------*/
+/* Bit fields in STATUS register */
+#define STATUS_MEASURING                    0x08
+/*---------------------------------------------------------------------------*/
 #define OSRST(v)                            ((v) << 5)
 #define OSRSP(v)                            ((v) << 2)
 /*---------------------------------------------------------------------------*/
@@ -141,6 +144,9 @@ static uint8_t sensor_value[SENSOR_DATA_BUF_SIZE];
 /* Platform-specific define to signify sensor reading failure */
 #define CC26XX_SENSOR_READING_ERROR        0x80000000
 
+/* Data registers after reset or a skipped measurement (20 bit raw word) */
+#define RAW_RESET_VALUE                    0x80000
+
 /*---------------------------------------------------------------------------*/
 void select_bmp_280(void)
 {
@@ -162,7 +168,13 @@ void init_bmp_280(void)
 
   /* Reset the sensor */
   val = VAL_RESET_EXECUTE;
-  sensor_common_write_reg(ADDR_RESET, &val, sizeof(val));
+  if(sensor_common_write_reg(ADDR_RESET, &val, sizeof(val))) {
+    /* Registers back to their reset values */
+    uint8_t ctrl_meas[2] = { ADDR_CTRL_MEAS, VAL_CTRL_MEAS };
+
+    sensor_shadow_invalidate(BMP280_I2C_ADDRESS);
+    sensor_shadow_store(BMP280_I2C_ADDRESS, ctrl_meas, sizeof(ctrl_meas));
+  }
 }
 /*---------------------------------------------------------------------------*/
 /**
@@ -178,12 +190,13 @@ void enable_bmp_280(bool enable)
   select_bmp_280();
 
   if(enable) {
-    /* Enable forced mode */
+    /* Enable forced mode: a trigger, back to sleep mode when done */
     val = PM_FORCED | OSRSP(1) | OSRST(1);
+    sensor_common_write_reg(ADDR_CTRL_MEAS, &val, sizeof(val));
   } else {
     val = PM_OFF;
+    sensor_common_write_config(ADDR_CTRL_MEAS, &val, sizeof(val));
   }
-  sensor_common_write_reg(ADDR_CTRL_MEAS, &val, sizeof(val));
 }
 /*---------------------------------------------------------------------------*/
 /**
@@ -206,6 +219,22 @@ bool read_data_bmp_280(uint8_t *data)
   return success;
 }
 /*---------------------------------------------------------------------------*/
+/**
+ * \brief Check if the forced measurement is done
+ * \return True if the sensor is back in sleep mode (status: measuring cleared)
+ */
+bool ready_bmp_280(void)
+{
+  uint8_t status;
+
+  select_bmp_280();
+
+  if(!sensor_common_read_reg(ADDR_STATUS, &status, sizeof(status))) {
+    return false;
+  }
+  return (status & STATUS_MEASURING) == 0;
+}
+/*---------------------------------------------------------------------------*/
 /**
  * \brief Convert raw data to values in degrees C (temp) and Pascal (pressure)
  * \param data Pointer to a buffer that holds raw sensor data
@@ -277,6 +306,42 @@ void convert_bmp_280(uint8_t *data, int32_t *temp, uint32_t *press)
   *press = pressure;
 }
 /*---------------------------------------------------------------------------*/
+/**
+ * \brief Read the raw pressure and temperature words without compensation
+ * \param upress Pointer to a variable for the 20 bit raw pressure
+ * \param utemp Pointer to a variable for the 20 bit raw temperature
+ * \return True if valid data could be retrieved and the words are not the
+ *         reset value (no measurement finished since reset)
+ *
+ * The compensation (convert_bmp_280()) is left to the receiver, it needs the
+ * calibration block from calibration_bmp_280(). Call it once ready_bmp_280()
+ * reports the forced measurement done.
+ */
+bool value_raw_bmp_280(uint32_t *upress, uint32_t *utemp)
+{
+  bool success;
+
+  memset(sensor_value, 0, SENSOR_DATA_BUF_SIZE);
+  success = read_data_bmp_280(sensor_value);
+
+  *upress = (((uint32_t)sensor_value[0]) << 12)
+    | (((uint32_t)sensor_value[1]) << 4) | ((uint32_t)sensor_value[2] >> 4);
+  *utemp = (((uint32_t)sensor_value[3]) << 12)
+    | (((uint32_t)sensor_value[4]) << 4) | ((uint32_t)sensor_value[5] >> 4);
+
+  return success && *upress != RAW_RESET_VALUE && *utemp != RAW_RESET_VALUE;
+}
+/*---------------------------------------------------------------------------*/
+/**
+ * \brief Calibration block as read by init_bmp_280()
+ * \return BMP_280_CALIB_DATA_SIZE bytes from register 0x88 on (dig_T1..dig_P9,
+ *         16 bit little endian each)
+ */
+const uint8_t *calibration_bmp_280(void)
+{
+  return calibration_data;
+}
+/*---------------------------------------------------------------------------*/
 /**
  * \brief Returns a reading from the sensor
  * \param BMP_280_SENSOR_TYPE_TEMP or BMP_280_SENSOR_TYPE_PRESS
@@ -61,6 +61,7 @@
 /*---------------------------------------------------------------------------*/
 #define BMP_280_SENSOR_TYPE_TEMP    1
 #define BMP_280_SENSOR_TYPE_PRESS   2
+#define BMP_280_CALIB_DATA_SIZE     24
 /*---------------------------------------------------------------------------*/
 extern const struct sensors_sensor bmp_280_sensor;
 
@@ -92,6 +93,13 @@ void enable_bmp_280(bool enable);
  */
 bool read_data_bmp_280(uint8_t *data);
 
+/*---------------------------------------------------------------------------*/
+/**
+ * \brief Check if the forced measurement is done
+ * \return True if the sensor is back in sleep mode (status: measuring cleared)
+ */
+bool ready_bmp_280(void);
+
 /*---------------------------------------------------------------------------*/
 /**
  * \brief Convert raw data to values in degrees C (temp) and Pascal (pressure)
@@ -101,7 +109,7 @@ bool read_data_bmp_280(uint8_t *data);
  * \param press Pointer to a variable where the converted pressure will be
  *              written
  */
-void nconvert(uint8_t *data, int32_t *temp, uint32_t *press);
+void convert_bmp_280(uint8_t *data, int32_t *temp, uint32_t *press);
 
 /*---------------------------------------------------------------------------*/
 /**
@@ -111,6 +119,23 @@ void nconvert(uint8_t *data, int32_t *temp, uint32_t *press);
  */
 int value_bmp_280(int type);
 
+/*---------------------------------------------------------------------------*/
+/**
+ * \brief Read the raw pressure and temperature words without compensation
+ * \param upress Pointer to a variable for the 20 bit raw pressure
+ * \param utemp Pointer to a variable for the 20 bit raw temperature
+ * \return True if valid data could be retrieved and the words are not the
+ *         reset value 0x80000
+ */
+bool value_raw_bmp_280(uint32_t *upress, uint32_t *utemp);
+
+/*---------------------------------------------------------------------------*/
+/**
+ * \brief Calibration block as read by init_bmp_280()
+ * \return BMP_280_CALIB_DATA_SIZE bytes, dig_T1..dig_P9 little endian
+ */
+const uint8_t *calibration_bmp_280(void);
+
 /*---------------------------------------------------------------------------*/
 /**
  * \brief Configuration function for the BMP280 sensor.
@@ -113,7 +113,7 @@ bool init_hdc_1000(void)
 
   /* Enable reading data in one operation */
   val = SWAP(HDC1000_VAL_CONFIG);
-  success = sensor_common_write_reg(HDC1000_REG_CONFIG, (uint8_t *)&val, 2);
+  success = sensor_common_write_config(HDC1000_REG_CONFIG, (uint8_t *)&val, 2);
 
   SENSOR_DESELECT();
 
@@ -162,16 +162,33 @@ bool read_data_hdc_1000()
 /*---------------------------------------------------------------------------*/
 /**
  * \brief       Convert raw data to temperature and humidity
- * \param       temp - converted temperature
- * \param       hum - converted humidity
+ * \param       temp - converted temperature (centi degrees C)
+ * \param       hum - converted humidity (centi %RH)
  */
-void convert_hdc_1000(float *temp, float *hum)
+void convert_hdc_1000(int32_t *temp, int32_t *hum)
 {
-  /* Convert temperature to degrees C */
-  *temp = ((double)(int16_t)raw_temp / 65536) * 165 - 40;
+  convert_raw_hdc_1000(raw_temp, raw_hum, temp, hum);
+}
+/*---------------------------------------------------------------------------*/
+/**
+ * \brief       Convert register values to temperature and humidity
+ * \param       temp_raw - temperature register (little endian)
+ * \param       hum_raw - humidity register (little endian)
+ * \param       temp - converted temperature (centi degrees C)
+ * \param       hum - converted humidity (centi %RH)
+ *
+ * Integer only, no float runtime: the results are the datasheet formulas
+ * truncated towards zero. The temperature register is taken as signed, as
+ * the conversion always did.
+ */
+void convert_raw_hdc_1000(uint16_t temp_raw, uint16_t hum_raw, int32_t *temp,
+                          int32_t *hum)
+{
+  /* Convert temperature to centi degrees C: raw / 2^16 * 16500 - 4000 */
+  *temp = ((int32_t)(int16_t)temp_raw * 16500 - 4000L * 65536) / 65536;
 
-  /* Convert relative humidity to a %RH value */
-  *hum = ((double)raw_hum / 65536) * 100;
+  /* Convert relative humidity to centi %RH: raw / 2^16 * 10000 */
+  *hum = (int32_t)(((uint32_t)hum_raw * 10000) >> 16);
 }
 
 /*---------------------------------------------------------------------------*/
@@ -183,8 +200,8 @@ void convert_hdc_1000(float *temp, float *hum)
 int value_hdc_1000(int type)
 {
   int rv;
-  float temp;
-  float hum;
+  int32_t temp;
+  int32_t hum;
 
   if((type != HDC_1000_SENSOR_TYPE_TEMP) &&
      type != HDC_1000_SENSOR_TYPE_HUMIDITY) {
@@ -193,12 +210,12 @@ int value_hdc_1000(int type)
   } else {
 	  convert_hdc_1000(&temp, &hum);
     PRINTF("HDC: %04X %04X       t=%d h=%d\n", raw_temp, raw_hum,
-           (int)(temp * 100), (int)(hum * 100));
+           (int)temp, (int)hum);
 
     if(type == HDC_1000_SENSOR_TYPE_TEMP) {
-      rv = (int)(temp * 100);
+      rv = (int)temp;
     } else if(type == HDC_1000_SENSOR_TYPE_HUMIDITY) {
-      rv = (int)(hum * 100);
+      rv = (int)hum;
     }
   }
   return rv;
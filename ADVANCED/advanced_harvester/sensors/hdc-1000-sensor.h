@@ -133,10 +133,21 @@ extern const struct sensors_sensor hdc_1000_sensor;
  /*---------------------------------------------------------------------------*/
  /**
   * \brief       Convert raw data to temperature and humidity
-  * \param       temp - converted temperature
-  * \param       hum - converted humidity
+  * \param       temp - converted temperature (centi degrees C)
+  * \param       hum - converted humidity (centi %RH)
   */
- void convert_hdc_1000(float *temp, float *hum);
+ void convert_hdc_1000(int32_t *temp, int32_t *hum);
+
+ /*---------------------------------------------------------------------------*/
+ /**
+  * \brief       Convert register values to temperature and humidity
+  * \param       temp_raw - temperature register (little endian)
+  * \param       hum_raw - humidity register (little endian)
+  * \param       temp - converted temperature (centi degrees C)
+  * \param       hum - converted humidity (centi %RH)
+  */
+ void convert_raw_hdc_1000(uint16_t temp_raw, uint16_t hum_raw, int32_t *temp,
+                           int32_t *hum);
 
 
  /*---------------------------------------------------------------------------*/
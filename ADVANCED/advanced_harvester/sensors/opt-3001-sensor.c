@@ -45,7 +45,6 @@
 #include <stdbool.h>
 #include <string.h>
 #include <stdio.h>
-#include <math.h>
 /*---------------------------------------------------------------------------*/
 #define DEBUG 0
 #if DEBUG
@@ -161,7 +160,14 @@ void enable_opt_3001(bool enable)
     state = SENSOR_STATE_SLEEPING | had_data_ready;
   }
 
-  sensor_common_write_reg(REG_CONFIGURATION, (uint8_t *)&val, REGISTER_LENGTH);
+  if(enable) {
+    /* A trigger, the sensor shuts down by itself when done */
+    sensor_common_write_reg(REG_CONFIGURATION, (uint8_t *)&val,
+                            REGISTER_LENGTH);
+  } else {
+    sensor_common_write_config(REG_CONFIGURATION, (uint8_t *)&val,
+                               REGISTER_LENGTH);
+  }
 }
 /*---------------------------------------------------------------------------*/
 /**
@@ -174,7 +180,7 @@ bool read_data_opt_3001(uint16_t *raw_data)
   bool success;
   uint16_t val;
 
-  if((state & SENSOR_STATE_DATA_READY) != SENSOR_STATE_DATA_READY) {
+  if(state == SENSOR_STATE_SLEEPING) {
     return false;
   }
 
@@ -183,7 +189,13 @@ bool read_data_opt_3001(uint16_t *raw_data)
   success = sensor_common_read_reg(REG_CONFIGURATION, (uint8_t *)&val,
                                    REGISTER_LENGTH);
 
+  /* No timer marks the data ready here: conversion ready field instead */
+  if(success && (val & CONFIG_CRF) == 0) {
+    return false;
+  }
+
   if(success) {
+    state |= SENSOR_STATE_DATA_READY;
     success = sensor_common_read_reg(REG_RESULT, (uint8_t *)&val, DATA_LENGTH);
   }
 
@@ -198,18 +210,21 @@ bool read_data_opt_3001(uint16_t *raw_data)
 }
 /*---------------------------------------------------------------------------*/
 /**
- * \brief Convert raw data to a value in lux
+ * \brief Convert raw data to a value in centilux
  * \param data Pointer to a buffer with a raw sensor reading
- * \return Converted value (lux)
+ * \return Converted value (centilux)
+ *
+ * lux = 0.01 * 2^E * R[11:0], in centilux the mantissa shifted by the
+ * exponent (at most 4095 << 15, fits 32 bit)
  */
-float convert_opt_3001(uint16_t raw_data)
+uint32_t convert_opt_3001(uint16_t raw_data)
 {
-  uint16_t e, m;
+  uint32_t e, m;
 
   m = raw_data & 0x0FFF;
   e = (raw_data & 0xF000) >> 12;
 
-  return m * (0.01 * exp2(e));
+  return m << e;
 }
 /*---------------------------------------------------------------------------*/
 /**
@@ -221,7 +236,7 @@ int value(int type)
 {
   int rv;
   uint16_t raw_val;
-  float converted_val;
+  uint32_t converted_val;
 
   rv = read_data_opt_3001(&raw_val);
 
@@ -231,9 +246,9 @@ int value(int type)
 
   converted_val = convert_opt_3001(raw_val);
   PRINTF("OPT: %04X            r=%d (centilux)\n", raw_val,
-         (int)(converted_val * 100));
+         (int)converted_val);
 
-  rv = (int)(converted_val * 100);
+  rv = (int)converted_val;
 
   return rv;
 }
@@ -87,11 +87,11 @@ bool read_data_opt_3001(uint16_t *raw_data);
 
 /*---------------------------------------------------------------------------*/
 /**
- * \brief Convert raw data to a value in lux
+ * \brief Convert raw data to a value in centilux
  * \param data Pointer to a buffer with a raw sensor reading
- * \return Converted value (lux)
+ * \return Converted value (centilux)
  */
-float convert_opt_3001(uint16_t raw_data);
+uint32_t convert_opt_3001(uint16_t raw_data);
 
 /*---------------------------------------------------------------------------*/
 /**
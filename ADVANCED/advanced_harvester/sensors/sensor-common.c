@@ -38,23 +38,138 @@
 /*---------------------------------------------------------------------------*/
 #include "sensor-common.h"
 #include "board-i2c.h"
+#include "ti-lib.h"
+#include "diag.h"
+#include <config.h>
+#include <string.h>
 /*---------------------------------------------------------------------------*/
 /* Data to use when an error occurs */
 #define ERROR_DATA                         0xCC
 /*---------------------------------------------------------------------------*/
 static uint8_t buffer[32];
 /*---------------------------------------------------------------------------*/
+/*
+ * Shadow of the configuration registers last written, per slave. Kept in
+ * standby, cleared after every reset: a reset between a write and its store
+ * (or a sensor reset on its own) would leave it wrong, so the first writes
+ * after a reset always go out. Cleared per slave after a bus error.
+ */
+#define SHADOW_ENTRIES                     6
+#define SHADOW_VAL_LEN                     2 /* 8 and 16 bit registers */
+
+typedef struct shadow_entry {
+  uint8_t slave;                         /* 0: free */
+  uint8_t reg;
+  uint8_t len;
+  uint8_t val[SHADOW_VAL_LEN];
+} shadow_entry_t;
+
+static struct {
+  shadow_entry_t entry[SHADOW_ENTRIES];
+} shadow;
+/*---------------------------------------------------------------------------*/
+static shadow_entry_t *
+shadow_find(uint8_t slave, uint8_t reg)
+{
+  uint8_t i;
+
+  for(i = 0; i < SHADOW_ENTRIES; i++) {
+    if(shadow.entry[i].slave == slave && shadow.entry[i].reg == reg) {
+      return &shadow.entry[i];
+    }
+  }
+  return NULL;
+}
+/*---------------------------------------------------------------------------*/
+void
+sensor_shadow_init(void)
+{
+  memset(&shadow, 0, sizeof(shadow));
+}
+/*---------------------------------------------------------------------------*/
 bool
-sensor_common_read_reg(uint8_t addr, uint8_t *buf, uint8_t len)
+sensor_shadow_match(uint8_t slave, const uint8_t *wdata, uint8_t wlen)
+{
+#if SENSOR_SHADOW
+  shadow_entry_t *e = shadow_find(slave, wdata[0]);
+  uint16_t bytes = wlen + 1;    /* slave address, register, value */
+
+  if(e == NULL || e->len != wlen - 1 ||
+     memcmp(e->val, &wdata[1], wlen - 1) != 0) {
+    return false;
+  }
+
+  g_diag.i2cSaved = (g_diag.i2cSaved > 0xFFFF - bytes) ?
+    0xFFFF : g_diag.i2cSaved + bytes;
+  return true;
+#else
+  return false;
+#endif
+}
+/*---------------------------------------------------------------------------*/
+void
+sensor_shadow_store(uint8_t slave, const uint8_t *wdata, uint8_t wlen)
+{
+  shadow_entry_t *e;
+
+  if(wlen < 2 || wlen - 1 > SHADOW_VAL_LEN) {
+    return;
+  }
+
+  e = shadow_find(slave, wdata[0]);
+  if(e == NULL) {
+    e = shadow_find(0, 0);
+  }
+  if(e == NULL) {
+    /* Full: written every time */
+    return;
+  }
+
+  e->slave = slave;
+  e->reg = wdata[0];
+  e->len = wlen - 1;
+  memcpy(e->val, &wdata[1], wlen - 1);
+}
+/*---------------------------------------------------------------------------*/
+void
+sensor_shadow_forget(uint8_t slave, uint8_t reg)
+{
+  shadow_entry_t *e = shadow_find(slave, reg);
+
+  if(e != NULL) {
+    memset(e, 0, sizeof(*e));
+  }
+}
+/*---------------------------------------------------------------------------*/
+void
+sensor_shadow_invalidate(uint8_t slave)
 {
-  return board_i2c_write_read(&addr, 1, buf, len);
+  uint8_t i;
+
+  for(i = 0; i < SHADOW_ENTRIES; i++) {
+    if(shadow.entry[i].slave == slave) {
+      memset(&shadow.entry[i], 0, sizeof(shadow.entry[i]));
+    }
+  }
 }
 /*---------------------------------------------------------------------------*/
 bool
-sensor_common_write_reg(uint8_t addr, uint8_t *buf, uint8_t len)
+sensor_common_read_reg(uint8_t addr, uint8_t *buf, uint8_t len)
+{
+  if(!board_i2c_write_read(&addr, 1, buf, len)) {
+    DIAG_COUNT(i2cFailures);
+    sensor_shadow_invalidate(board_i2c_slave());
+    return false;
+  }
+  return true;
+}
+/*---------------------------------------------------------------------------*/
+static bool
+write_reg(uint8_t addr, uint8_t *buf, uint8_t len, bool config)
 {
   uint8_t i;
   uint8_t *p = buffer;
+  uint8_t slave = board_i2c_slave();
 
   /* Copy address and data to local buffer for burst write */
   *p++ = addr;
@@ -63,8 +178,35 @@ sensor_common_write_reg(uint8_t addr, uint8_t *buf, uint8_t len)
   }
   len++;
 
+  if(config && sensor_shadow_match(slave, buffer, len)) {
+    return true;
+  }
+
   /* Send data */
-  return board_i2c_write(buffer, len);
+  if(!board_i2c_write(buffer, len)) {
+    DIAG_COUNT(i2cFailures);
+    sensor_shadow_invalidate(slave);
+    return false;
+  }
+
+  if(config) {
+    sensor_shadow_store(slave, buffer, len);
+  } else {
+    sensor_shadow_forget(slave, addr);
+  }
+  return true;
+}
+/*---------------------------------------------------------------------------*/
+bool
+sensor_common_write_reg(uint8_t addr, uint8_t *buf, uint8_t len)
+{
+  return write_reg(addr, buf, len, false);
+}
+/*---------------------------------------------------------------------------*/
+bool
+sensor_common_write_config(uint8_t addr, uint8_t *buf, uint8_t len)
+{
+  return write_reg(addr, buf, len, true);
 }
 /*---------------------------------------------------------------------------*/
 void
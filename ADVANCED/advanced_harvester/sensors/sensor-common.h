@@ -65,10 +65,24 @@ bool sensor_common_read_reg(uint8_t addr, uint8_t *buf, uint8_t len);
  * \param len Number of bytes to write
  * \return TRUE if successful write
  *
- * The sensor must be selected before this routine is called.
+ * The sensor must be selected before this routine is called. For triggers
+ * and commands: the register drops out of the shadow.
  */
 bool sensor_common_write_reg(uint8_t addr, uint8_t *buf, uint8_t len);
 
+/**
+ * \brief Write a configuration register, unless it already holds the value
+ * \param addr The address of the register to write
+ * \param buf Pointer to buffer containing data to be written
+ * \param len Number of bytes to write (1 or 2)
+ * \return TRUE if successful write, or no write needed
+ *
+ * The sensor must be selected before this routine is called. The value is
+ * compared with the shadow of the last value written (SENSOR_SHADOW in
+ * config.h), the bytes skipped are counted in g_diag.i2cSaved.
+ */
+bool sensor_common_write_config(uint8_t addr, uint8_t *buf, uint8_t len);
+
 /**
  * \brief Fill a result buffer with dummy error data
  * \param buf Pointer to the buffer where to write the data
@@ -77,6 +91,45 @@ bool sensor_common_write_reg(uint8_t addr, uint8_t *buf, uint8_t len);
  */
 void sensor_common_set_error_data(uint8_t *buf, uint8_t len);
 /*---------------------------------------------------------------------------*/
+/**
+ * \brief Clear the register shadow after a reset
+ *
+ * Once after reset, before the first register write. Cleared after every
+ * reset cause: nothing written before the reset is trusted.
+ */
+void sensor_shadow_init(void);
+
+/**
+ * \brief Check a register write against the shadow
+ * \param slave The slave's address
+ * \param wdata Register address and value, as sent
+ * \param wlen Number of bytes in wdata
+ * \return TRUE if the register already holds the value, the write can be
+ *         skipped (and is counted as saved)
+ */
+bool sensor_shadow_match(uint8_t slave, const uint8_t *wdata, uint8_t wlen);
+
+/**
+ * \brief Record a register value after a successful write
+ * \param slave The slave's address
+ * \param wdata Register address and value, as sent
+ * \param wlen Number of bytes in wdata
+ */
+void sensor_shadow_store(uint8_t slave, const uint8_t *wdata, uint8_t wlen);
+
+/**
+ * \brief Drop one register from the shadow, its value is unknown now
+ * \param slave The slave's address
+ * \param reg The register address
+ */
+void sensor_shadow_forget(uint8_t slave, uint8_t reg);
+
+/**
+ * \brief Drop all registers of a slave (bus error, sensor reset)
+ * \param slave The slave's address
+ */
+void sensor_shadow_invalidate(uint8_t slave);
+/*---------------------------------------------------------------------------*/
 #endif /* SENSOR_H */
 /*---------------------------------------------------------------------------*/
 /**
@@ -42,7 +42,6 @@
 #include <stdint.h>
 #include <string.h>
 #include <stdio.h>
-#include <math.h>
 #include <ti-lib.h>
 #include "board.h"
 
@@ -130,8 +129,8 @@ bool enable_tmp_007(bool enable)
   }
   val = SWAP(val);
 
-  success = sensor_common_write_reg(TMP007_REG_ADDR_CONFIG, (uint8_t *)&val,
-                                   REGISTER_LENGTH);
+  success = sensor_common_write_config(TMP007_REG_ADDR_CONFIG,
+                                      (uint8_t *)&val, REGISTER_LENGTH);
 
   return success;
 }
@@ -177,25 +176,19 @@ bool read_data_tmp_007(uint16_t *raw_temp, uint16_t *raw_obj_temp)
 }
 /*---------------------------------------------------------------------------*/
 /**
- * \brief Convert raw data to values in degrees C
+ * \brief Convert raw data to values in milli degrees C
  * \param raw_temp raw ambient temperature from sensor
  * \param raw_obj_temp raw object temperature from sensor
  * \param obj converted object temperature
  * \param amb converted ambient temperature
+ *
+ * 14 bit result, 0.03125 degrees C = 125 / 4 milli degrees C per LSB,
+ * truncated as the float conversion did
  */
-void convert_tmp_007(uint16_t raw_temp, uint16_t raw_obj_temp, float *obj, float *amb)
+void convert_tmp_007(uint16_t raw_temp, uint16_t raw_obj_temp, int32_t *obj, int32_t *amb)
 {
-  const float SCALE_LSB = 0.03125;
-  float t;
-  int it;
-
-  it = (int)((raw_obj_temp) >> 2);
-  t = ((float)(it)) * SCALE_LSB;
-  *obj = t;
-
-  it = (int)((raw_temp) >> 2);
-  t = (float)it;
-  *amb = t * SCALE_LSB;
+  *obj = ((int32_t)(raw_obj_temp >> 2) * 125) / 4;
+  *amb = ((int32_t)(raw_temp >> 2) * 125) / 4;
 }
 /*---------------------------------------------------------------------------*/
 /**
@@ -208,8 +201,8 @@ int value_tmp_007(int type)
   int rv;
   uint16_t raw_temp;
   uint16_t raw_obj_temp;
-  float obj_temp;
-  float amb_temp;
+  int32_t obj_temp;
+  int32_t amb_temp;
 
   if((type & TMP_007_SENSOR_TYPE_ALL) == 0) {
     PRINTF("Invalid type\n");
@@ -226,10 +219,10 @@ int value_tmp_007(int type)
 
     convert_tmp_007(raw_temp, raw_obj_temp, &obj_temp, &amb_temp);
     PRINTF("TMP: %04X %04X       o=%d a=%d\n", raw_temp, raw_obj_temp,
-           (int)(obj_temp * 1000), (int)(amb_temp * 1000));
+           (int)obj_temp, (int)amb_temp);
 
-    obj_temp_latched = (int)(obj_temp * 1000);
-    amb_temp_latched = (int)(amb_temp * 1000);
+    obj_temp_latched = (int)obj_temp;
+    amb_temp_latched = (int)amb_temp;
     rv = 1;
   if(type == TMP_007_SENSOR_TYPE_OBJECT) {
     rv = obj_temp_latched;
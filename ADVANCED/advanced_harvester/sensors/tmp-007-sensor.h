@@ -90,13 +90,13 @@ bool read_data_tmp_007(uint16_t *raw_temp, uint16_t *raw_obj_temp);
 
 /*---------------------------------------------------------------------------*/
 /**
- * \brief Convert raw data to values in degrees C
+ * \brief Convert raw data to values in milli degrees C
  * \param raw_temp raw ambient temperature from sensor
  * \param raw_obj_temp raw object temperature from sensor
  * \param obj converted object temperature
  * \param amb converted ambient temperature
  */
-void convert_tmp_007(uint16_t raw_temp, uint16_t raw_obj_temp, float *obj, float *amb);
+void convert_tmp_007(uint16_t raw_temp, uint16_t raw_obj_temp, int32_t *obj, int32_t *amb);
 
 /*---------------------------------------------------------------------------*/
 /**
@@ -198,6 +198,24 @@ void powerDisablePeriph(void) {
   HWREGBITW(PRCM_BASE + PRCM_O_CLKLOADCTL, PRCM_CLKLOADCTL_LOAD_BITN) = 1;
 }
 
+// PERIPH for a short user (crypto engine): a domain requested by the caller (GPIO, uDMA)
+// stays on after the release
+bool powerAcquirePeriph(void) {
+  bool owned = HWREGBITW(PRCM_BASE + PRCM_O_PDCTL0PERIPH , PRCM_PDCTL0PERIPH_ON_BITN) == 0;
+
+  if(owned) {
+    powerEnablePeriph();
+  }
+  waitUntilPeriphReady();
+  return owned;
+}
+
+void powerReleasePeriph(bool owned) {
+  if(owned) {
+    powerDisablePeriph();
+  }
+}
+
 void powerDisableCPU(void) {
   // Turn off CPU domain in CPU Deep Sleep
   HWREGBITW(PRCM_BASE + PRCM_O_PDCTL1CPU, PRCM_PDCTL1CPU_ON_BITN) = 0;
@@ -259,6 +277,21 @@ void powerEnableXtal(void) {
 void powerDisableXtal(void) {
   //Disable HF XTAL for HF clock
   HWREGBITW(AUX_DDI0_OSC_BASE + DDI_0_OSC_O_CTL0, DDI_0_OSC_CTL0_SCLK_HF_SRC_SEL_BITN) = 0;
+  energyOff(ENERGY_XOSC);
+}
+
+void powerTurnOnXosc(void) {
+  // Start 24 MHz XOSC, switch with OSCHF_AttemptToSwitchToXosc() once settled
+  OSCHF_TurnOnXosc();
+  energyOn(ENERGY_XOSC);
+}
+
+void powerIdle(void) {
+  // CPU off until the next interrupt, MCU stays powered (no MCU power-down request)
+  energyMcuState(ENERGY_IDLE);
+  powerDisableCPU();
+  PRCMDeepSleep();
+  energyMcuState(ENERGY_CPU);
 }
 
 void powerEnableXtalInterface(void) {
@@ -281,3 +314,71 @@ void waitUntilAUXReady(void) {
   while(HWREGBITW(AON_WUC_BASE + AON_WUC_O_PWRSTAT, AON_WUC_PWRSTAT_AUX_PD_ON_BITN) != 1)
   {}
 }
+
+
+// Software coulomb counter
+// ------------------------
+// Each class accumulates its on-time from RTC deltas (1/65536 s) times its current
+// from ENERGY_CURRENT_UA. uA * ticks / 65536 = uC, the remainder is carried
+static const uint16_t energyCurrent[ENERGY_CLASSES] = ENERGY_CURRENT_UA;
+static uint32_t energySince[ENERGY_CLASSES];
+static uint32_t energyFrac[ENERGY_CLASSES];
+static uint32_t energyUC[ENERGY_CLASSES];
+static uint8_t energyActive = 0;					// bit per class
+static uint8_t energyMcu = ENERGY_CPU;
+static uint32_t energyWindowStart, energyWindowCharge, energyAverage = 0;
+
+static void energyAccumulate(uint8_t cls, uint32_t now) {
+  uint64_t q = (uint64_t)(now - energySince[cls]) * energyCurrent[cls] + energyFrac[cls];
+
+  energyUC[cls] += (uint32_t)(q >> 16);
+  energyFrac[cls] = (uint32_t)q & 0xFFFF;
+  energySince[cls] = now;
+}
+
+void energyOn(uint8_t cls) {
+  if(!ENERGY_ACCOUNTING || (energyActive & (1 << cls))) {
+    return;
+  }
+  energySince[cls] = AONRTCCurrentCompareValueGet();
+  energyActive |= 1 << cls;
+}
+
+void energyOff(uint8_t cls) {
+  if(!ENERGY_ACCOUNTING || !(energyActive & (1 << cls))) {
+    return;
+  }
+  energyAccumulate(cls, AONRTCCurrentCompareValueGet());
+  energyActive &= ~(1 << cls);
+}
+
+void energyMcuState(uint8_t cls) {
+  energyOff(energyMcu);
+  energyOn(cls);
+  energyMcu = cls;
+}
+
+uint32_t energyCharge(uint8_t cls) {
+  if(energyActive & (1 << cls)) {
+    energyAccumulate(cls, AONRTCCurrentCompareValueGet());
+  }
+  return energyUC[cls];
+}
+
+uint32_t energyAverageCurrent(void) {
+  uint32_t now = AONRTCCurrentCompareValueGet();
+  uint32_t total = 0;
+  uint8_t i;
+
+  if(now - energyWindowStart < ENERGY_WINDOW) {
+    return energyAverage;
+  }
+  for(i = 0; i < ENERGY_CLASSES; i++) {
+    total += energyCharge(i);
+  }
+  // uC * 65536 / ticks = uA
+  energyAverage = (uint32_t)(((uint64_t)(total - energyWindowCharge) << 16) / (now - energyWindowStart));
+  energyWindowStart = now;
+  energyWindowCharge = total;
+  return energyAverage;
+}
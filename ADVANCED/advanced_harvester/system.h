@@ -22,6 +22,8 @@ void powerDisableRFC(void);
 
 void powerEnablePeriph(void);
 void powerDisablePeriph(void);
+bool powerAcquirePeriph(void);					// PERIPH on and ready, true if this call switched it on
+void powerReleasePeriph(bool owned);			// off again if the matching acquire switched it on
 
 void powerDisableCPU(void);
 
@@ -46,3 +48,23 @@ void waitUntilPeriphReady(void);
 void waitUntilAUXReady(void);
 
 void powerDivideInfClkDS(uint32_t);
+
+void powerTurnOnXosc(void);
+void powerIdle(void);
+
+
+// * Software coulomb counter (ENERGY_ACCOUNTING in config.h)
+// ------------------------------------------------------------
+// CPU, IDLE and STANDBY exclude each other (energyMcuState), RF and XOSC come on top
+#define ENERGY_RF					0
+#define ENERGY_XOSC					1
+#define ENERGY_CPU					2
+#define ENERGY_IDLE					3
+#define ENERGY_STANDBY				4
+#define ENERGY_CLASSES				5
+
+void energyOn(uint8_t cls);
+void energyOff(uint8_t cls);
+void energyMcuState(uint8_t cls);
+uint32_t energyCharge(uint8_t cls);					// [uC] since reset
+uint32_t energyAverageCurrent(void);				// [uA] over the last ENERGY_WINDOW
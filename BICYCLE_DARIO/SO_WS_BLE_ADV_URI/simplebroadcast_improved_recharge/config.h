@@ -17,3 +17,6 @@
 
 //Advertisment payload length in bytes
 #define ADVLEN 30
+
+// Sensor id, last byte of the URI advert (uri_payload.h)
+#define SENSOR_ID 200
@@ -71,8 +71,8 @@
 #include <radio.h>
 #include <system.h>
 #include <inc/hw_aon_event.h>
-#include <stdio.h>
 #include <driverLib/aon_rtc.h>
+#include <uri_payload.h>
 
 #include "mbedtls/aes.h"
 
@@ -376,14 +376,10 @@ int main(void) {
     	temperature = value_tmp_007(TMP_007_SENSOR_TYPE_AMBIENT);
     }while(temperature==0x80000000);
     enable_tmp_007(0);
-    char char_temp[5];
-    sprintf(char_temp, "%3d",temperature/100);
 
     //Wait for, read and calc humidity
     while(!read_data_hdc_1000());
     int humidity = value_hdc_1000(HDC_1000_SENSOR_TYPE_HUMIDITY);
-    char char_hum[5];
-    sprintf(char_hum, "%3d",humidity/10);
 
 /*****************************************************************************************/
 /*   mbedtls_aes_context aes;
@@ -466,41 +462,9 @@ int main(void) {
 /*****************************************************************************************/
 //Todo: Set payload and transmit
 #define VENDOR		9
-#define SENSOR_ID	200
 	uint8_t p;
-    p = 0;
-    /*URI-Payload length=29 ADV_LEN = 30*/
-    payload[p++] = 29;         /* len */
-    payload[p++] = 0x24;		  /* Type URI */
-    payload[p++] = 0x17;		/* UTF-8 code point for “https:”*/
-    payload[p++] = '/';
-    payload[p++] = '/';
-    payload[p++] = 's';
-    payload[p++] = 'k';
-    payload[p++] = 'i';
-    payload[p++] = '.';
-    payload[p++] = 'z';
-    payload[p++] = 'h';
-    payload[p++] = 'a';
-    payload[p++] = 'w';
-    payload[p++] = '.';
-    payload[p++] = 'c';
-    payload[p++] = 'h';
-
-    payload[p++] = '?';
- 	payload[p++] = 't';
-	payload[p++] = '=';
-	payload[p++] = char_temp[0];
-	payload[p++] = char_temp[1];
-	payload[p++] = char_temp[2];
-	payload[p++] = '&';
-   	payload[p++] = 'h';
-   	payload[p++] = '=';
-   	payload[p++] = char_hum[0];
-   	payload[p++] = char_hum[1];
-   	payload[p++] = char_hum[2];
-   	payload[p++] = '#';
-   	payload[p++] = SENSOR_ID;
+    /*URI-Payload length=29 ADV_LEN = 30, template in flash, only the digits are written (uri_payload.h)*/
+    p = uriPayloadBuild(payload, temperature / 100, humidity / 10);
 
     /*URI-Payload length=2+21 ADV_LEN = 25*/
 //    payload[p++] = 2;          /* len */
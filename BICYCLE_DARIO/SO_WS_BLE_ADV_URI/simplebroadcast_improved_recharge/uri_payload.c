@@ -0,0 +1,65 @@
+/*
+ * uri_payload.c
+ *
+ * URI advert without printf, format see uri_payload.h
+ */
+
+#include <string.h>
+#include <config.h>
+#include <uri_payload.h>
+
+#define URI_AD_TYPE				0x24
+#define URI_FIELD_LEN			3
+
+// Text after the AD type byte, up to the sensor id. Blanks are the digit fields
+#define URI_PREFIX				"\x17" URI_HOST "?t="
+#define URI_MIDDLE				"&h="
+#define URI_SUFFIX				"#"
+
+static const char uriTemplate[] = URI_PREFIX "   " URI_MIDDLE "   " URI_SUFFIX;
+
+#define URI_TEXT_LEN			(sizeof(uriTemplate) - 1)
+#define URI_ADV_LEN				(2 + URI_TEXT_LEN + 1)
+#define URI_TEMP_POS			(2 + sizeof(URI_PREFIX) - 1)
+#define URI_HUM_POS				(URI_TEMP_POS + URI_FIELD_LEN + sizeof(URI_MIDDLE) - 1)
+
+// build fails if the template does not fill the advert buffer exactly
+typedef char uriLengthCheck[(URI_ADV_LEN == ADVLEN) ? 1 : -1];
+
+
+// Like sprintf("%3d"), value clamped to -99..999. v / 10 as (v * 205) >> 11, exact for v < 1029
+static void uriPutDec3(uint8_t *dst, int v) {
+  uint32_t u, q;
+  int8_t i = URI_FIELD_LEN - 1;
+
+  if(v > 999) v = 999;
+  if(v < -99) v = -99;
+  u = (v < 0) ? -v : v;
+
+  do {
+    q = (u * 205) >> 11;
+    dst[i--] = '0' + (u - q * 10);
+    u = q;
+  } while(u != 0);
+
+  if(v < 0) {
+    dst[i--] = '-';
+  }
+  while(i >= 0) {
+    dst[i--] = ' ';
+  }
+}
+
+
+uint8_t uriPayloadBuild(uint8_t *buf, int temperature, int humidity) {
+
+  buf[0] = URI_ADV_LEN - 1;
+  buf[1] = URI_AD_TYPE;
+  memcpy(&buf[2], uriTemplate, URI_TEXT_LEN);
+
+  uriPutDec3(&buf[URI_TEMP_POS], temperature);
+  uriPutDec3(&buf[URI_HUM_POS], humidity);
+
+  buf[URI_ADV_LEN - 1] = SENSOR_ID;
+  return URI_ADV_LEN;
+}
@@ -0,0 +1,30 @@
+/*
+ * uri_payload.h
+ *
+ * URI advert from a compile-time template
+ * ---------------------------------------
+ * AdvData (ADVLEN = 30):
+ *   [0]      AD length (29)
+ *   [1]      0x24 (URI)
+ *   [2]      0x17 (UTF-8 code point for "https:")
+ *   [3..]    "//ski.zhaw.ch?t=TTT&h=HHH#"
+ *   [29]     SENSOR_ID
+ *
+ * The constant part lives in flash (uriTemplate in uri_payload.c), offsets of the
+ * digit fields are compile-time constants. Per wake only the six digits are patched,
+ * same text as sprintf("%3d") gave: right aligned, blank padded.
+ *   TTT  temperature [0.1 degC], -99..999
+ *   HHH  humidity [0.1 %RH], 0..999
+ */
+
+#ifndef URI_PAYLOAD_H_
+#define URI_PAYLOAD_H_
+
+#include <stdint.h>
+
+#define URI_HOST				"//ski.zhaw.ch"
+
+// Build the advert into buf (ADVLEN bytes), returns the length
+uint8_t uriPayloadBuild(uint8_t *buf, int temperature, int humidity);
+
+#endif /* URI_PAYLOAD_H_ */
@@ -0,0 +1,139 @@
+/*
+ * aes_check.c
+ *
+ * Known-answer test of aes128.c as the host builds it (AES128_SOFT, the reference the
+ * gateway code and the ROM/engine backends are compared against):
+ *   key record  aes128Expand(): round key 10 (FIPS-197 A.1), CMAC subkeys (RFC 4493 2.3)
+ *   ECB         aes128Encrypt() on both keys (FIPS-197 C.1, SP 800-38A F.1.1 block 1)
+ *   CTR         aes128Ctr() (SP 800-38A F.5.1), counter after the call
+ *   CMAC        aes128Cmac() on 0, 16, 40, 64 bytes (RFC 4493 4), truncated to 4 bytes
+ *   CCM         aes128CcmMic() without payload, 13 byte nonce (IEEE 802.15.4-2006 C.2.1,
+ *               M = 8). M = 4 as authSeal() uses it: same inputs, value cross-checked
+ *               with OpenSSL EVP_aes_128_ccm()
+ *
+ * build: cc -O2 -I../ADVANCED/advanced_harvester -I../ADVANCED/advanced_harvester/cc26xxware_2_22_00_16101
+ *           -o aes_check aes_check.c ../ADVANCED/advanced_harvester/aes128.c
+ *
+ * Exit code 0 if every vector matches.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include "aes128.h"
+
+// * Vectors
+// ---------
+static const uint8_t fipsKey[16] = {
+  0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e, 0x0f
+};
+static const uint8_t fipsPlain[16] = {
+  0x00, 0x11, 0x22, 0x33, 0x44, 0x55, 0x66, 0x77, 0x88, 0x99, 0xaa, 0xbb, 0xcc, 0xdd, 0xee, 0xff
+};
+static const uint8_t fipsCipher[16] = {
+  0x69, 0xc4, 0xe0, 0xd8, 0x6a, 0x7b, 0x04, 0x30, 0xd8, 0xcd, 0xb7, 0x80, 0x70, 0xb4, 0xc5, 0x5a
+};
+
+// SP 800-38A / RFC 4493 key and message
+static const uint8_t spKey[16] = {
+  0x2b, 0x7e, 0x15, 0x16, 0x28, 0xae, 0xd2, 0xa6, 0xab, 0xf7, 0x15, 0x88, 0x09, 0xcf, 0x4f, 0x3c
+};
+static const uint8_t spMsg[64] = {
+  0x6b, 0xc1, 0xbe, 0xe2, 0x2e, 0x40, 0x9f, 0x96, 0xe9, 0x3d, 0x7e, 0x11, 0x73, 0x93, 0x17, 0x2a,
+  0xae, 0x2d, 0x8a, 0x57, 0x1e, 0x03, 0xac, 0x9c, 0x9e, 0xb7, 0x6f, 0xac, 0x45, 0xaf, 0x8e, 0x51,
+  0x30, 0xc8, 0x1c, 0x46, 0xa3, 0x5c, 0xe4, 0x11, 0xe5, 0xfb, 0xc1, 0x19, 0x1a, 0x0a, 0x52, 0xef,
+  0xf6, 0x9f, 0x24, 0x45, 0xdf, 0x4f, 0x9b, 0x17, 0xad, 0x2b, 0x41, 0x7b, 0xe6, 0x6c, 0x37, 0x10
+};
+static const uint8_t spRoundKey10[16] = {
+  0xd0, 0x14, 0xf9, 0xa8, 0xc9, 0xee, 0x25, 0x89, 0xe1, 0x3f, 0x0c, 0xc8, 0xb6, 0x63, 0x0c, 0xa6
+};
+static const uint8_t spEcb1[16] = {
+  0x3a, 0xd7, 0x7b, 0xb4, 0x0d, 0x7a, 0x36, 0x60, 0xa8, 0x9e, 0xca, 0xf3, 0x24, 0x66, 0xef, 0x97
+};
+static const uint8_t cmacK1[16] = {
+  0xfb, 0xee, 0xd6, 0x18, 0x35, 0x71, 0x33, 0x66, 0x7c, 0x85, 0xe0, 0x8f, 0x72, 0x36, 0xa8, 0xde
+};
+static const uint8_t cmacK2[16] = {
+  0xf7, 0xdd, 0xac, 0x30, 0x6a, 0xe2, 0x66, 0xcc, 0xf9, 0x0b, 0xc1, 0x1e, 0xe4, 0x6d, 0x51, 0x3b
+};
+static const uint8_t cmacLen[4] = {0, 16, 40, 64};
+static const uint8_t cmacMac[4][16] = {
+  {0xbb, 0x1d, 0x69, 0x29, 0xe9, 0x59, 0x37, 0x28, 0x7f, 0xa3, 0x7d, 0x12, 0x9b, 0x75, 0x67, 0x46},
+  {0x07, 0x0a, 0x16, 0xb4, 0x6b, 0x4d, 0x41, 0x44, 0xf7, 0x9b, 0xdd, 0x9d, 0xd0, 0x4a, 0x28, 0x7c},
+  {0xdf, 0xa6, 0x67, 0x47, 0xde, 0x9a, 0xe6, 0x30, 0x30, 0xca, 0x32, 0x61, 0x14, 0x97, 0xc8, 0x27},
+  {0x51, 0xf0, 0xbe, 0xbf, 0x7e, 0x3b, 0x9d, 0x92, 0xfc, 0x49, 0x74, 0x17, 0x79, 0x36, 0x3c, 0xfe}
+};
+static const uint8_t ctrCounter[16] = {
+  0xf0, 0xf1, 0xf2, 0xf3, 0xf4, 0xf5, 0xf6, 0xf7, 0xf8, 0xf9, 0xfa, 0xfb, 0xfc, 0xfd, 0xfe, 0xff
+};
+static const uint8_t ctrCounterAfter[16] = {
+  0xf0, 0xf1, 0xf2, 0xf3, 0xf4, 0xf5, 0xf6, 0xf7, 0xf8, 0xf9, 0xfa, 0xfb, 0xfc, 0xfd, 0xff, 0x03
+};
+static const uint8_t ctrCipher[64] = {
+  0x87, 0x4d, 0x61, 0x91, 0xb6, 0x20, 0xe3, 0x26, 0x1b, 0xef, 0x68, 0x64, 0x99, 0x0d, 0xb6, 0xce,
+  0x98, 0x06, 0xf6, 0x6b, 0x79, 0x70, 0xfd, 0xff, 0x86, 0x17, 0x18, 0x7b, 0xb9, 0xff, 0xfd, 0xff,
+  0x5a, 0xe4, 0xdf, 0x3e, 0xdb, 0xd5, 0xd3, 0x5e, 0x5b, 0x4f, 0x09, 0x02, 0x0d, 0xb0, 0x3e, 0xab,
+  0x1e, 0x03, 0x1d, 0xda, 0x2f, 0xbe, 0x03, 0xd1, 0x79, 0x21, 0x70, 0xa0, 0xf3, 0x00, 0x9c, 0xee
+};
+
+// IEEE 802.15.4-2006 C.2.1: MAC beacon frame, authentication only
+static const uint8_t ccmKey[16] = {
+  0xc0, 0xc1, 0xc2, 0xc3, 0xc4, 0xc5, 0xc6, 0xc7, 0xc8, 0xc9, 0xca, 0xcb, 0xcc, 0xcd, 0xce, 0xcf
+};
+static const uint8_t ccmNonce[AES128_CCM_NONCE_LEN] = {
+  0xac, 0xde, 0x48, 0x00, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00, 0x05, 0x02
+};
+static const uint8_t ccmAad[26] = {
+  0x08, 0xd0, 0x84, 0x21, 0x43, 0x01, 0x00, 0x00, 0x00, 0x00, 0x48, 0xde, 0xac,
+  0x02, 0x05, 0x00, 0x00, 0x00, 0x55, 0xcf, 0x00, 0x00, 0x51, 0x52, 0x53, 0x54
+};
+static const uint8_t ccmMic8[8] = {0x22, 0x3b, 0xc1, 0xec, 0x84, 0x1a, 0xb5, 0x53};
+static const uint8_t ccmMic4[4] = {0x2e, 0x13, 0x90, 0xaf};
+
+
+static bool ok = true;
+
+static void check(const char *name, bool result, const uint8_t *out, const uint8_t *expected, size_t len) {
+  bool match = result && memcmp(out, expected, len) == 0;
+
+  printf("%-24s %s\n", name, match ? "ok" : "FAIL");
+  ok = ok && match;
+}
+
+
+int main(void) {
+  aes128_key_t key;
+  uint8_t block[16], counter[16], data[64], mac[16];
+  char name[32];
+  int i;
+
+  aes128Expand(fipsKey, &key);
+  memcpy(block, fipsPlain, 16);
+  check("ECB FIPS-197 C.1", aes128Encrypt(&key, block), block, fipsCipher, 16);
+
+  aes128Expand(spKey, &key);
+  check("round key 10", true, &key.rk[AES128_ROUNDS * 16], spRoundKey10, 16);
+  check("CMAC K1", true, key.cmacK1, cmacK1, 16);
+  check("CMAC K2", true, key.cmacK2, cmacK2, 16);
+  memcpy(block, spMsg, 16);
+  check("ECB SP 800-38A F.1.1", aes128Encrypt(&key, block), block, spEcb1, 16);
+
+  memcpy(counter, ctrCounter, 16);
+  memcpy(data, spMsg, 64);
+  check("CTR SP 800-38A F.5.1", aes128Ctr(&key, counter, data, 64), data, ctrCipher, 64);
+  check("CTR counter", true, counter, ctrCounterAfter, 16);
+
+  for(i = 0; i < 4; i++) {
+    sprintf(name, "CMAC %u bytes", cmacLen[i]);
+    check(name, aes128Cmac(&key, spMsg, cmacLen[i], mac, 16), mac, cmacMac[i], 16);
+  }
+  memset(mac, 0, sizeof(mac));
+  check("CMAC 64 bytes, tag 4", aes128Cmac(&key, spMsg, 64, mac, 4) && mac[4] == 0, mac, cmacMac[3], 4);
+
+  aes128Expand(ccmKey, &key);
+  check("CCM MIC M = 8", aes128CcmMic(&key, ccmNonce, ccmAad, sizeof(ccmAad), mac, 8), mac, ccmMic8, 8);
+  check("CCM MIC M = 4", aes128CcmMic(&key, ccmNonce, ccmAad, sizeof(ccmAad), mac, 4), mac, ccmMic4, 4);
+
+  return ok ? 0 : 1;
+}
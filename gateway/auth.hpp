@@ -0,0 +1,244 @@
+// auth.hpp
+//
+// Gateway side of the payload authentication of advanced_harvester (AUTH_PAYLOAD,
+// format see ADVANCED/advanced_harvester/auth.h): AES-CCM MIC check and replay
+// protection, one Device per bike (key from provisioning, last accepted counter).
+//
+// Keys come from authkey.py, one line per bike in the key file: address (most significant
+// byte first, so adva[] below is that byte order reversed) and key, 32 hex digits. A line
+// replaced by authkey.py --replace needs a new Device: the bike starts at epoch 1 again.
+//
+// Frames carry only the low 16 bits of the nonce counter. The full counter is rebuilt
+// from the last accepted one: same epoch first, then up to kEpochSearch later epochs
+// (power-ons the gateway did not hear). Only counters above the last accepted one can
+// pass: a recorded frame sent again fails, as kReplay within the current epoch and as
+// kBadMic from an older one. Keep lastCounter across gateway restarts, otherwise old
+// frames verify once more.
+//
+// Lockout and recovery: after more than kEpochSearch unheard power-ons every frame fails
+// verify() with kBadMic. The first part of the diagnostics frame (payload_advanced_diag.hpp,
+// first transmission after every reset, then every DIAG_FRAME_RATIO-th) carries the epoch:
+// decode it from a frame that failed verify() (frame[0] - kTrailerLen, len - kTrailerLen)
+// and pass it to resync(). The MIC is checked for that one epoch, so the plain epoch field
+// gives a forger nothing; the frames after it verify again. Until the next diagnostics
+// frame the device stays locked out. A device whose epoch page is used up (auth.h) sends
+// unsealed frames only, it needs a new key.
+
+#ifndef AUTH_HPP_
+#define AUTH_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+namespace auth {
+
+constexpr std::size_t kKeyLen = 16;
+constexpr std::size_t kCtrLen = 2;
+constexpr std::size_t kMicLen = 4;
+constexpr std::size_t kTrailerLen = kCtrLen + kMicLen;
+constexpr std::size_t kNonceLen = 13;
+constexpr uint32_t kEpochSearch = 64;    // verify(): later epochs tried, see resync()
+
+// AES-128 encryption, portable byte-oriented implementation
+class Aes128 {
+ public:
+  explicit Aes128(const uint8_t key[kKeyLen]) {
+    static const uint8_t rcon[10] = {0x01, 0x02, 0x04, 0x08, 0x10, 0x20, 0x40, 0x80, 0x1b, 0x36};
+    std::memcpy(rk_, key, kKeyLen);
+    for (unsigned i = 16; i < 176; i += 4) {
+      uint8_t t[4] = {rk_[i - 4], rk_[i - 3], rk_[i - 2], rk_[i - 1]};
+      if (i % 16 == 0) {
+        uint8_t t0 = t[0];
+        t[0] = static_cast<uint8_t>(sbox(t[1]) ^ rcon[i / 16 - 1]);
+        t[1] = sbox(t[2]);
+        t[2] = sbox(t[3]);
+        t[3] = sbox(t0);
+      }
+      for (unsigned j = 0; j < 4; j++) {
+        rk_[i + j] = rk_[i + j - 16] ^ t[j];
+      }
+    }
+  }
+
+  void encrypt(uint8_t s[16]) const {
+    addRoundKey(s, 0);
+    for (unsigned round = 1; round < 10; round++) {
+      subShift(s);
+      mixColumns(s);
+      addRoundKey(s, round);
+    }
+    subShift(s);
+    addRoundKey(s, 10);
+  }
+
+  // round keys 0..10 (FIPS-197 order, as AES-NI takes them)
+  const uint8_t* roundKeys() const { return rk_; }
+
+  static uint8_t sbox(uint8_t x) {
+    static const uint8_t table[256] = {
+        0x63, 0x7c, 0x77, 0x7b, 0xf2, 0x6b, 0x6f, 0xc5, 0x30, 0x01, 0x67, 0x2b, 0xfe, 0xd7, 0xab, 0x76,
+        0xca, 0x82, 0xc9, 0x7d, 0xfa, 0x59, 0x47, 0xf0, 0xad, 0xd4, 0xa2, 0xaf, 0x9c, 0xa4, 0x72, 0xc0,
+        0xb7, 0xfd, 0x93, 0x26, 0x36, 0x3f, 0xf7, 0xcc, 0x34, 0xa5, 0xe5, 0xf1, 0x71, 0xd8, 0x31, 0x15,
+        0x04, 0xc7, 0x23, 0xc3, 0x18, 0x96, 0x05, 0x9a, 0x07, 0x12, 0x80, 0xe2, 0xeb, 0x27, 0xb2, 0x75,
+        0x09, 0x83, 0x2c, 0x1a, 0x1b, 0x6e, 0x5a, 0xa0, 0x52, 0x3b, 0xd6, 0xb3, 0x29, 0xe3, 0x2f, 0x84,
+        0x53, 0xd1, 0x00, 0xed, 0x20, 0xfc, 0xb1, 0x5b, 0x6a, 0xcb, 0xbe, 0x39, 0x4a, 0x4c, 0x58, 0xcf,
+        0xd0, 0xef, 0xaa, 0xfb, 0x43, 0x4d, 0x33, 0x85, 0x45, 0xf9, 0x02, 0x7f, 0x50, 0x3c, 0x9f, 0xa8,
+        0x51, 0xa3, 0x40, 0x8f, 0x92, 0x9d, 0x38, 0xf5, 0xbc, 0xb6, 0xda, 0x21, 0x10, 0xff, 0xf3, 0xd2,
+        0xcd, 0x0c, 0x13, 0xec, 0x5f, 0x97, 0x44, 0x17, 0xc4, 0xa7, 0x7e, 0x3d, 0x64, 0x5d, 0x19, 0x73,
+        0x60, 0x81, 0x4f, 0xdc, 0x22, 0x2a, 0x90, 0x88, 0x46, 0xee, 0xb8, 0x14, 0xde, 0x5e, 0x0b, 0xdb,
+        0xe0, 0x32, 0x3a, 0x0a, 0x49, 0x06, 0x24, 0x5c, 0xc2, 0xd3, 0xac, 0x62, 0x91, 0x95, 0xe4, 0x79,
+        0xe7, 0xc8, 0x37, 0x6d, 0x8d, 0xd5, 0x4e, 0xa9, 0x6c, 0x56, 0xf4, 0xea, 0x65, 0x7a, 0xae, 0x08,
+        0xba, 0x78, 0x25, 0x2e, 0x1c, 0xa6, 0xb4, 0xc6, 0xe8, 0xdd, 0x74, 0x1f, 0x4b, 0xbd, 0x8b, 0x8a,
+        0x70, 0x3e, 0xb5, 0x66, 0x48, 0x03, 0xf6, 0x0e, 0x61, 0x35, 0x57, 0xb9, 0x86, 0xc1, 0x1d, 0x9e,
+        0xe1, 0xf8, 0x98, 0x11, 0x69, 0xd9, 0x8e, 0x94, 0x9b, 0x1e, 0x87, 0xe9, 0xce, 0x55, 0x28, 0xdf,
+        0x8c, 0xa1, 0x89, 0x0d, 0xbf, 0xe6, 0x42, 0x68, 0x41, 0x99, 0x2d, 0x0f, 0xb0, 0x54, 0xbb, 0x16};
+    return table[x];
+  }
+
+ private:
+  uint8_t rk_[176];
+
+  void addRoundKey(uint8_t s[16], unsigned round) const {
+    for (unsigned i = 0; i < 16; i++) {
+      s[i] ^= rk_[round * 16 + i];
+    }
+  }
+
+  // SubBytes and ShiftRows, state is column-major
+  static void subShift(uint8_t s[16]) {
+    uint8_t t[16];
+    for (unsigned c = 0; c < 4; c++) {
+      for (unsigned r = 0; r < 4; r++) {
+        t[c * 4 + r] = sbox(s[((c + r) % 4) * 4 + r]);
+      }
+    }
+    std::memcpy(s, t, 16);
+  }
+
+  static uint8_t xtime(uint8_t x) { return static_cast<uint8_t>((x << 1) ^ ((x & 0x80) ? 0x1b : 0)); }
+
+  static void mixColumns(uint8_t s[16]) {
+    for (unsigned c = 0; c < 4; c++) {
+      uint8_t* a = &s[c * 4];
+      uint8_t all = a[0] ^ a[1] ^ a[2] ^ a[3];
+      uint8_t a0 = a[0];
+      a[0] ^= all ^ xtime(a[0] ^ a[1]);
+      a[1] ^= all ^ xtime(a[1] ^ a[2]);
+      a[2] ^= all ^ xtime(a[2] ^ a[3]);
+      a[3] ^= all ^ xtime(a[3] ^ a0);
+    }
+  }
+};
+
+// Nonce: device address as in AdvA (LSB first) | counter (big endian) | 0 0 0
+inline void nonce(const uint8_t adva[6], uint32_t counter, uint8_t out[kNonceLen]) {
+  std::memcpy(out, adva, 6);
+  out[6] = static_cast<uint8_t>(counter >> 24);
+  out[7] = static_cast<uint8_t>(counter >> 16);
+  out[8] = static_cast<uint8_t>(counter >> 8);
+  out[9] = static_cast<uint8_t>(counter);
+  out[10] = out[11] = out[12] = 0;
+}
+
+// CCM MIC without payload (M = 4, L = 2): CBC-MAC over B0 and the length-prefixed
+// additional data, encrypted with counter block A0
+inline void ccmMic(const Aes128& aes, const uint8_t n[kNonceLen], const uint8_t* aad, std::size_t aadLen,
+                   uint8_t mic[kMicLen]) {
+  uint8_t x[16], a[16];
+
+  x[0] = 0x40 | (((kMicLen - 2) / 2) << 3) | (2 - 1);
+  std::memcpy(&x[1], n, kNonceLen);
+  x[14] = x[15] = 0;
+  aes.encrypt(x);
+
+  x[0] ^= static_cast<uint8_t>(aadLen >> 8);
+  x[1] ^= static_cast<uint8_t>(aadLen);
+  std::size_t pos = 2;
+  for (std::size_t i = 0; i < aadLen; i++) {
+    x[pos++] ^= aad[i];
+    if (pos == 16) {
+      aes.encrypt(x);
+      pos = 0;
+    }
+  }
+  if (pos != 0) {
+    aes.encrypt(x);
+  }
+
+  a[0] = 2 - 1;
+  std::memcpy(&a[1], n, kNonceLen);
+  a[14] = a[15] = 0;
+  aes.encrypt(a);
+  for (std::size_t i = 0; i < kMicLen; i++) {
+    mic[i] = x[i] ^ a[i];
+  }
+}
+
+struct Device {
+  Aes128 aes;
+  uint32_t lastCounter = 0;  // last accepted, 0 = provisioned, nothing received yet
+
+  explicit Device(const uint8_t key[kKeyLen]) : aes(key) {}
+};
+
+enum class Status { kOk, kMalformed, kBadMic, kReplay };
+
+struct Result {
+  Status status;
+  uint32_t counter;   // nonce counter of the frame (kOk, kReplay)
+  std::size_t len;    // length of the unsealed frame (kOk)
+};
+
+namespace detail {
+
+// verify() over epochs first .. first + epochs - 1
+inline Result verifyEpochs(Device& dev, const uint8_t adva[6], uint8_t* frame, std::size_t len, uint32_t first,
+                           uint32_t epochs) {
+  if (len < 2 + kTrailerLen || static_cast<std::size_t>(frame[0]) + 1 != len) {
+    return Result{Status::kMalformed, 0, 0};
+  }
+  const std::size_t aadLen = len - kMicLen;
+  const uint8_t* mic = &frame[aadLen];
+  const uint32_t low = static_cast<uint32_t>((frame[aadLen - 2] << 8) | frame[aadLen - 1]);
+  uint8_t n[kNonceLen], m[kMicLen];
+
+  auto matches = [&](uint32_t counter) {
+    nonce(adva, counter, n);
+    ccmMic(dev.aes, n, frame, aadLen, m);
+    return std::memcmp(m, mic, kMicLen) == 0;
+  };
+
+  for (uint32_t e = 0; e < epochs; e++) {
+    const uint32_t counter = ((first + e) << 16) | low;
+    if (!matches(counter)) {
+      continue;
+    }
+    if (counter <= dev.lastCounter) {
+      return Result{Status::kReplay, counter, 0};
+    }
+    dev.lastCounter = counter;
+    frame[0] = static_cast<uint8_t>(frame[0] - kTrailerLen);
+    return Result{Status::kOk, counter, len - kTrailerLen};
+  }
+  return Result{Status::kBadMic, 0, 0};
+}
+
+}  // namespace detail
+
+// Check one sealed AD structure (frame[0] = AD length) from the bike with address adva.
+// kOk: lastCounter advances and frame[0] is restored, frame/len can go to the payload::
+// decoders unchanged
+inline Result verify(Device& dev, const uint8_t adva[6], uint8_t* frame, std::size_t len) {
+  return detail::verifyEpochs(dev, adva, frame, len, dev.lastCounter >> 16, kEpochSearch + 1);
+}
+
+// verify() in the given epoch only (epoch field of the diagnostics frame, see above).
+// Same results; an epoch at or below the current one gives kReplay or kBadMic
+inline Result resync(Device& dev, const uint8_t adva[6], uint8_t* frame, std::size_t len, uint32_t epoch) {
+  return detail::verifyEpochs(dev, adva, frame, len, epoch, 1);
+}
+
+}  // namespace auth
+
+#endif  // AUTH_HPP_
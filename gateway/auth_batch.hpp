@@ -0,0 +1,329 @@
+// auth_batch.hpp
+//
+// Batch verification of sealed adverts (auth.hpp) for gateways that hear the whole
+// fleet. Frames are bucketed by device (key), the CCM MICs of a bucket are computed
+// kLanes frames at a time: each CBC-MAC step encrypts one block of every lane with
+// interleaved AES-NI rounds, so the lanes hide the aesenc latency. CPUs without AES-NI
+// (or Engine::kPortable) run auth::Aes128 over the same lanes.
+//
+// verifyBatch() leaves the same results and Device state as auth::verify() called frame
+// by frame in arrival order: a MIC is precomputed for the device's epoch at batch start,
+// frames that miss it (later epoch, forgery) or whose device changed epoch within the
+// batch repeat the epoch search of auth::verify(), kLanes epochs per step.
+// Frames still kBadMic go to auth::resync() one by one (diagnostics frames, auth.hpp).
+//
+// cmacBatch(): AES-CMAC (RFC 4493) of many messages under one key, same output as
+// aes128Cmac() in the firmware (aes128.c).
+//
+// AES-NI code is compiled per function (target attribute), no -maes needed; bench and
+// byte check against the firmware in auth_bench.cpp.
+
+#ifndef AUTH_BATCH_HPP_
+#define AUTH_BATCH_HPP_
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include "auth.hpp"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define AUTH_BATCH_AESNI 1
+#else
+#define AUTH_BATCH_AESNI 0
+#endif
+
+namespace auth {
+
+constexpr std::size_t kLanes = 8;
+
+enum class Engine { kAuto, kPortable, kAesNi };
+
+// One sealed frame of a batch, result filled in by verifyBatch()
+struct Packet {
+  Device* dev;
+  const uint8_t* adva;  // 6 bytes, as in AdvA
+  uint8_t* frame;
+  std::size_t len;
+  Result result;
+};
+
+namespace detail {
+
+using Block = uint8_t[16];
+
+inline bool haveAesNi() {
+#if AUTH_BATCH_AESNI
+  static const bool ok = __builtin_cpu_supports("aes");
+  return ok;
+#else
+  return false;
+#endif
+}
+
+#if AUTH_BATCH_AESNI
+// Encrypt n blocks in place, kLanes at a time with the rounds interleaved across blocks
+__attribute__((target("aes,sse2"))) inline void encryptNi(const uint8_t* roundKeys, Block* b, std::size_t n) {
+  __m128i k[11];
+  for (unsigned r = 0; r < 11; r++) {
+    k[r] = _mm_loadu_si128(reinterpret_cast<const __m128i*>(roundKeys + 16 * r));
+  }
+  for (std::size_t i = 0; i < n; i += kLanes) {
+    const std::size_t m = std::min(kLanes, n - i);
+    __m128i s[kLanes];
+    for (std::size_t j = 0; j < m; j++) {
+      s[j] = _mm_xor_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(b[i + j])), k[0]);
+    }
+    for (unsigned r = 1; r < 10; r++) {
+      for (std::size_t j = 0; j < m; j++) {
+        s[j] = _mm_aesenc_si128(s[j], k[r]);
+      }
+    }
+    for (std::size_t j = 0; j < m; j++) {
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(b[i + j]), _mm_aesenclast_si128(s[j], k[10]));
+    }
+  }
+}
+#endif
+
+inline void encryptBlocks(const Aes128& aes, Block* b, std::size_t n, bool ni) {
+#if AUTH_BATCH_AESNI
+  if (ni) {
+    encryptNi(aes.roundKeys(), b, n);
+    return;
+  }
+#else
+  (void)ni;
+#endif
+  for (std::size_t i = 0; i < n; i++) {
+    aes.encrypt(b[i]);
+  }
+}
+
+inline bool useAesNi(Engine engine) {
+  return engine == Engine::kAesNi || (engine == Engine::kAuto && haveAesNi());
+}
+
+// CBC-MAC over up to kLanes messages at once. steps[l] blocks per lane, next(l, s, in)
+// gives block s of lane l; x[l] holds the IV on entry, the MAC on return
+template <class Next>
+void cbcMacLanes(const Aes128& aes, Block* x, const std::size_t* steps, std::size_t lanes, Next next, bool ni) {
+  Block work[kLanes], in;
+  std::size_t active[kLanes];
+  const std::size_t maxSteps = *std::max_element(steps, steps + lanes);
+
+  for (std::size_t s = 0; s < maxSteps; s++) {
+    std::size_t n = 0;
+    for (std::size_t l = 0; l < lanes; l++) {
+      if (s < steps[l]) {
+        next(l, s, in);
+        for (unsigned i = 0; i < 16; i++) {
+          work[n][i] = x[l][i] ^ in[i];
+        }
+        active[n++] = l;
+      }
+    }
+    encryptBlocks(aes, work, n, ni);
+    for (std::size_t j = 0; j < n; j++) {
+      std::memcpy(x[active[j]], work[j], 16);
+    }
+  }
+}
+
+// CCM MICs (auth.hpp format: M = kMicLen, L = 2, no payload) of up to kLanes frames,
+// counters[l] is the nonce counter to try for frame l
+inline void ccmMicLanes(const Aes128& aes, const Packet* const* pkts, const uint32_t* counters, std::size_t lanes,
+                        uint8_t (*mic)[kMicLen], bool ni) {
+  Block x[kLanes], blocks[2 * kLanes];
+  std::size_t steps[kLanes] = {0};
+  uint8_t n[kNonceLen];
+
+  // B0 and A0 of every lane in one call
+  for (std::size_t l = 0; l < lanes; l++) {
+    nonce(pkts[l]->adva, counters[l], n);
+    blocks[l][0] = 0x40 | (((kMicLen - 2) / 2) << 3) | (2 - 1);
+    std::memcpy(&blocks[l][1], n, kNonceLen);
+    blocks[l][14] = blocks[l][15] = 0;
+    blocks[kLanes + l][0] = 2 - 1;
+    std::memcpy(&blocks[kLanes + l][1], n, kNonceLen);
+    blocks[kLanes + l][14] = blocks[kLanes + l][15] = 0;
+  }
+  if (lanes < kLanes) {
+    std::memmove(blocks[lanes], blocks[kLanes], lanes * 16);
+  }
+  encryptBlocks(aes, blocks, 2 * lanes, ni);
+
+  // additional data: 2 byte length, frame without the MIC, zero padded
+  for (std::size_t l = 0; l < lanes; l++) {
+    std::memcpy(x[l], blocks[l], 16);
+    steps[l] = (2 + pkts[l]->len - kMicLen + 15) / 16;
+  }
+  cbcMacLanes(aes, x, steps, lanes,
+              [&](std::size_t l, std::size_t s, Block in) {
+                const uint8_t* aad = pkts[l]->frame;
+                const std::size_t aadLen = pkts[l]->len - kMicLen;
+                for (unsigned i = 0; i < 16; i++) {
+                  const std::size_t p = s * 16 + i;  // position in length || aad
+                  in[i] = p == 0 ? static_cast<uint8_t>(aadLen >> 8)
+                        : p == 1 ? static_cast<uint8_t>(aadLen)
+                        : p - 2 < aadLen ? aad[p - 2] : 0;
+                }
+              },
+              ni);
+
+  for (std::size_t l = 0; l < lanes; l++) {
+    for (std::size_t i = 0; i < kMicLen; i++) {
+      mic[l][i] = x[l][i] ^ blocks[lanes + l][i];
+    }
+  }
+}
+
+// auth::verify() with the epoch search kLanes counters at a time
+inline Result verifyLanes(Device& dev, const Packet& p, bool ni) {
+  const std::size_t aadLen = p.len - kMicLen;
+  const uint32_t low = static_cast<uint32_t>((p.frame[aadLen - 2] << 8) | p.frame[aadLen - 1]);
+  const uint32_t epoch = dev.lastCounter >> 16;
+  const Packet* lane[kLanes];
+  uint32_t counters[kLanes];
+  uint8_t mics[kLanes][kMicLen];
+
+  for (std::size_t l = 0; l < kLanes; l++) {
+    lane[l] = &p;
+  }
+  for (uint32_t e = 0; e <= kEpochSearch; e += kLanes) {
+    const std::size_t lanes = std::min<std::size_t>(kLanes, kEpochSearch + 1 - e);
+    for (std::size_t l = 0; l < lanes; l++) {
+      counters[l] = ((epoch + e + static_cast<uint32_t>(l)) << 16) | low;
+    }
+    ccmMicLanes(dev.aes, lane, counters, lanes, mics, ni);
+    for (std::size_t l = 0; l < lanes; l++) {
+      if (std::memcmp(mics[l], &p.frame[aadLen], kMicLen) != 0) {
+        continue;
+      }
+      if (counters[l] <= dev.lastCounter) {
+        return Result{Status::kReplay, counters[l], 0};
+      }
+      dev.lastCounter = counters[l];
+      p.frame[0] = static_cast<uint8_t>(p.frame[0] - kTrailerLen);
+      return Result{Status::kOk, counters[l], p.len - kTrailerLen};
+    }
+  }
+  return Result{Status::kBadMic, 0, 0};
+}
+
+}  // namespace detail
+
+// Verify n frames. Same results and Device state as auth::verify() on each frame in order
+inline void verifyBatch(Packet* pkts, std::size_t n, Engine engine = Engine::kAuto) {
+  const bool ni = detail::useAesNi(engine);
+  std::vector<std::size_t> order;
+
+  order.reserve(n);
+  for (std::size_t i = 0; i < n; i++) {
+    Packet& p = pkts[i];
+    if (p.len < 2 + kTrailerLen || static_cast<std::size_t>(p.frame[0]) + 1 != p.len) {
+      p.result = Result{Status::kMalformed, 0, 0};
+    } else {
+      order.push_back(i);
+    }
+  }
+  // bucket by device, arrival order within a bucket
+  std::stable_sort(order.begin(), order.end(),
+                   [&](std::size_t a, std::size_t b) { return pkts[a].dev < pkts[b].dev; });
+
+  for (std::size_t first = 0; first < order.size();) {
+    Device& dev = *pkts[order[first]].dev;
+    std::size_t last = first;
+    while (last < order.size() && pkts[order[last]].dev == &dev) {
+      last++;
+    }
+
+    // MICs for the epoch at batch start
+    const uint32_t epoch = dev.lastCounter >> 16;
+    const std::size_t count = last - first;
+    std::vector<uint32_t> counters(count);
+    std::vector<std::array<uint8_t, kMicLen>> mics(count);
+    for (std::size_t g = 0; g < count; g += kLanes) {
+      const Packet* lane[kLanes];
+      const std::size_t lanes = std::min(kLanes, count - g);
+      for (std::size_t l = 0; l < lanes; l++) {
+        const Packet& p = pkts[order[first + g + l]];
+        const std::size_t aadLen = p.len - kMicLen;
+        lane[l] = &p;
+        counters[g + l] = (epoch << 16) | static_cast<uint32_t>((p.frame[aadLen - 2] << 8) | p.frame[aadLen - 1]);
+      }
+      detail::ccmMicLanes(dev.aes, lane, &counters[g], lanes,
+                          reinterpret_cast<uint8_t(*)[kMicLen]>(mics[g].data()), ni);
+    }
+
+    // replay check in arrival order, as verify() does for a match at the current epoch
+    for (std::size_t j = 0; j < count; j++) {
+      Packet& p = pkts[order[first + j]];
+      if ((dev.lastCounter >> 16) != epoch || std::memcmp(mics[j].data(), &p.frame[p.len - kMicLen], kMicLen) != 0) {
+        p.result = detail::verifyLanes(dev, p, ni);
+      } else if (counters[j] <= dev.lastCounter) {
+        p.result = Result{Status::kReplay, counters[j], 0};
+      } else {
+        dev.lastCounter = counters[j];
+        p.frame[0] = static_cast<uint8_t>(p.frame[0] - kTrailerLen);
+        p.result = Result{Status::kOk, counters[j], p.len - kTrailerLen};
+      }
+    }
+    first = last;
+  }
+}
+
+// AES-CMAC (RFC 4493) of n messages under one key, full 16 byte tags
+inline void cmacBatch(const Aes128& aes, const uint8_t* const* msgs, const std::size_t* lens, std::size_t n,
+                      uint8_t (*macs)[16], Engine engine = Engine::kAuto) {
+  const bool ni = detail::useAesNi(engine);
+  detail::Block k1 = {0}, k2;
+  auto subkey = [](const uint8_t* in, uint8_t* out) {
+    const uint8_t carry = in[0] & 0x80;
+    for (unsigned i = 0; i < 15; i++) {
+      out[i] = static_cast<uint8_t>((in[i] << 1) | (in[i + 1] >> 7));
+    }
+    out[15] = static_cast<uint8_t>((in[15] << 1) ^ (carry ? 0x87 : 0));
+  };
+  aes.encrypt(k1);
+  subkey(k1, k1);
+  subkey(k1, k2);
+
+  for (std::size_t g = 0; g < n; g += kLanes) {
+    const std::size_t lanes = std::min(kLanes, n - g);
+    detail::Block x[kLanes];
+    std::size_t steps[kLanes];
+    for (std::size_t l = 0; l < lanes; l++) {
+      std::memset(x[l], 0, 16);
+      steps[l] = lens[g + l] == 0 ? 1 : (lens[g + l] + 15) / 16;
+    }
+    detail::cbcMacLanes(aes, x, steps, lanes,
+                        [&](std::size_t l, std::size_t s, detail::Block in) {
+                          const uint8_t* m = msgs[g + l];
+                          const std::size_t len = lens[g + l];
+                          const bool lastBlock = s + 1 == steps[l];
+                          for (unsigned i = 0; i < 16; i++) {
+                            const std::size_t p = s * 16 + i;
+                            in[i] = p < len ? m[p] : p == len ? 0x80 : 0;
+                          }
+                          if (lastBlock) {
+                            const uint8_t* k = len != 0 && len % 16 == 0 ? k1 : k2;
+                            for (unsigned i = 0; i < 16; i++) {
+                              in[i] ^= k[i];
+                            }
+                          }
+                        },
+                        ni);
+    for (std::size_t l = 0; l < lanes; l++) {
+      std::memcpy(macs[g + l], x[l], 16);
+    }
+  }
+}
+
+}  // namespace auth
+
+#endif  // AUTH_BATCH_HPP_
@@ -0,0 +1,282 @@
+// auth_bench.cpp
+//
+// Gateway verification throughput of sealed adverts (AUTH_PAYLOAD), one core:
+// auth::verify() frame by frame against auth::verifyBatch() (auth_batch.hpp) with the
+// portable AES and with AES-NI, in packets per second.
+//
+// Frames are sealed with the firmware code (aes128.c, AES128_SOFT = ROM results) for
+// a fleet of devices, interleaved as a gateway hears them, with replays, forgeries and
+// devices that come back in a later epoch. Before timing, every engine has to give the
+// same results and device state as auth::verify(), and cmacBatch() the same tags as
+// aes128Cmac(). A device back after more than kEpochSearch unheard power-ons has to
+// fail auth::verify() and recover with auth::resync() from its diagnostics frame.
+//
+// build: cc -c -O2 -I../ADVANCED/advanced_harvester -I../ADVANCED/advanced_harvester/cc26xxware_2_22_00_16101
+//           ../ADVANCED/advanced_harvester/aes128.c
+//        c++ -std=c++11 -O2 -I../ADVANCED/advanced_harvester -I../ADVANCED/advanced_harvester/cc26xxware_2_22_00_16101
+//            -o auth_bench auth_bench.cpp aes128.o
+// usage: auth_bench [devices, default 64] [batch, default 256]
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <vector>
+
+extern "C" {
+#include "aes128.h"
+#include "payload_advanced_diag.h"
+}
+#include "auth_batch.hpp"
+#include "payload_advanced_diag.hpp"
+
+namespace {
+
+constexpr std::size_t kFrames = 1 << 16;
+constexpr std::size_t kMaxFrame = 31;
+
+struct Fleet {
+  std::vector<std::vector<uint8_t>> keys;
+  std::vector<std::vector<uint8_t>> addrs;
+  std::vector<auth::Device> devices;   // state before the first frame
+};
+
+struct Frame {
+  std::size_t dev;
+  uint8_t data[kMaxFrame];
+  std::size_t len;
+};
+
+// authSeal() of the firmware on a frame of len bytes (data[0] is set here)
+std::size_t seal(const aes128_key_t& k, const uint8_t adva[6], uint32_t counter, uint8_t* frame, std::size_t len) {
+  uint8_t n[AES128_CCM_NONCE_LEN];
+  frame[0] = static_cast<uint8_t>(len + auth::kTrailerLen - 1);
+  frame[len] = static_cast<uint8_t>(counter >> 8);
+  frame[len + 1] = static_cast<uint8_t>(counter);
+  auth::nonce(adva, counter, n);
+  aes128CcmMic(&k, n, frame, static_cast<uint8_t>(len + auth::kCtrLen), &frame[len + auth::kCtrLen],
+               static_cast<uint8_t>(auth::kMicLen));
+  return len + auth::kTrailerLen;
+}
+
+std::vector<Frame> traffic(Fleet& fleet, std::size_t devices, std::mt19937& rng) {
+  std::vector<aes128_key_t> records(devices);
+  std::vector<uint32_t> counter(devices);
+  std::uniform_int_distribution<int> byte(0, 255);
+  std::uniform_int_distribution<std::size_t> pick(0, devices - 1);
+  std::uniform_int_distribution<std::size_t> length(8, kMaxFrame - auth::kTrailerLen);
+  std::uniform_int_distribution<int> event(0, 999);
+
+  for (std::size_t d = 0; d < devices; d++) {
+    std::vector<uint8_t> key(auth::kKeyLen), addr(6);
+    for (auto& b : key) b = static_cast<uint8_t>(byte(rng));
+    for (auto& b : addr) b = static_cast<uint8_t>(byte(rng));
+    aes128Expand(key.data(), &records[d]);
+    fleet.keys.push_back(key);
+    fleet.addrs.push_back(addr);
+    fleet.devices.emplace_back(key.data());
+    counter[d] = 1u << 16;
+    fleet.devices.back().lastCounter = counter[d] - 1;
+  }
+
+  std::vector<Frame> frames;
+  frames.reserve(kFrames);
+  while (frames.size() < kFrames) {
+    Frame f;
+    f.dev = pick(rng);
+    const int e = event(rng);
+    if (e < 5 && !frames.empty()) {  // replay of an earlier frame
+      f = frames[frames.size() - 1 - static_cast<std::size_t>(event(rng)) % frames.size()];
+      frames.push_back(f);
+      continue;
+    }
+    if (e < 7) {  // power-on the gateway did not hear
+      counter[f.dev] = ((counter[f.dev] >> 16) + 1 + static_cast<uint32_t>(e)) << 16;
+    }
+    const std::size_t len = length(rng);
+    for (std::size_t i = 1; i < len; i++) f.data[i] = static_cast<uint8_t>(byte(rng));
+    f.len = seal(records[f.dev], fleet.addrs[f.dev].data(), counter[f.dev]++, f.data, len);
+    if (e < 10) {  // forgery
+      f.data[1 + static_cast<std::size_t>(e) % (f.len - 1)] ^= 0x01;
+    }
+    frames.push_back(f);
+  }
+  return frames;
+}
+
+using Clock = std::chrono::steady_clock;
+
+// Verify all frames in batches of batch, returns packets/s; results and device state
+// after the run in results/devices
+double run(const Fleet& fleet, const std::vector<Frame>& frames, std::size_t batch, int engine,
+           std::vector<auth::Result>& results, std::vector<auth::Device>& devices) {
+  std::vector<Frame> work(frames);
+  std::vector<auth::Packet> pkts(batch);
+  double seconds = 0;
+
+  devices = fleet.devices;
+  results.resize(frames.size());
+  for (std::size_t first = 0; first < work.size(); first += batch) {
+    const std::size_t n = std::min(batch, work.size() - first);
+    for (std::size_t i = 0; i < n; i++) {
+      Frame& f = work[first + i];
+      pkts[i] = auth::Packet{&devices[f.dev], fleet.addrs[f.dev].data(), f.data, f.len, auth::Result{}};
+    }
+    const auto start = Clock::now();
+    if (engine < 0) {
+      for (std::size_t i = 0; i < n; i++) {
+        pkts[i].result = auth::verify(*pkts[i].dev, pkts[i].adva, pkts[i].frame, pkts[i].len);
+      }
+    } else {
+      auth::verifyBatch(pkts.data(), n, engine ? auth::Engine::kAesNi : auth::Engine::kPortable);
+    }
+    seconds += std::chrono::duration<double>(Clock::now() - start).count();
+    for (std::size_t i = 0; i < n; i++) {
+      results[first + i] = pkts[i].result;
+    }
+  }
+  return static_cast<double>(frames.size()) / seconds;
+}
+
+bool same(const std::vector<auth::Result>& a, const std::vector<auth::Result>& b) {
+  for (std::size_t i = 0; i < a.size(); i++) {
+    if (a[i].status != b[i].status || a[i].counter != b[i].counter || a[i].len != b[i].len) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// cmacBatch() against the firmware aes128Cmac(), 0..64 byte messages
+bool checkCmac(std::mt19937& rng, bool aesNi) {
+  std::uniform_int_distribution<int> byte(0, 255);
+  uint8_t key[auth::kKeyLen];
+  aes128_key_t record;
+  for (auto& b : key) b = static_cast<uint8_t>(byte(rng));
+  aes128Expand(key, &record);
+  auth::Aes128 aes(key);
+
+  std::vector<std::vector<uint8_t>> msgs;
+  std::vector<const uint8_t*> ptrs;
+  std::vector<std::size_t> lens;
+  for (std::size_t len = 0; len <= 64; len++) {
+    std::vector<uint8_t> m(len);
+    for (auto& b : m) b = static_cast<uint8_t>(byte(rng));
+    msgs.push_back(m);
+  }
+  for (const auto& m : msgs) {
+    ptrs.push_back(m.data());
+    lens.push_back(m.size());
+  }
+  std::vector<uint8_t> macs(16 * msgs.size());
+  auth::cmacBatch(aes, ptrs.data(), lens.data(), msgs.size(), reinterpret_cast<uint8_t(*)[16]>(macs.data()),
+                  aesNi ? auth::Engine::kAesNi : auth::Engine::kPortable);
+
+  for (std::size_t i = 0; i < msgs.size(); i++) {
+    uint8_t mac[16];
+    aes128Cmac(&record, msgs[i].data(), static_cast<uint8_t>(lens[i]), mac, 16);
+    if (std::memcmp(mac, &macs[16 * i], 16) != 0) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Device last heard in epoch 1, back in an epoch beyond the search: the diagnostics
+// frame (first after reset) fails verify(), resync() with its epoch field accepts it and
+// the data frames after it verify again. Replays and a wrong epoch stay rejected
+bool checkResync(std::mt19937& rng) {
+  std::uniform_int_distribution<int> byte(0, 255);
+  uint8_t key[auth::kKeyLen], adva[6], diag[kMaxFrame], data[kMaxFrame], copy[kMaxFrame];
+  aes128_key_t record;
+  for (auto& b : key) b = static_cast<uint8_t>(byte(rng));
+  for (auto& b : adva) b = static_cast<uint8_t>(byte(rng));
+  aes128Expand(key, &record);
+  auth::Device dev(key);
+  dev.lastCounter = (1u << 16) | 7;
+
+  const uint32_t epoch = 1 + auth::kEpochSearch + 5;
+  payloadAdvancedDiag_t d;
+  std::memset(&d, 0, sizeof(d));
+  d.epoch = static_cast<uint16_t>(epoch);
+  d.wakes = 1;
+  payloadAdvancedDiagEncode(diag, &d);
+  const std::size_t diagLen = seal(record, adva, epoch << 16, diag, PAYLOAD_ADVANCED_DIAG_LEN);
+  for (std::size_t i = 1; i < 20; i++) data[i] = static_cast<uint8_t>(byte(rng));
+  const std::size_t dataLen = seal(record, adva, (epoch << 16) | 1, data, 20);
+
+  bool ok = true;
+  std::memcpy(copy, diag, diagLen);
+  ok &= auth::verify(dev, adva, copy, diagLen).status == auth::Status::kBadMic;
+
+  // epoch field of the frame that failed
+  payload::AdvancedDiag fields{};
+  std::memcpy(copy, diag, diagLen);
+  copy[0] = static_cast<uint8_t>(copy[0] - auth::kTrailerLen);
+  ok &= payload::AdvancedDiag::decode(copy, diagLen - auth::kTrailerLen, fields) && fields.epoch == epoch;
+
+  std::memcpy(copy, diag, diagLen);
+  ok &= auth::resync(dev, adva, copy, diagLen, epoch - 1).status == auth::Status::kBadMic;
+  std::memcpy(copy, diag, diagLen);
+  ok &= auth::resync(dev, adva, copy, diagLen, fields.epoch).status == auth::Status::kOk;
+  ok &= dev.lastCounter == epoch << 16;
+  std::memcpy(copy, diag, diagLen);
+  ok &= auth::resync(dev, adva, copy, diagLen, fields.epoch).status == auth::Status::kReplay;
+  ok &= auth::verify(dev, adva, data, dataLen).status == auth::Status::kOk;
+  return ok;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  const std::size_t devices = (argc > 1) ? static_cast<std::size_t>(std::atoi(argv[1])) : 64;
+  const std::size_t batch = (argc > 2) ? static_cast<std::size_t>(std::atoi(argv[2])) : 256;
+  const bool aesNi = auth::detail::haveAesNi();
+  std::mt19937 rng(1234);
+  Fleet fleet;
+  const std::vector<Frame> frames = traffic(fleet, devices, rng);
+  bool ok = true;
+
+  std::vector<auth::Result> ref, res;
+  std::vector<auth::Device> refDev, dev;
+  const char* names[] = {"verify", "batch portable", "batch AES-NI"};
+  double pps[3];
+
+  pps[0] = run(fleet, frames, batch, -1, ref, refDev);
+  for (int engine = 0; engine <= 1; engine++) {
+    if (engine == 1 && !aesNi) {
+      pps[2] = 0;
+      continue;
+    }
+    pps[1 + engine] = run(fleet, frames, batch, engine, res, dev);
+    bool match = same(ref, res);
+    for (std::size_t d = 0; d < devices; d++) {
+      match &= dev[d].lastCounter == refDev[d].lastCounter;
+    }
+    match &= checkCmac(rng, engine == 1);
+    if (!match) {
+      std::printf("%s: results differ from auth::verify / aes128Cmac\n", names[1 + engine]);
+      ok = false;
+    }
+  }
+
+  if (!checkResync(rng)) {
+    std::printf("resync: device beyond the epoch search not recovered\n");
+    ok = false;
+  }
+
+  std::size_t accepted = 0;
+  for (const auto& r : ref) {
+    accepted += r.status == auth::Status::kOk;
+  }
+  std::printf("%zu frames, %zu devices, batch %zu, %zu accepted\n", frames.size(), devices, batch, accepted);
+  for (int i = 0; i < 3; i++) {
+    if (i == 2 && !aesNi) {
+      std::printf("%-15s  no AES-NI on this CPU\n", names[i]);
+    } else {
+      std::printf("%-15s  %10.0f packets/s  x%.1f\n", names[i], pps[i], pps[i] / pps[0]);
+    }
+  }
+  return ok ? 0 : 1;
+}
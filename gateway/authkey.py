@@ -0,0 +1,82 @@
+#!/usr/bin/env python3
+"""
+authkey.py
+
+Key provisioning for the payload authentication (AUTH_PAYLOAD, see
+ADVANCED/advanced_harvester/auth.h). For one bike:
+  - a new random AES-128 key (secrets module)
+  - an Intel HEX file with the key at the start of the auth page
+    (AUTH_PAGE_BASE), to be programmed after the firmware image
+  - a line "<address> <key>" in the gateway key file (auth.hpp)
+
+usage: authkey.py <address> --hex <out.hex> [--keys <file>] [--replace]
+
+The address is the BLE device address in the usual notation, most
+significant byte first (AA:BB:CC:DD:EE:FF, FCFG1 MAC_BLE_0 of the bike).
+A key is never written twice: an address already in the key file needs
+--replace, and then the page has to be erased before the new key goes in.
+"""
+
+import argparse
+import os
+import re
+import secrets
+import sys
+
+AUTH_PAGE_BASE = 0x0001E000     # auth.h
+KEY_LEN = 16
+ADDRESS = re.compile(r"^([0-9A-F]{2}:){5}[0-9A-F]{2}$")
+
+
+def hex_record(rtype, offset, data):
+    rec = bytes([len(data), offset >> 8, offset & 0xFF, rtype]) + data
+    return ":%s%02X" % (rec.hex().upper(), -sum(rec) & 0xFF)
+
+
+def gen_hex(key):
+    L = []
+    L.append(hex_record(0x04, 0, bytes([AUTH_PAGE_BASE >> 24, (AUTH_PAGE_BASE >> 16) & 0xFF])))
+    L.append(hex_record(0x00, AUTH_PAGE_BASE & 0xFFFF, key))
+    L.append(hex_record(0x01, 0, b""))
+    return "\n".join(L) + "\n"
+
+
+def read_keys(path):
+    try:
+        return [line.rstrip("\n") for line in open(path)]
+    except FileNotFoundError:
+        return []
+
+
+def main():
+    ap = argparse.ArgumentParser(description="per-device key for AUTH_PAYLOAD")
+    ap.add_argument("address")
+    ap.add_argument("--hex", dest="hex_out", required=True)
+    ap.add_argument("--keys", default="auth_keys.txt")
+    ap.add_argument("--replace", action="store_true")
+    args = ap.parse_args()
+
+    address = args.address.upper()
+    if not ADDRESS.match(address):
+        sys.exit("%s: not a device address (AA:BB:CC:DD:EE:FF)" % args.address)
+
+    lines = read_keys(args.keys)
+    known = [l for l in lines if l.split()[:1] == [address]]
+    if known and not args.replace:
+        sys.exit("%s: already in %s, --replace after a page erase only" % (address, args.keys))
+    lines = [l for l in lines if l not in known]
+
+    # all 0xFF reads as an erased page on the bike (authInit() leaves frames unsealed)
+    key = secrets.token_bytes(KEY_LEN)
+    while key == b"\xff" * KEY_LEN:
+        key = secrets.token_bytes(KEY_LEN)
+
+    open(args.hex_out, "w").write(gen_hex(key))
+    lines.append("%s %s" % (address, key.hex()))
+    # the key file is as secret as the keys: owner only
+    with os.fdopen(os.open(args.keys, os.O_WRONLY | os.O_CREAT | os.O_TRUNC, 0o600), "w") as f:
+        f.write("\n".join(lines) + "\n")
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,98 @@
+// bmp280.hpp
+//
+// Gateway side BMP280 compensation for the raw sensor mode of advanced_harvester
+// (SENSOR_RAW): packets carry the 20 bit ADC words (CompactUplink::kRaw), the
+// calibration arrives in its own frame, in two parts (payload_advanced_calib.hpp,
+// payload_advanced_calib_2.hpp).
+//
+// compensate() is the Bosch 32 bit integer algorithm, bit-identical to
+// convert_bmp_280() in the firmware. compensateBatch() runs it over arrays of
+// readings (structure of arrays, no branches besides the division guard) so the
+// compiler can vectorize the temperature part and pipeline the rest.
+
+#ifndef BMP280_HPP_
+#define BMP280_HPP_
+
+#include <cstddef>
+#include <cstdint>
+
+#include "payload_advanced_calib.hpp"
+#include "payload_advanced_calib_2.hpp"
+
+namespace bmp280 {
+
+struct Calibration {
+  uint16_t t1;
+  int16_t t2, t3;
+  uint16_t p1;
+  int16_t p2, p3, p4, p5, p6, p7, p8, p9;
+
+  // both parts of one calibration frame (sent back to back)
+  static Calibration fromFrame(const payload::AdvancedCalib& f, const payload::AdvancedCalib2& g) {
+    return Calibration{f.dig_t1, static_cast<int16_t>(f.dig_t2), static_cast<int16_t>(f.dig_t3),
+                       f.dig_p1, static_cast<int16_t>(f.dig_p2), static_cast<int16_t>(f.dig_p3),
+                       static_cast<int16_t>(g.dig_p4), static_cast<int16_t>(g.dig_p5),
+                       static_cast<int16_t>(g.dig_p6), static_cast<int16_t>(g.dig_p7),
+                       static_cast<int16_t>(g.dig_p8), static_cast<int16_t>(g.dig_p9)};
+  }
+};
+
+// t_fine, shared by temperature and pressure compensation
+inline int32_t tFine(const Calibration& c, int32_t utemp) {
+  int32_t x1 = (((utemp >> 3) - (static_cast<int32_t>(c.t1) << 1)) * c.t2) >> 11;
+  int32_t x2 = (((((utemp >> 4) - static_cast<int32_t>(c.t1)) * ((utemp >> 4) - static_cast<int32_t>(c.t1))) >> 12) * c.t3) >> 14;
+  return x1 + x2;
+}
+
+// Temperature [0.01 degC]
+inline int32_t temperature(int32_t tfine) {
+  return (tfine * 5 + 128) >> 8;
+}
+
+// Pressure [Pa], 0 if the calibration is invalid (firmware keeps the old value then)
+inline uint32_t pressure(const Calibration& c, int32_t tfine, int32_t upress) {
+  int32_t x1 = (tfine >> 1) - 64000;
+  int32_t x2 = (((x1 >> 2) * (x1 >> 2)) >> 11) * c.p6;
+  x2 = x2 + ((x1 * c.p5) << 1);
+  x2 = (x2 >> 2) + (static_cast<int32_t>(c.p4) << 16);
+  x1 = (((c.p3 * (((x1 >> 2) * (x1 >> 2)) >> 13)) >> 3) + ((static_cast<int32_t>(c.p2) * x1) >> 1)) >> 18;
+  x1 = ((32768 + x1) * static_cast<int32_t>(c.p1)) >> 15;
+  if (x1 == 0) {
+    return 0;
+  }
+
+  uint32_t p = (static_cast<uint32_t>(1048576 - upress) - static_cast<uint32_t>(x2 >> 12)) * 3125;
+  if (p < 0x80000000u) {
+    p = (p << 1) / static_cast<uint32_t>(x1);
+  } else {
+    p = (p / static_cast<uint32_t>(x1)) * 2;
+  }
+
+  x1 = (static_cast<int32_t>(c.p9) * static_cast<int32_t>(((p >> 3) * (p >> 3)) >> 13)) >> 12;
+  x2 = (static_cast<int32_t>(p >> 2) * static_cast<int32_t>(c.p8)) >> 13;
+  return static_cast<uint32_t>(static_cast<int32_t>(p) + ((x1 + x2 + c.p7) >> 4));
+}
+
+inline void compensate(const Calibration& c, uint32_t utemp, uint32_t upress, int32_t& temp, uint32_t& press) {
+  int32_t tf = tFine(c, static_cast<int32_t>(utemp));
+  temp = temperature(tf);
+  press = pressure(c, tf, static_cast<int32_t>(upress));
+}
+
+// n readings of one device: temp [0.01 degC], press [Pa]
+inline void compensateBatch(const Calibration& c, const uint32_t* utemp, const uint32_t* upress,
+                            int32_t* temp, uint32_t* press, std::size_t n) {
+  for (std::size_t i = 0; i < n; i++) {
+    temp[i] = tFine(c, static_cast<int32_t>(utemp[i]));
+  }
+  for (std::size_t i = 0; i < n; i++) {
+    press[i] = pressure(c, temp[i], static_cast<int32_t>(upress[i]));
+  }
+  for (std::size_t i = 0; i < n; i++) {
+    temp[i] = temperature(temp[i]);
+  }
+}
+
+}  // namespace bmp280
+
+#endif  // BMP280_HPP_
@@ -0,0 +1,213 @@
+// compact_check.cpp
+//
+// Round trip of the compact uplink (PAYLOAD_COMPACT): readings encoded with the
+// firmware encoder (payload_compact.c) and decoded with payload::CompactUplink
+// (payload_compact.hpp), field by field against what the format can carry:
+// every presence combination, edge values (clamped pressure, temperature and
+// humidity, 5 group varints, wrapping sequence numbers), ride sections and
+// history entries, with and without room for them, raw history pressures in frames
+// without a pressure of their own (speed frames of a SENSOR_RAW build). Then a flipped bit has to
+// fail the CRC, and the body without CRC has to decode as on the proprietary link.
+//
+// build: cc -c -I../ADVANCED/advanced_harvester -I../ADVANCED/advanced_harvester/cc26xxware_2_22_00_16101
+//           ../ADVANCED/advanced_harvester/payload_compact.c
+//        c++ -std=c++11 -O2 -I../ADVANCED/advanced_harvester -I../ADVANCED/advanced_harvester/cc26xxware_2_22_00_16101
+//            -o compact_check compact_check.cpp payload_compact.o
+// usage: compact_check [random readings, default 200000]; exit code 0 if all match
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+
+extern "C" {
+#include "payload_compact.h"
+}
+#include "payload_compact.hpp"
+
+namespace {
+
+using payload::CompactUplink;
+
+// Field values as the encoder puts them on air
+uint32_t pressureSent(uint8_t flags, uint32_t pressure) {
+  if (flags & COMPACT_RAW) {
+    return pressure & 0xFFFFF;
+  }
+  uint32_t v = (pressure > COMPACT_PRESSURE_BASE) ? pressure - COMPACT_PRESSURE_BASE : 0;
+  return ((v > 0x1FFFF) ? 0x1FFFF : v) + COMPACT_PRESSURE_BASE;
+}
+
+int16_t temperatureSent(int16_t t) {
+  int32_t v = t / 10;
+  return static_cast<int16_t>(v > 2047 ? 2047 : (v < -2048 ? -2048 : v));
+}
+
+// Encode r with history, decode, compare. Returns the number of mismatching fields
+int roundTrip(const compactReading_t& in, const compactReading_t* history, uint8_t nHistory, bool verbose) {
+  compactReading_t r = in;
+  uint8_t buf[ADVLEN + 8];
+  CompactUplink out;
+  int errors = 0;
+
+  std::memset(buf, 0xA5, sizeof(buf));
+  const uint8_t len = payloadCompactEncode(buf, &r, history, nHistory);
+  auto check = [&](bool ok, const char* field) {
+    if (!ok) {
+      errors++;
+      if (verbose) {
+        std::printf("  %s differs (flags 0x%02X, %u history)\n", field, in.flags, nHistory);
+      }
+    }
+  };
+
+  check(len <= COMPACT_MAX_LEN && buf[0] + 1 == len, "length");
+  if (!CompactUplink::decode(buf, len, out)) {
+    check(false, "decode");
+    return errors;
+  }
+
+  // the encoder clears COMPACT_HAS_RIDE when the section does not fit
+  check(out.flags == r.flags && (r.flags | COMPACT_HAS_RIDE) == (in.flags | COMPACT_HAS_RIDE), "flags");
+  check(out.seq == r.seq, "seq");
+  check(out.timediff == r.timediff, "timediff");
+  check(out.pressure == ((r.flags & COMPACT_HAS_PRESSURE) ? pressureSent(r.flags, r.pressure) : 0), "pressure");
+  if ((r.flags & COMPACT_HAS_TEMPERATURE) && (r.flags & COMPACT_RAW)) {
+    check(out.rawTemperature == (r.rawTemperature & 0xFFFFF) && out.temperature == 0, "raw temperature");
+  } else {
+    check(out.temperature == ((r.flags & COMPACT_HAS_TEMPERATURE) ? temperatureSent(r.temperature) : 0), "temperature");
+  }
+  check(out.humidity == ((r.flags & COMPACT_HAS_HUMIDITY) ? (r.humidity > 1023 ? 1023 : r.humidity) : 0), "humidity");
+  if (r.flags & COMPACT_HAS_RIDE) {
+    check(out.ride.revs == r.ride.revs && out.ride.ticks == r.ride.ticks, "ride window");
+    check(out.ride.minPeriod == r.ride.minPeriod && out.ride.maxPeriod == r.ride.maxPeriod, "ride periods");
+    check(out.ride.distance == r.rideTotals.distance && out.ride.movingTime == r.rideTotals.movingTime, "ride totals");
+  }
+
+  // entries that do not fit are left out, the ones sent are the first ones
+  check(out.nHistory <= nHistory && out.nHistory <= CompactUplink::kMaxHistory, "history count");
+  for (unsigned i = 0; i < out.nHistory && i < nHistory; i++) {
+    const compactReading_t& h = history[i];
+    // a pressure of the other kind (raw / Pa) than the frame's is left out
+    const bool hasPressure = (h.flags & COMPACT_HAS_PRESSURE) && !((h.flags ^ r.flags) & COMPACT_RAW);
+    check(out.history[i].seq == h.seq, "history seq");
+    check(out.history[i].timediff == h.timediff, "history timediff");
+    check(out.history[i].hasPressure == hasPressure, "history pressure flag");
+    check(out.history[i].pressure == (hasPressure ? pressureSent(r.flags, h.pressure) : 0), "history pressure");
+  }
+
+  // one flipped bit fails the CRC, the body decodes as on the proprietary link
+  CompactUplink body;
+  check(CompactUplink::decodeBody(&buf[2], len - 4u, body) && body.seq == out.seq && body.timediff == out.timediff
+            && body.pressure == out.pressure && body.nHistory == out.nHistory,
+        "body decode");
+  buf[len / 2] ^= 0x10;
+  check(!CompactUplink::decode(buf, len, out), "CRC");
+  return errors;
+}
+
+compactReading_t randomReading(std::mt19937& rng, uint8_t flags) {
+  std::uniform_int_distribution<uint32_t> u32;
+  std::uniform_int_distribution<int> pick(0, 3);
+  compactReading_t r;
+
+  std::memset(&r, 0, sizeof(r));
+  r.flags = flags;
+  r.seq = static_cast<uint16_t>(u32(rng));
+  // mostly the normal speed range (2 varint groups), sometimes any 32 bit value
+  r.timediff = pick(rng) ? 0x800 + u32(rng) % 0x8000 : u32(rng);
+  r.pressure = (flags & COMPACT_RAW) ? u32(rng) % 0x100000 : 20000 + u32(rng) % 140000;
+  r.temperature = static_cast<int16_t>(u32(rng));
+  r.rawTemperature = u32(rng) % 0x100000;
+  r.humidity = static_cast<uint16_t>(u32(rng) % 1200);
+  r.ride.revs = static_cast<uint16_t>(u32(rng) % 64);
+  r.ride.ticks = r.ride.revs * (0x800 + u32(rng) % 0x4000);
+  r.ride.minPeriod = pick(rng) ? 0x800 + u32(rng) % 0x4000 : 0;
+  r.ride.maxPeriod = r.ride.minPeriod + u32(rng) % 0x2000;
+  r.rideTotals.distance = u32(rng) % 200000;
+  r.rideTotals.movingTime = u32(rng) % 40000;
+  return r;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  const long readings = (argc > 1) ? std::atol(argv[1]) : 200000;
+  std::mt19937 rng(1234);
+  std::uniform_int_distribution<int> flagsDist(0, 31), histDist(0, COMPACT_MAX_HISTORY);
+  std::uniform_int_distribution<int> step(-300, 300);
+  long failed = 0;
+
+  // edge values, every presence combination
+  for (int flags = 0; flags < 32; flags++) {
+    compactReading_t r, h[COMPACT_MAX_HISTORY];
+    std::memset(&r, 0, sizeof(r));
+    r.flags = static_cast<uint8_t>(flags);
+    r.seq = 1;
+    r.timediff = 0xFFFFFFFF;
+    r.pressure = (flags & COMPACT_RAW) ? 0xFFFFF : 200000;  // above the 17 bit range
+    r.temperature = -32768;
+    r.rawTemperature = 0xFFFFF;
+    r.humidity = 0xFFFF;
+    r.ride.revs = 0xFFFF;
+    r.ride.ticks = 0xFFFFFFFF;
+    r.ride.minPeriod = 0;
+    r.ride.maxPeriod = 0xFFFFFFFF;
+    r.rideTotals.distance = 0xFFFFFFFF;
+    r.rideTotals.movingTime = 0xFFFFFFFF;
+    for (int i = 0; i < COMPACT_MAX_HISTORY; i++) {
+      h[i] = r;
+      h[i].seq = static_cast<uint16_t>(0xFFFF - i);  // sequence number wraps
+      h[i].timediff = static_cast<uint32_t>(i);
+      h[i].pressure = 1000;                           // below the base
+    }
+    failed += roundTrip(r, nullptr, 0, true) != 0;
+    failed += roundTrip(r, h, COMPACT_MAX_HISTORY, true) != 0;
+    r.flags &= ~COMPACT_HAS_RIDE;
+    r.timediff = 0x2400;
+    r.pressure = 96000;
+    for (int i = 0; i < COMPACT_MAX_HISTORY; i++) {
+      h[i].timediff = r.timediff + static_cast<uint32_t>(step(rng));
+      h[i].pressure = r.pressure + static_cast<uint32_t>(step(rng));
+    }
+    failed += roundTrip(r, h, COMPACT_MAX_HISTORY, true) != 0;
+  }
+
+  // speed frames of a SENSOR_RAW build: raw flag, no pressure, raw words in the history
+  for (int i = 0; i < 2; i++) {
+    compactReading_t r, h[COMPACT_MAX_HISTORY];
+    std::memset(&r, 0, sizeof(r));
+    r.flags = COMPACT_RAW;
+    r.seq = 100;
+    r.timediff = 0x2400;
+    for (int j = 0; j < COMPACT_MAX_HISTORY; j++) {
+      h[j] = r;
+      h[j].flags |= COMPACT_HAS_PRESSURE | COMPACT_HAS_TEMPERATURE;
+      h[j].seq = static_cast<uint16_t>(r.seq - 1 - j);
+      h[j].pressure = j ? 0xFFFFF : 0x5A3C1;
+    }
+    if (i) {
+      r.flags |= COMPACT_HAS_PRESSURE | COMPACT_HAS_TEMPERATURE;  // and with a raw pressure of its own
+      r.pressure = 0x5A000;
+    }
+    failed += roundTrip(r, h, COMPACT_MAX_HISTORY, true) != 0;
+  }
+
+  // random readings and histories as the firmware keeps them
+  for (long n = 0; n < readings; n++) {
+    compactReading_t r = randomReading(rng, static_cast<uint8_t>(flagsDist(rng)));
+    compactReading_t h[COMPACT_MAX_HISTORY];
+    const int nHistory = histDist(rng);
+    uint16_t seq = r.seq;
+    for (int i = 0; i < nHistory; i++) {
+      h[i] = randomReading(rng, static_cast<uint8_t>(flagsDist(rng)));
+      seq = static_cast<uint16_t>(seq - 1 - static_cast<uint16_t>(flagsDist(rng)));
+      h[i].seq = seq;
+      h[i].timediff = r.timediff + static_cast<uint32_t>(step(rng));
+    }
+    failed += roundTrip(r, h, static_cast<uint8_t>(nHistory), failed < 10) != 0;
+  }
+
+  std::printf("%ld readings + %d edge cases, %ld failed\n", readings, 3 * 32 + 2, failed);
+  return failed ? 1 : 0;
+}
@@ -0,0 +1,125 @@
+/*
+ * convert_check.c
+ *
+ * Integer sensor conversions of advanced_harvester (convert_raw_hdc_1000(),
+ * convert_tmp_007(), convert_opt_3001()) against the float code they replaced
+ * (convert_float.h, shared with the target bench convert_bench.c), for every raw
+ * code 0..65535.
+ *
+ * build: cc -O2 -ffunction-sections -Wl,--gc-sections
+ *           -I../ADVANCED/advanced_harvester -I../ADVANCED/advanced_harvester/interfaces
+ *           -I../ADVANCED/advanced_harvester/sensors -I../ADVANCED/advanced_harvester/cc26xxware_2_22_00_16101
+ *           -o convert_check convert_check.c ../ADVANCED/advanced_harvester/sensors/hdc-1000-sensor.c
+ *           ../ADVANCED/advanced_harvester/sensors/tmp-007-sensor.c ../ADVANCED/advanced_harvester/sensors/opt-3001-sensor.c -lm
+ *        (--gc-sections drops the I2C parts of the drivers)
+ *
+ * Two checks per output:
+ *  exact  the integer result is the datasheet formula truncated towards zero,
+ *         checked in 64 bit: must hold for every code
+ *  float  the value the float code returned ((int)(x * 100) resp. * 1000, IEEE
+ *         single as on the CC2650 runtime). Differences are allowed only where
+ *         the float code missed the truncation: the exact value at most 0.01 LSB
+ *         from an integer, and the difference at most 1 LSB plus one float epsilon
+ *         of the value (OPT3001 above 2^24 centilux has fewer bits in a float)
+ * The number of such codes is printed per output. Exit code 0 if both checks pass.
+ */
+
+#include <float.h>
+#include <math.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "hdc-1000-sensor.h"
+#include "tmp-007-sensor.h"
+#include "opt-3001-sensor.h"
+#include "convert_float.h"
+
+#define CODES					65536
+#define NEAR_LSB				0.01		// float rounding, see above
+
+enum { HDC_TEMP, HDC_HUM, TMP_AMB, TMP_OBJ, OPT_LUX, OUTPUTS };
+
+static const char *names[OUTPUTS] = {
+  "HDC1000 T [0.01 degC]", "HDC1000 RH [0.01 %RH]", "TMP007 ambient [0.001 degC]",
+  "TMP007 object [0.001 degC]", "OPT3001 [0.01 lux]"
+};
+
+// * Exact values: num / den, den > 0
+// ----------------------------------
+static int64_t truncated(int64_t num, int64_t den) {
+  return num / den;									// C99: towards zero
+}
+
+// Distance of num / den from the nearest integer [LSB]
+static double fromInteger(int64_t num, int64_t den) {
+  int64_t r = llabs(num) % den;
+  return (double)(r < den - r ? r : den - r) / den;
+}
+
+static void exactValue(int output, uint16_t raw, int64_t *num, int64_t *den) {
+  switch(output) {
+  case HDC_TEMP:
+    *num = (int64_t)(int16_t)raw * 16500 - 4000LL * 65536;
+    *den = 65536;
+    break;
+  case HDC_HUM:
+    *num = (int64_t)raw * 10000;
+    *den = 65536;
+    break;
+  case TMP_AMB:
+  case TMP_OBJ:
+    *num = (int64_t)(raw >> 2) * 125;
+    *den = 4;
+    break;
+  default:
+    *num = (int64_t)(raw & 0x0FFF) << (raw >> 12);
+    *den = 1;
+    break;
+  }
+}
+
+
+int main(void) {
+  unsigned exactFail[OUTPUTS] = {0}, floatDiff[OUTPUTS] = {0}, floatFail[OUTPUTS] = {0};
+  bool ok = true;
+  uint32_t code;
+  int i;
+
+  for(code = 0; code < CODES; code++) {
+    uint16_t raw = (uint16_t)code;
+    int32_t fixed[OUTPUTS], ref[OUTPUTS];
+
+    convert_raw_hdc_1000(raw, raw, &fixed[HDC_TEMP], &fixed[HDC_HUM]);
+    convert_tmp_007(raw, raw, &fixed[TMP_OBJ], &fixed[TMP_AMB]);
+    fixed[OPT_LUX] = (int32_t)convert_opt_3001(raw);
+    convertFloatHdc(raw, raw, &ref[HDC_TEMP], &ref[HDC_HUM]);
+    convertFloatTmp(raw, raw, &ref[TMP_OBJ], &ref[TMP_AMB]);
+    ref[OPT_LUX] = (int32_t)convertFloatOpt(raw);
+
+    for(i = 0; i < OUTPUTS; i++) {
+      int64_t num, den;
+
+      exactValue(i, raw, &num, &den);
+      if(fixed[i] != truncated(num, den)) {
+        exactFail[i]++;
+      }
+      if(ref[i] != fixed[i]) {
+        floatDiff[i]++;
+        if(fabs((double)ref[i] - fixed[i]) > 1 + fabs((double)fixed[i]) * FLT_EPSILON ||
+           fromInteger(num, den) > NEAR_LSB) {
+          floatFail[i]++;
+        }
+      }
+    }
+  }
+
+  printf("%d raw codes per output\n", CODES);
+  printf("%-28s  %5s  %10s\n", "output", "exact", "float diff");
+  for(i = 0; i < OUTPUTS; i++) {
+    printf("%-28s  %5s  %10u  %s\n", names[i], exactFail[i] ? "FAIL" : "ok", floatDiff[i],
+           floatFail[i] ? "FAIL" : (floatDiff[i] ? "ok, float rounding" : "ok"));
+    ok = ok && exactFail[i] == 0 && floatFail[i] == 0;
+  }
+  return ok ? 0 : 1;
+}
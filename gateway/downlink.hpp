@@ -0,0 +1,98 @@
+// downlink.hpp
+//
+// Gateway side of the tuning downlink of advanced_harvester (DOWNLINK_SCAN, format see
+// ADVANCED/advanced_harvester/downlink.h): AdvData of the gateway advert for one bike,
+// tagged with AES-CMAC under the bike's key (auth.hpp).
+//
+// The bike accepts a frame only in the epoch of its last sealed uplink frame and with a
+// sequence number above the last one it accepted. nextSeq() takes the epoch from the
+// Device state, so send only after an uplink frame of the bike verified. The bike scans
+// briefly after every DOWNLINK_SCAN_RATIO-th transmission at high speed: repeat the
+// advert with the same sequence number until the uplink shows the new settings. After a
+// reset (diagnostics frame: resets) the bike is back to its defaults, send the config
+// again with the next number.
+
+#ifndef DOWNLINK_HPP_
+#define DOWNLINK_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#include "auth_batch.hpp"
+
+namespace downlink {
+
+constexpr uint8_t kCmdTuning = 0xC0;
+constexpr std::size_t kAdLen = 27;
+constexpr std::size_t kLength = kAdLen + 1;
+constexpr std::size_t kTagLen = 4;
+constexpr std::size_t kMacStart = 4;   // CMAC over [4..23]
+constexpr std::size_t kSpeedBands = 5;
+
+// accepted ranges (DOWNLINK_* in downlink.h)
+constexpr uint8_t kCountMaxMin = 2;
+constexpr uint8_t kTxIbMin = 0x01;
+constexpr uint8_t kTxIbMax = 0x31;
+constexpr uint8_t kTxGcMax = 0x03;
+constexpr uint16_t kWheelMinMm = 1000;
+constexpr uint16_t kWheelMaxMm = 3000;
+
+struct Tuning {
+  uint8_t countMax[kSpeedBands];  // per speed band, see getData()
+  uint8_t txPowerIB;              // CMD_RADIO_SETUP, pa_table_cc26xx.c
+  uint8_t txPowerGC;
+  uint16_t wheelCircumference;    // [mm]
+
+  bool valid() const {
+    for (std::size_t i = 0; i < kSpeedBands; i++) {
+      if (countMax[i] < kCountMaxMin) {
+        return false;
+      }
+    }
+    return txPowerIB >= kTxIbMin && txPowerIB <= kTxIbMax && txPowerGC <= kTxGcMax &&
+           wheelCircumference >= kWheelMinMm && wheelCircumference <= kWheelMaxMm;
+  }
+};
+
+// Sequence number for the next config of the bike: epoch of its last verified uplink
+// frame, config number 1 in a new epoch. last: the number sent before, 0 if none
+inline uint32_t nextSeq(const auth::Device& dev, uint32_t last) {
+  const uint32_t epoch = dev.lastCounter >> 16;
+  return ((last >> 16) == epoch && (last & 0xFFFF) != 0xFFFF) ? last + 1 : (epoch << 16) | 1;
+}
+
+// AdvData for the bike with address adva (AdvA byte order) into out, returns kLength.
+// 0 if a value is outside the ranges the bike accepts
+inline std::size_t encodeTuning(const auth::Device& dev, const uint8_t adva[6], uint32_t seq, const Tuning& t,
+                                uint8_t out[kLength]) {
+  if (!t.valid()) {
+    return 0;
+  }
+  out[0] = static_cast<uint8_t>(kAdLen);
+  out[1] = 0xFF;
+  out[2] = 0xDE;
+  out[3] = 0xBA;
+  out[4] = kCmdTuning;
+  std::memcpy(&out[5], adva, 6);
+  out[11] = static_cast<uint8_t>(seq >> 24);
+  out[12] = static_cast<uint8_t>(seq >> 16);
+  out[13] = static_cast<uint8_t>(seq >> 8);
+  out[14] = static_cast<uint8_t>(seq);
+  std::memcpy(&out[15], t.countMax, kSpeedBands);
+  out[20] = t.txPowerIB;
+  out[21] = t.txPowerGC;
+  out[22] = static_cast<uint8_t>(t.wheelCircumference >> 8);
+  out[23] = static_cast<uint8_t>(t.wheelCircumference);
+
+  const uint8_t* msg = &out[kMacStart];
+  const std::size_t len = kLength - kTagLen - kMacStart;
+  uint8_t mac[1][16];
+  auth::cmacBatch(dev.aes, &msg, &len, 1, mac);
+  std::memcpy(&out[kLength - kTagLen], mac[0], kTagLen);
+  return kLength;
+}
+
+}  // namespace downlink
+
+#endif  // DOWNLINK_HPP_
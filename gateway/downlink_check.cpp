@@ -0,0 +1,114 @@
+// downlink_check.cpp
+//
+// Tuning downlink: frames from downlink::encodeTuning() (downlink.hpp) through the
+// firmware check downlinkApply() (downlink.c). A valid frame has to apply, and nothing
+// may apply that a bystander could send: repeats, older numbers, frames of another
+// epoch, another bike or key, flipped bits, values out of range, a bike without key.
+// The auth.c functions downlink.c uses are stand-ins here on the same key (aes128.c).
+//
+// build: cc -c -I../ADVANCED/advanced_harvester -I../ADVANCED/advanced_harvester/cc26xxware_2_22_00_16101
+//           ../ADVANCED/advanced_harvester/downlink.c ../ADVANCED/advanced_harvester/aes128.c
+//        c++ -std=c++11 -O2 -I../ADVANCED/advanced_harvester -I../ADVANCED/advanced_harvester/cc26xxware_2_22_00_16101
+//            -o downlink_check downlink_check.cpp downlink.o aes128.o
+// usage: downlink_check; exit code 0 if all cases pass
+
+#include <cstdio>
+#include <cstring>
+
+extern "C" {
+#include "aes128.h"
+#include "downlink.h"
+}
+#include "downlink.hpp"
+
+namespace {
+
+const uint8_t kKey[auth::kKeyLen] = {0x3c, 0x91, 0x05, 0xe2, 0x7a, 0x48, 0xd6, 0x1f,
+                                     0x88, 0x2b, 0xc4, 0x60, 0x93, 0x5e, 0x0d, 0xb7};
+const uint8_t kAdva[6] = {0x34, 0x12, 0xc9, 0x48, 0xb4, 0xb0};
+
+// bike side: key record and uplink state as auth.c keeps them
+aes128_key_t record;
+bool provisioned = true;
+uint16_t sealedEpoch = 3;
+
+bool ok = true;
+
+void check(const char* name, bool pass) {
+  std::printf("%-36s %s\n", name, pass ? "ok" : "FAIL");
+  ok = ok && pass;
+}
+
+bool apply(const uint8_t* frame) {
+  return downlinkApply(frame, kAdva);
+}
+
+}  // namespace
+
+extern "C" uint16_t authSealedEpoch(void) {
+  return provisioned ? sealedEpoch : 0;
+}
+
+extern "C" bool authCmac(const uint8_t* msg, uint8_t len, uint8_t* mac, uint8_t macLen) {
+  return provisioned && aes128Cmac(&record, msg, len, mac, macLen);
+}
+
+int main() {
+  aes128Expand(kKey, &record);
+  auth::Device dev(kKey), other(kKey);
+  dev.lastCounter = (3u << 16) | 40;   // gateway verified a frame of epoch 3
+  const downlink::Tuning t = {{3, 4, 12, 90, 200}, 0x31, 0x0, 2105};
+  uint8_t f[downlink::kLength], g[downlink::kLength];
+  uint32_t seq = downlink::nextSeq(dev, 0);
+
+  check("encoder length", downlink::encodeTuning(dev, kAdva, seq, t, f) == downlink::kLength && f[0] == DOWNLINK_AD_LEN);
+  check("valid frame applies", apply(f) && g_tuning.txPowerIB == 0x31 && g_tuning.txPowerGC == 0 &&
+                                   g_tuning.wheelCircumference == 2105 && g_tuning.countMax[4] == 200);
+  check("repeat ignored", !apply(f));
+
+  // every single bit flipped, tag included
+  bool flips = true;
+  seq = downlink::nextSeq(dev, seq);
+  downlink::encodeTuning(dev, kAdva, seq, t, f);
+  for (std::size_t i = 0; i < downlink::kLength * 8; i++) {
+    std::memcpy(g, f, sizeof(g));
+    g[i / 8] ^= static_cast<uint8_t>(0x80 >> (i % 8));
+    flips = flips && !apply(g);
+  }
+  check("flipped bit rejected", flips);
+
+  const uint8_t otherKey[auth::kKeyLen] = {1};
+  auth::Device stranger(otherKey);
+  stranger.lastCounter = dev.lastCounter;
+  downlink::encodeTuning(stranger, kAdva, seq, t, g);
+  check("other key rejected", !apply(g));
+  const uint8_t otherAdva[6] = {0x35, 0x12, 0xc9, 0x48, 0xb4, 0xb0};
+  downlink::encodeTuning(dev, otherAdva, seq, t, g);
+  check("other bike rejected", !apply(g));
+  downlink::Tuning bad = t;
+  bad.countMax[2] = 1;
+  check("out of range not encoded", downlink::encodeTuning(dev, kAdva, seq, bad, g) == 0);
+
+  provisioned = false;
+  check("bike without key rejects", !apply(f));
+  provisioned = true;
+  check("next number applies", apply(f));
+  downlink::encodeTuning(dev, kAdva, seq - 1, t, g);
+  check("older number rejected", !apply(g));
+
+  // bike powered on: new epoch, recorded frames are dead; the gateway follows the uplink
+  sealedEpoch = 5;
+  check("old epoch rejected", !apply(f));
+  downlink::encodeTuning(dev, kAdva, (3u << 16) | 0xFFFF, t, g);
+  check("old epoch, high number rejected", !apply(g));
+  dev.lastCounter = (5u << 16) | 2;
+  seq = downlink::nextSeq(dev, seq);
+  check("new epoch numbers from 1", seq == ((5u << 16) | 1));
+  downlink::encodeTuning(dev, kAdva, seq, t, f);
+  check("new epoch applies", apply(f));
+  other.lastCounter = (6u << 16) | 1;
+  downlink::encodeTuning(other, kAdva, downlink::nextSeq(other, seq), t, g);
+  check("future epoch rejected", !apply(g));
+
+  return ok ? 0 : 1;
+}
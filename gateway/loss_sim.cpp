@@ -0,0 +1,145 @@
+// loss_sim.cpp
+//
+// Delivery ratio of the compact uplink with cross-packet redundancy
+// (PAYLOAD_REDUNDANCY) against the number of advertising channels.
+//
+// Real frames are built with the firmware encoder, adverts are dropped
+// independently with probability p per channel, and the gateway decoder
+// rebuilds readings from the packets that arrive (own fields + history).
+// Every recovered reading is checked against the original.
+//
+// build: cc -c -I../ADVANCED/advanced_harvester -I../ADVANCED/advanced_harvester/cc26xxware_2_22_00_16101
+//           ../ADVANCED/advanced_harvester/payload_compact.c
+//        c++ -std=c++11 -O2 -I../ADVANCED/advanced_harvester -I../ADVANCED/advanced_harvester/cc26xxware_2_22_00_16101
+//            -o loss_sim loss_sim.cpp payload_compact.o
+// usage: loss_sim [packets, default 200000]
+
+#include <cstdio>
+#include <cstdlib>
+#include <map>
+#include <random>
+#include <utility>
+#include <vector>
+
+extern "C" {
+#include "payload_compact.h"
+}
+#include "payload_compact.hpp"
+
+struct Result {
+  double delivered;   // readings known at the gateway
+  double bytes;       // AdvData bytes on air per reading (all channels)
+  bool ok;            // every recovered value matched
+};
+
+static Result run(int channels, int redundancy, double p, int packets) {
+  std::mt19937 rng(1234);
+  std::uniform_real_distribution<double> uni(0.0, 1.0);
+  std::uniform_int_distribution<int> wakes(2, 10);
+  std::uniform_int_distribution<int> step(-40, 40);
+
+  std::vector<std::pair<uint32_t, compactReading_t>> sent;   // unwrapped sequence number, reading
+  std::map<uint32_t, payload::CompactUplink::History> known;
+  uint32_t fullSeq = 0;
+  uint32_t gatewaySeq = 0;   // last unwrapped sequence number seen by the gateway
+  compactReading_t history[COMPACT_MAX_HISTORY];
+  int nHistory = 0;
+  uint16_t seq = 0;
+  uint32_t timediff = 0x2400;
+  uint32_t pressure = 96000;
+  long bytes = 0;
+  bool ok = true;
+
+  for (int i = 0; i < packets; i++) {
+    compactReading_t r = {};
+    int wake = wakes(rng);
+    seq = static_cast<uint16_t>(seq + wake);
+    fullSeq += static_cast<uint32_t>(wake);
+    timediff = static_cast<uint32_t>(static_cast<int32_t>(timediff) + step(rng));
+    r.seq = seq;
+    r.timediff = timediff;
+    if (i % 4 == 0) {  // environment frame
+      pressure = static_cast<uint32_t>(static_cast<int32_t>(pressure) + step(rng));
+      r.flags = COMPACT_HAS_PRESSURE | COMPACT_HAS_TEMPERATURE;
+      r.pressure = pressure;
+      r.temperature = 2150;
+    }
+
+    uint8_t buf[COMPACT_MAX_LEN];
+    uint8_t len = payloadCompactEncode(buf, &r, history, static_cast<uint8_t>(nHistory < redundancy ? nHistory : redundancy));
+    bytes += static_cast<long>(len) * channels;
+
+    bool arrived = false;
+    for (int c = 0; c < channels; c++) {
+      arrived |= uni(rng) >= p;
+    }
+
+    if (arrived) {
+      payload::CompactUplink d;
+      if (!payload::CompactUplink::decode(buf, len, d)) {
+        ok = false;
+      } else {
+        // 16 bit sequence numbers wrap, unwrap against the last one seen
+        gatewaySeq += static_cast<uint32_t>(static_cast<int16_t>(d.seq - static_cast<uint16_t>(gatewaySeq)));
+        known[gatewaySeq] = {d.seq, d.timediff, (d.flags & payload::CompactUplink::kHasPressure) != 0, d.pressure};
+        for (unsigned k = 0; k < d.nHistory; k++) {
+          uint32_t full = gatewaySeq - static_cast<uint16_t>(d.seq - d.history[k].seq);
+          known[full] = d.history[k];
+        }
+      }
+    }
+
+    sent.push_back(std::make_pair(fullSeq, r));
+    for (int k = COMPACT_MAX_HISTORY - 1; k > 0; k--) {
+      history[k] = history[k - 1];
+    }
+    history[0] = r;
+    if (nHistory < COMPACT_MAX_HISTORY) {
+      nHistory++;
+    }
+  }
+
+  long delivered = 0;
+  for (const auto& s : sent) {
+    const compactReading_t& r = s.second;
+    auto it = known.find(s.first);
+    if (it == known.end()) {
+      continue;
+    }
+    delivered++;
+    if (it->second.timediff != r.timediff || ((r.flags & COMPACT_HAS_PRESSURE) && it->second.pressure != r.pressure)) {
+      ok = false;
+    }
+  }
+
+  return {static_cast<double>(delivered) / packets, static_cast<double>(bytes) / packets, ok};
+}
+
+int main(int argc, char** argv) {
+  int packets = (argc > 1) ? std::atoi(argv[1]) : 200000;
+  const double losses[] = {0.05, 0.1, 0.2, 0.3};
+  const int configs[][2] = {{3, 0}, {2, 0}, {2, 1}, {2, 2}, {1, 0}, {1, 1}, {1, 2}};
+  bool ok = true;
+
+  std::printf("%-8s %-10s", "channels", "redundancy");
+  for (double p : losses) {
+    std::printf("  p=%.2f deliv/bytes", p);
+  }
+  std::printf("\n");
+
+  for (const auto& c : configs) {
+    std::printf("%-8d %-10d", c[0], c[1]);
+    for (double p : losses) {
+      Result r = run(c[0], c[1], p, packets);
+      ok &= r.ok;
+      std::printf("  %8.5f / %6.1f", r.delivered, r.bytes);
+    }
+    std::printf("\n");
+  }
+
+  if (!ok) {
+    std::printf("MISMATCH: recovered values differ from sent readings\n");
+    return 1;
+  }
+  return 0;
+}
@@ -0,0 +1,73 @@
+// payload_advanced_calib_2.hpp
+//
+// Generated by gateway/payloadgen.py from schema/advanced_calib_2.schema - do not edit.
+
+#ifndef PAYLOAD_ADVANCED_CALIB_2_HPP_
+#define PAYLOAD_ADVANCED_CALIB_2_HPP_
+
+#include <cstddef>
+#include <cstdint>
+
+namespace payload {
+
+#ifndef PAYLOAD_CRC16_CPP_DEFINED
+#define PAYLOAD_CRC16_CPP_DEFINED
+// CRC-16/CCITT-FALSE (poly 0x1021, init 0xFFFF)
+inline uint16_t crc16(const uint8_t* data, std::size_t len) {
+  uint16_t crc = 0xFFFF;
+  for (std::size_t i = 0; i < len; i++) {
+    crc ^= static_cast<uint16_t>(data[i] << 8);
+    for (int b = 0; b < 8; b++) {
+      crc = (crc & 0x8000) ? static_cast<uint16_t>((crc << 1) ^ 0x1021) : static_cast<uint16_t>(crc << 1);
+    }
+  }
+  return crc;
+}
+#endif
+
+struct AdvancedCalib2 {
+  static constexpr std::size_t kLength = 19;
+
+  uint16_t dig_p4;
+  uint16_t dig_p5;
+  uint16_t dig_p6;
+  uint16_t dig_p7;
+  uint16_t dig_p8;
+  uint16_t dig_p9;
+
+  // Decode AdvData starting at the AD length byte. False on length, constant or CRC mismatch
+  static bool decode(const uint8_t* buf, std::size_t len, AdvancedCalib2& out) {
+    if (len < kLength) {
+      return false;
+    }
+    if (buf[0] != 18) {
+      return false;
+    }
+    if (buf[1] != 0x16) {
+      return false;
+    }
+    if (buf[2] != 0xDE) {
+      return false;
+    }
+    if (buf[3] != 0xBB) {
+      return false;
+    }
+    if (buf[4] != 0x02) {
+      return false;
+    }
+    if (crc16(buf, 17) != static_cast<uint16_t>((buf[17] << 8) | buf[18])) {
+      return false;
+    }
+    out.dig_p4 = static_cast<uint16_t>((static_cast<uint16_t>(buf[5]) << 8) | static_cast<uint16_t>(buf[6]));
+    out.dig_p5 = static_cast<uint16_t>((static_cast<uint16_t>(buf[7]) << 8) | static_cast<uint16_t>(buf[8]));
+    out.dig_p6 = static_cast<uint16_t>((static_cast<uint16_t>(buf[9]) << 8) | static_cast<uint16_t>(buf[10]));
+    out.dig_p7 = static_cast<uint16_t>((static_cast<uint16_t>(buf[11]) << 8) | static_cast<uint16_t>(buf[12]));
+    out.dig_p8 = static_cast<uint16_t>((static_cast<uint16_t>(buf[13]) << 8) | static_cast<uint16_t>(buf[14]));
+    out.dig_p9 = static_cast<uint16_t>((static_cast<uint16_t>(buf[15]) << 8) | static_cast<uint16_t>(buf[16]));
+    return true;
+  }
+};
+
+}  // namespace payload
+
+#endif  // PAYLOAD_ADVANCED_CALIB_2_HPP_
@@ -0,0 +1,73 @@
+// payload_advanced_diag.hpp
+//
+// Generated by gateway/payloadgen.py from schema/advanced_diag.schema - do not edit.
+
+#ifndef PAYLOAD_ADVANCED_DIAG_HPP_
+#define PAYLOAD_ADVANCED_DIAG_HPP_
+
+#include <cstddef>
+#include <cstdint>
+
+namespace payload {
+
+#ifndef PAYLOAD_CRC16_CPP_DEFINED
+#define PAYLOAD_CRC16_CPP_DEFINED
+// CRC-16/CCITT-FALSE (poly 0x1021, init 0xFFFF)
+inline uint16_t crc16(const uint8_t* data, std::size_t len) {
+  uint16_t crc = 0xFFFF;
+  for (std::size_t i = 0; i < len; i++) {
+    crc ^= static_cast<uint16_t>(data[i] << 8);
+    for (int b = 0; b < 8; b++) {
+      crc = (crc & 0x8000) ? static_cast<uint16_t>((crc << 1) ^ 0x1021) : static_cast<uint16_t>(crc << 1);
+    }
+  }
+  return crc;
+}
+#endif
+
+struct AdvancedDiag {
+  static constexpr std::size_t kLength = 25;
+
+  uint16_t epoch;  // auth epoch (auth.h), the gateway resyncs its nonce counter from it (auth.hpp); 0 without AUTH_PAYLOAD
+  uint32_t wakes;  // main loop iterations since power-on
+  uint32_t txWakes;  // wakes with a transmission
+  uint32_t sensorReads;  // BMP280 read cycles
+  uint16_t i2cFailures;  // failed I2C register reads/writes
+  uint16_t bmpRetries;  // extra rounds of the BMP280 read loop
+
+  // Decode AdvData starting at the AD length byte. False on length, constant or CRC mismatch
+  static bool decode(const uint8_t* buf, std::size_t len, AdvancedDiag& out) {
+    if (len < kLength) {
+      return false;
+    }
+    if (buf[0] != 24) {
+      return false;
+    }
+    if (buf[1] != 0x16) {
+      return false;
+    }
+    if (buf[2] != 0xDE) {
+      return false;
+    }
+    if (buf[3] != 0xBC) {
+      return false;
+    }
+    if (buf[4] != 0x01) {
+      return false;
+    }
+    if (crc16(buf, 23) != static_cast<uint16_t>((buf[23] << 8) | buf[24])) {
+      return false;
+    }
+    out.epoch = static_cast<uint16_t>((static_cast<uint16_t>(buf[5]) << 8) | static_cast<uint16_t>(buf[6]));
+    out.wakes = static_cast<uint32_t>((static_cast<uint32_t>(buf[7]) << 24) | (static_cast<uint32_t>(buf[8]) << 16) | (static_cast<uint32_t>(buf[9]) << 8) | static_cast<uint32_t>(buf[10]));
+    out.txWakes = static_cast<uint32_t>((static_cast<uint32_t>(buf[11]) << 24) | (static_cast<uint32_t>(buf[12]) << 16) | (static_cast<uint32_t>(buf[13]) << 8) | static_cast<uint32_t>(buf[14]));
+    out.sensorReads = static_cast<uint32_t>((static_cast<uint32_t>(buf[15]) << 24) | (static_cast<uint32_t>(buf[16]) << 16) | (static_cast<uint32_t>(buf[17]) << 8) | static_cast<uint32_t>(buf[18]));
+    out.i2cFailures = static_cast<uint16_t>((static_cast<uint16_t>(buf[19]) << 8) | static_cast<uint16_t>(buf[20]));
+    out.bmpRetries = static_cast<uint16_t>((static_cast<uint16_t>(buf[21]) << 8) | static_cast<uint16_t>(buf[22]));
+    return true;
+  }
+};
+
+}  // namespace payload
+
+#endif  // PAYLOAD_ADVANCED_DIAG_HPP_
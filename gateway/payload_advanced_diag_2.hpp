@@ -0,0 +1,71 @@
+// payload_advanced_diag_2.hpp
+//
+// Generated by gateway/payloadgen.py from schema/advanced_diag_2.schema - do not edit.
+
+#ifndef PAYLOAD_ADVANCED_DIAG_2_HPP_
+#define PAYLOAD_ADVANCED_DIAG_2_HPP_
+
+#include <cstddef>
+#include <cstdint>
+
+namespace payload {
+
+#ifndef PAYLOAD_CRC16_CPP_DEFINED
+#define PAYLOAD_CRC16_CPP_DEFINED
+// CRC-16/CCITT-FALSE (poly 0x1021, init 0xFFFF)
+inline uint16_t crc16(const uint8_t* data, std::size_t len) {
+  uint16_t crc = 0xFFFF;
+  for (std::size_t i = 0; i < len; i++) {
+    crc ^= static_cast<uint16_t>(data[i] << 8);
+    for (int b = 0; b < 8; b++) {
+      crc = (crc & 0x8000) ? static_cast<uint16_t>((crc << 1) ^ 0x1021) : static_cast<uint16_t>(crc << 1);
+    }
+  }
+  return crc;
+}
+#endif
+
+struct AdvancedDiag2 {
+  static constexpr std::size_t kLength = 16;
+
+  uint16_t i2cSaved;  // I2C bytes not sent thanks to the sensor register shadow, saturates
+  uint32_t maxWake;  // longest wake [1/65536 s], saturates at 0xFFFFFF
+  uint16_t resets;  // warm resets since power-on
+  uint8_t resetCause;  // RSTSRC_*: 0 power-on, 1 pin, 2-4 VDDS/VDD/VDDR loss, 5 clock loss, 6 sysreset, 7 warm
+  uint8_t em8500Status;  // last EM8500 status register (0x29)
+
+  // Decode AdvData starting at the AD length byte. False on length, constant or CRC mismatch
+  static bool decode(const uint8_t* buf, std::size_t len, AdvancedDiag2& out) {
+    if (len < kLength) {
+      return false;
+    }
+    if (buf[0] != 15) {
+      return false;
+    }
+    if (buf[1] != 0x16) {
+      return false;
+    }
+    if (buf[2] != 0xDE) {
+      return false;
+    }
+    if (buf[3] != 0xBC) {
+      return false;
+    }
+    if (buf[4] != 0x02) {
+      return false;
+    }
+    if (crc16(buf, 14) != static_cast<uint16_t>((buf[14] << 8) | buf[15])) {
+      return false;
+    }
+    out.i2cSaved = static_cast<uint16_t>((static_cast<uint16_t>(buf[5]) << 8) | static_cast<uint16_t>(buf[6]));
+    out.maxWake = static_cast<uint32_t>((static_cast<uint32_t>(buf[7]) << 16) | (static_cast<uint32_t>(buf[8]) << 8) | static_cast<uint32_t>(buf[9]));
+    out.resets = static_cast<uint16_t>((static_cast<uint16_t>(buf[10]) << 8) | static_cast<uint16_t>(buf[11]));
+    out.resetCause = static_cast<uint8_t>(static_cast<uint8_t>(buf[12]));
+    out.em8500Status = static_cast<uint8_t>(static_cast<uint8_t>(buf[13]));
+    return true;
+  }
+};
+
+}  // namespace payload
+
+#endif  // PAYLOAD_ADVANCED_DIAG_2_HPP_
@@ -0,0 +1,69 @@
+// payload_advanced_energy.hpp
+//
+// Generated by gateway/payloadgen.py from schema/advanced_energy.schema - do not edit.
+
+#ifndef PAYLOAD_ADVANCED_ENERGY_HPP_
+#define PAYLOAD_ADVANCED_ENERGY_HPP_
+
+#include <cstddef>
+#include <cstdint>
+
+namespace payload {
+
+#ifndef PAYLOAD_CRC16_CPP_DEFINED
+#define PAYLOAD_CRC16_CPP_DEFINED
+// CRC-16/CCITT-FALSE (poly 0x1021, init 0xFFFF)
+inline uint16_t crc16(const uint8_t* data, std::size_t len) {
+  uint16_t crc = 0xFFFF;
+  for (std::size_t i = 0; i < len; i++) {
+    crc ^= static_cast<uint16_t>(data[i] << 8);
+    for (int b = 0; b < 8; b++) {
+      crc = (crc & 0x8000) ? static_cast<uint16_t>((crc << 1) ^ 0x1021) : static_cast<uint16_t>(crc << 1);
+    }
+  }
+  return crc;
+}
+#endif
+
+struct AdvancedEnergy {
+  static constexpr std::size_t kLength = 23;
+
+  uint32_t rf;  // radio command chains [uC]
+  uint32_t xosc;  // 24 MHz XOSC on [uC]
+  uint32_t cpu;  // CPU active [uC]
+  uint32_t idle;  // CPU off, MCU powered [uC]
+
+  // Decode AdvData starting at the AD length byte. False on length, constant or CRC mismatch
+  static bool decode(const uint8_t* buf, std::size_t len, AdvancedEnergy& out) {
+    if (len < kLength) {
+      return false;
+    }
+    if (buf[0] != 22) {
+      return false;
+    }
+    if (buf[1] != 0x16) {
+      return false;
+    }
+    if (buf[2] != 0xDE) {
+      return false;
+    }
+    if (buf[3] != 0xBD) {
+      return false;
+    }
+    if (buf[4] != 0x01) {
+      return false;
+    }
+    if (crc16(buf, 21) != static_cast<uint16_t>((buf[21] << 8) | buf[22])) {
+      return false;
+    }
+    out.rf = static_cast<uint32_t>((static_cast<uint32_t>(buf[5]) << 24) | (static_cast<uint32_t>(buf[6]) << 16) | (static_cast<uint32_t>(buf[7]) << 8) | static_cast<uint32_t>(buf[8]));
+    out.xosc = static_cast<uint32_t>((static_cast<uint32_t>(buf[9]) << 24) | (static_cast<uint32_t>(buf[10]) << 16) | (static_cast<uint32_t>(buf[11]) << 8) | static_cast<uint32_t>(buf[12]));
+    out.cpu = static_cast<uint32_t>((static_cast<uint32_t>(buf[13]) << 24) | (static_cast<uint32_t>(buf[14]) << 16) | (static_cast<uint32_t>(buf[15]) << 8) | static_cast<uint32_t>(buf[16]));
+    out.idle = static_cast<uint32_t>((static_cast<uint32_t>(buf[17]) << 24) | (static_cast<uint32_t>(buf[18]) << 16) | (static_cast<uint32_t>(buf[19]) << 8) | static_cast<uint32_t>(buf[20]));
+    return true;
+  }
+};
+
+}  // namespace payload
+
+#endif  // PAYLOAD_ADVANCED_ENERGY_HPP_
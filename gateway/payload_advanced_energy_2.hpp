@@ -0,0 +1,65 @@
+// payload_advanced_energy_2.hpp
+//
+// Generated by gateway/payloadgen.py from schema/advanced_energy_2.schema - do not edit.
+
+#ifndef PAYLOAD_ADVANCED_ENERGY_2_HPP_
+#define PAYLOAD_ADVANCED_ENERGY_2_HPP_
+
+#include <cstddef>
+#include <cstdint>
+
+namespace payload {
+
+#ifndef PAYLOAD_CRC16_CPP_DEFINED
+#define PAYLOAD_CRC16_CPP_DEFINED
+// CRC-16/CCITT-FALSE (poly 0x1021, init 0xFFFF)
+inline uint16_t crc16(const uint8_t* data, std::size_t len) {
+  uint16_t crc = 0xFFFF;
+  for (std::size_t i = 0; i < len; i++) {
+    crc ^= static_cast<uint16_t>(data[i] << 8);
+    for (int b = 0; b < 8; b++) {
+      crc = (crc & 0x8000) ? static_cast<uint16_t>((crc << 1) ^ 0x1021) : static_cast<uint16_t>(crc << 1);
+    }
+  }
+  return crc;
+}
+#endif
+
+struct AdvancedEnergy2 {
+  static constexpr std::size_t kLength = 13;
+
+  uint32_t standby;  // standby [uC]
+  uint16_t averageCurrent;  // over the last ENERGY_WINDOW [uA], saturates at 0xFFFF
+
+  // Decode AdvData starting at the AD length byte. False on length, constant or CRC mismatch
+  static bool decode(const uint8_t* buf, std::size_t len, AdvancedEnergy2& out) {
+    if (len < kLength) {
+      return false;
+    }
+    if (buf[0] != 12) {
+      return false;
+    }
+    if (buf[1] != 0x16) {
+      return false;
+    }
+    if (buf[2] != 0xDE) {
+      return false;
+    }
+    if (buf[3] != 0xBD) {
+      return false;
+    }
+    if (buf[4] != 0x02) {
+      return false;
+    }
+    if (crc16(buf, 11) != static_cast<uint16_t>((buf[11] << 8) | buf[12])) {
+      return false;
+    }
+    out.standby = static_cast<uint32_t>((static_cast<uint32_t>(buf[5]) << 24) | (static_cast<uint32_t>(buf[6]) << 16) | (static_cast<uint32_t>(buf[7]) << 8) | static_cast<uint32_t>(buf[8]));
+    out.averageCurrent = static_cast<uint16_t>((static_cast<uint16_t>(buf[9]) << 8) | static_cast<uint16_t>(buf[10]));
+    return true;
+  }
+};
+
+}  // namespace payload
+
+#endif  // PAYLOAD_ADVANCED_ENERGY_2_HPP_
@@ -0,0 +1,62 @@
+// payload_advanced_speed.hpp
+//
+// Generated by gateway/payloadgen.py from schema/advanced_speed.schema - do not edit.
+
+#ifndef PAYLOAD_ADVANCED_SPEED_HPP_
+#define PAYLOAD_ADVANCED_SPEED_HPP_
+
+#include <cstddef>
+#include <cstdint>
+
+namespace payload {
+
+#ifndef PAYLOAD_CRC16_CPP_DEFINED
+#define PAYLOAD_CRC16_CPP_DEFINED
+// CRC-16/CCITT-FALSE (poly 0x1021, init 0xFFFF)
+inline uint16_t crc16(const uint8_t* data, std::size_t len) {
+  uint16_t crc = 0xFFFF;
+  for (std::size_t i = 0; i < len; i++) {
+    crc ^= static_cast<uint16_t>(data[i] << 8);
+    for (int b = 0; b < 8; b++) {
+      crc = (crc & 0x8000) ? static_cast<uint16_t>((crc << 1) ^ 0x1021) : static_cast<uint16_t>(crc << 1);
+    }
+  }
+  return crc;
+}
+#endif
+
+struct AdvancedSpeed {
+  static constexpr std::size_t kLength = 12;
+
+  uint16_t seq;  // sequence number
+  uint32_t timediff;  // wheel period [1/65536 s]
+
+  // Decode AdvData starting at the AD length byte. False on length, constant or CRC mismatch
+  static bool decode(const uint8_t* buf, std::size_t len, AdvancedSpeed& out) {
+    if (len < kLength) {
+      return false;
+    }
+    if (buf[0] != 11) {
+      return false;
+    }
+    if (buf[1] != 0x16) {
+      return false;
+    }
+    if (buf[2] != 0xDE) {
+      return false;
+    }
+    if (buf[3] != 0xBA) {
+      return false;
+    }
+    if (crc16(buf, 10) != static_cast<uint16_t>((buf[10] << 8) | buf[11])) {
+      return false;
+    }
+    out.seq = static_cast<uint16_t>((static_cast<uint16_t>(buf[4]) << 8) | static_cast<uint16_t>(buf[5]));
+    out.timediff = static_cast<uint32_t>((static_cast<uint32_t>(buf[6]) << 24) | (static_cast<uint32_t>(buf[7]) << 16) | (static_cast<uint32_t>(buf[8]) << 8) | static_cast<uint32_t>(buf[9]));
+    return true;
+  }
+};
+
+}  // namespace payload
+
+#endif  // PAYLOAD_ADVANCED_SPEED_HPP_
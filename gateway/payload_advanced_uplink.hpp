@@ -0,0 +1,68 @@
+// payload_advanced_uplink.hpp
+//
+// Generated by gateway/payloadgen.py from schema/advanced_uplink.schema - do not edit.
+
+#ifndef PAYLOAD_ADVANCED_UPLINK_HPP_
+#define PAYLOAD_ADVANCED_UPLINK_HPP_
+
+#include <cstddef>
+#include <cstdint>
+
+namespace payload {
+
+#ifndef PAYLOAD_CRC16_CPP_DEFINED
+#define PAYLOAD_CRC16_CPP_DEFINED
+// CRC-16/CCITT-FALSE (poly 0x1021, init 0xFFFF)
+inline uint16_t crc16(const uint8_t* data, std::size_t len) {
+  uint16_t crc = 0xFFFF;
+  for (std::size_t i = 0; i < len; i++) {
+    crc ^= static_cast<uint16_t>(data[i] << 8);
+    for (int b = 0; b < 8; b++) {
+      crc = (crc & 0x8000) ? static_cast<uint16_t>((crc << 1) ^ 0x1021) : static_cast<uint16_t>(crc << 1);
+    }
+  }
+  return crc;
+}
+#endif
+
+struct AdvancedUplink {
+  static constexpr std::size_t kLength = 24;
+
+  uint16_t seq;  // sequence number
+  uint32_t timediff;  // wheel period [1/65536 s]
+  uint32_t pressure;  // [Pa]
+  uint16_t temperature;  // bmp-280 value_bmp_280(TEMP)
+  uint32_t humidity;
+
+  // Decode AdvData starting at the AD length byte. False on length, constant or CRC mismatch
+  static bool decode(const uint8_t* buf, std::size_t len, AdvancedUplink& out) {
+    if (len < kLength) {
+      return false;
+    }
+    if (buf[0] != 23) {
+      return false;
+    }
+    if (buf[1] != 0x03) {
+      return false;
+    }
+    if (buf[2] != 0xDE) {
+      return false;
+    }
+    if (buf[3] != 0xBA) {
+      return false;
+    }
+    if (crc16(buf, 22) != static_cast<uint16_t>((buf[22] << 8) | buf[23])) {
+      return false;
+    }
+    out.seq = static_cast<uint16_t>((static_cast<uint16_t>(buf[4]) << 8) | static_cast<uint16_t>(buf[5]));
+    out.timediff = static_cast<uint32_t>((static_cast<uint32_t>(buf[6]) << 24) | (static_cast<uint32_t>(buf[7]) << 16) | (static_cast<uint32_t>(buf[8]) << 8) | static_cast<uint32_t>(buf[9]));
+    out.pressure = static_cast<uint32_t>((static_cast<uint32_t>(buf[11]) << 16) | (static_cast<uint32_t>(buf[12]) << 8) | static_cast<uint32_t>(buf[13]));
+    out.temperature = static_cast<uint16_t>((static_cast<uint16_t>(buf[16]) << 8) | static_cast<uint16_t>(buf[17]));
+    out.humidity = static_cast<uint32_t>((static_cast<uint32_t>(buf[18]) << 24) | (static_cast<uint32_t>(buf[19]) << 16) | (static_cast<uint32_t>(buf[20]) << 8) | static_cast<uint32_t>(buf[21]));
+    return true;
+  }
+};
+
+}  // namespace payload
+
+#endif  // PAYLOAD_ADVANCED_UPLINK_HPP_
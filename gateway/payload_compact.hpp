@@ -0,0 +1,192 @@
+// payload_compact.hpp
+//
+// Decoder for the bit-packed uplink of advanced_harvester (PAYLOAD_COMPACT).
+// Format see ADVANCED/advanced_harvester/payload_compact.h
+
+#ifndef PAYLOAD_COMPACT_HPP_
+#define PAYLOAD_COMPACT_HPP_
+
+#include <cstddef>
+#include <cstdint>
+
+#include "payload_advanced_uplink.hpp"  // crc16()
+
+namespace payload {
+
+struct CompactUplink {
+  static constexpr uint8_t kRaw = 0x10;  // pressure/temperature are BMP280 ADC words
+  static constexpr uint8_t kHasRide = 0x8;
+  static constexpr uint8_t kHasPressure = 0x4;
+  static constexpr uint8_t kHasTemperature = 0x2;
+  static constexpr uint8_t kHasHumidity = 0x1;
+  static constexpr uint32_t kPressureBase = 30000;
+  static constexpr unsigned kMaxHistory = 2;
+
+  // key fields of an earlier packet, carried for loss recovery
+  struct History {
+    uint16_t seq;
+    uint32_t timediff;
+    bool hasPressure;
+    uint32_t pressure;  // as the frame's: [Pa], raw word with kRaw (SENSOR_RAW sets it on every frame)
+  };
+
+  uint8_t flags;
+  uint16_t seq;
+  uint32_t timediff;     // wheel period [1/65536 s]
+  uint32_t pressure;     // [Pa], raw word with kRaw
+  int16_t temperature;   // [0.1 degC]
+  uint32_t rawTemperature;  // raw word (kRaw), see bmp280.hpp
+  uint16_t humidity;     // [0.1 %RH]
+
+  // ride aggregates (kHasRide): window since the previous ride section, totals since reset
+  struct Ride {
+    uint32_t revs;
+    uint32_t ticks;        // moving time in window [1/65536 s]
+    uint32_t minPeriod;    // [1/65536 s], 0 = no moving revolution
+    uint32_t maxPeriod;
+    uint32_t distance;     // total [m]
+    uint32_t movingTime;   // total [s]
+
+    // speeds in km/h from the wheel circumference in mm (downlink tuning).
+    // The mean counts the first revolution after a stop, which adds no moving time
+    double meanSpeed(unsigned circumference) const { return ticks ? speed(static_cast<double>(circumference) * revs, ticks) : 0.0; }
+    double maxSpeed(unsigned circumference) const { return minPeriod ? speed(circumference, minPeriod) : 0.0; }
+    double minSpeed(unsigned circumference) const { return maxPeriod ? speed(circumference, maxPeriod) : 0.0; }
+
+   private:
+    static double speed(double mm, uint32_t ticks) { return mm / 1000.0 / (ticks / 65536.0) * 3.6; }
+  } ride;
+  unsigned nHistory;
+  History history[kMaxHistory];  // previous packet first
+
+  // Decode AdvData starting at the AD length byte. False on length, header or CRC mismatch
+  static bool decode(const uint8_t* buf, std::size_t len, CompactUplink& out) {
+    if (len < 7 || buf[0] + 1u > len || buf[0] < 6 || buf[1] != 0xFF) {
+      return false;
+    }
+    std::size_t n = buf[0] + 1u;
+    if (crc16(buf, n - 2) != static_cast<uint16_t>((buf[n - 2] << 8) | buf[n - 1])) {
+      return false;
+    }
+    return decodeBody(&buf[2], n - 4, out);
+  }
+
+  // Decode from 0xDE 0xBA on, without CRC (proprietary link, RF core checked the CRC)
+  static bool decodeBody(const uint8_t* body, std::size_t len, CompactUplink& out) {
+    if (len < 2 || body[0] != 0xDE || body[1] != 0xBA) {
+      return false;
+    }
+    BitReader r(&body[2], len - 2);
+
+    out.flags = static_cast<uint8_t>(r.get(5));
+    const bool raw = (out.flags & kRaw) != 0;
+    const unsigned pressureBits = raw ? 20 : 17;
+    const uint32_t pressureBase = raw ? 0 : kPressureBase;
+    out.nHistory = r.get(2);
+    out.seq = static_cast<uint16_t>(r.get(16));
+
+    out.timediff = r.varint8();
+
+    out.pressure = (out.flags & kHasPressure) ? r.get(pressureBits) + pressureBase : 0;
+    out.rawTemperature = 0;
+    if ((out.flags & kHasTemperature) && raw) {
+      out.rawTemperature = r.get(20);
+      out.temperature = 0;
+    } else if (out.flags & kHasTemperature) {
+      uint32_t t = r.get(12);
+      out.temperature = static_cast<int16_t>((t & 0x800) ? static_cast<int32_t>(t) - 0x1000 : static_cast<int32_t>(t));
+    } else {
+      out.temperature = 0;
+    }
+    out.humidity = (out.flags & kHasHumidity) ? static_cast<uint16_t>(r.get(10)) : 0;
+
+    out.ride = Ride{};
+    if (out.flags & kHasRide) {
+      out.ride.revs = r.varint8();
+      out.ride.ticks = r.varint8();
+      out.ride.minPeriod = r.varint8();
+      out.ride.maxPeriod = out.ride.minPeriod + r.varint8();
+      out.ride.distance = r.varint8();
+      out.ride.movingTime = r.varint8();
+    }
+
+    if (out.nHistory > kMaxHistory) {
+      return false;
+    }
+    uint16_t newerSeq = out.seq;
+    for (unsigned i = 0; i < out.nHistory; i++) {
+      History& h = out.history[i];
+      h.seq = static_cast<uint16_t>(newerSeq - r.varint4());
+      h.timediff = out.timediff + static_cast<uint32_t>(unzigzag(r.varint4()));
+      h.hasPressure = r.get(1) != 0;
+      h.pressure = 0;
+      if (h.hasPressure) {
+        if (out.flags & kHasPressure) {
+          h.pressure = static_cast<uint32_t>(static_cast<int32_t>(out.pressure) + unzigzag(r.varint4()));
+        } else {
+          h.pressure = r.get(pressureBits) + pressureBase;
+        }
+      }
+      newerSeq = h.seq;
+    }
+
+    return !r.overrun;
+  }
+
+ private:
+  static int32_t unzigzag(uint32_t v) {
+    return static_cast<int32_t>(v >> 1) ^ -static_cast<int32_t>(v & 1);
+  }
+
+  struct BitReader {
+    const uint8_t* data;
+    std::size_t bits;
+    std::size_t pos = 0;
+    bool overrun = false;
+
+    BitReader(const uint8_t* d, std::size_t len) : data(d), bits(len * 8) {}
+
+    uint32_t get(unsigned n) {
+      uint32_t v = 0;
+      while (n--) {
+        if (pos >= bits) {
+          overrun = true;
+          return 0;
+        }
+        v = (v << 1) | ((data[pos >> 3] >> (7 - (pos & 7))) & 1u);
+        pos++;
+      }
+      return v;
+    }
+
+    // groups of 7 data bits + continue bit, least significant group first
+    uint32_t varint8() {
+      uint32_t v = 0;
+      for (unsigned shift = 0; shift < 35 && !overrun; shift += 7) {
+        uint32_t group = get(8);
+        v |= (group & 0x7F) << shift;
+        if (!(group & 0x80)) {
+          break;
+        }
+      }
+      return v;
+    }
+
+    // groups of 3 data bits + continue bit, least significant group first
+    uint32_t varint4() {
+      uint32_t v = 0;
+      for (unsigned shift = 0; shift < 33 && !overrun; shift += 3) {
+        uint32_t group = get(4);
+        v |= (group & 0x7) << shift;
+        if (!(group & 0x8)) {
+          break;
+        }
+      }
+      return v;
+    }
+  };
+};
+
+}  // namespace payload
+
+#endif  // PAYLOAD_COMPACT_HPP_
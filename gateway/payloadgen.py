@@ -0,0 +1,263 @@
+#!/usr/bin/env python3
+"""
+payloadgen.py
+
+Payload schema compiler. Generates from one schema (schema/*.schema):
+  - a C header for the firmware: struct + straight-line encoder with
+    compile-time offsets and CRC-16
+  - a C++ header for the gateway: struct + decoder with length, constant
+    and CRC check
+
+usage: payloadgen.py <schema> [--c <out.h>] [--cpp <out.hpp>]
+
+Regenerate both sides after every schema change, the generated files are
+checked in (the firmware is built in CCS without this script).
+"""
+
+import argparse
+import os
+import sys
+
+WIDTHS = {"u8": 1, "u16": 2, "u24": 3, "u32": 4}
+CTYPES = {1: "uint8_t", 2: "uint16_t", 3: "uint32_t", 4: "uint32_t"}
+
+
+class Item:
+    def __init__(self, kind, offset, size, name=None, value=None, comment=""):
+        self.kind = kind          # len, const, pad, field, crc16
+        self.offset = offset
+        self.size = size
+        self.name = name
+        self.value = value
+        self.comment = comment
+
+
+def parse(path):
+    name = None
+    items = []
+    offset = 0
+    for lineno, raw in enumerate(open(path), 1):
+        line, _, comment = raw.partition("#")
+        tok = line.split()
+        comment = comment.strip()
+        if not tok:
+            continue
+        kw = tok[0]
+
+        def fail(msg):
+            sys.exit("%s:%d: %s" % (path, lineno, msg))
+
+        if kw == "payload":
+            name = tok[1]
+            continue
+        if any(i.kind == "crc16" for i in items):
+            fail("crc16 must be the last entry")
+        if kw == "len":
+            if offset != 0:
+                fail("len must be the first byte")
+            items.append(Item("len", offset, 1, comment=comment))
+            offset += 1
+        elif kw == "const":
+            items.append(Item("const", offset, 1, value=int(tok[1], 0), comment=comment))
+            offset += 1
+        elif kw == "pad":
+            n = int(tok[1])
+            items.append(Item("pad", offset, n, comment=comment))
+            offset += n
+        elif kw in WIDTHS:
+            items.append(Item("field", offset, WIDTHS[kw], name=tok[1], comment=comment))
+            offset += WIDTHS[kw]
+        elif kw == "crc16":
+            items.append(Item("crc16", offset, 2, comment=comment))
+            offset += 2
+        else:
+            fail("unknown entry '%s'" % kw)
+
+    if name is None:
+        sys.exit("%s: missing 'payload <name>'" % path)
+    return name, items, offset
+
+
+def camel(name):
+    return "".join(p.capitalize() for p in name.split("_"))
+
+
+def field_bytes(expr, item):
+    """Big endian byte expressions of a field, MSB first"""
+    out = []
+    for k in range(item.size):
+        shift = 8 * (item.size - 1 - k)
+        out.append("(uint8_t)(%s >> %d)" % (expr, shift) if shift else "(uint8_t)%s" % expr)
+    return out
+
+
+CRC_TABLE = [0] * 16
+for _n in range(16):
+    _c = _n << 12
+    for _b in range(4):
+        _c = ((_c << 1) ^ 0x1021) if _c & 0x8000 else (_c << 1)
+    CRC_TABLE[_n] = _c & 0xFFFF
+
+
+def gen_c(name, items, length, schema):
+    cam = camel(name)
+    typ = "payload%s_t" % cam
+    macro = "PAYLOAD_%s" % name.upper()
+    fields = [i for i in items if i.kind == "field"]
+    crc = [i for i in items if i.kind == "crc16"]
+    L = []
+    L.append("/*")
+    L.append(" * payload_%s.h" % name)
+    L.append(" *")
+    L.append(" * Generated by gateway/payloadgen.py from %s - do not edit." % schema)
+    L.append(" */")
+    L.append("")
+    L.append("#ifndef %s_H_" % macro)
+    L.append("#define %s_H_" % macro)
+    L.append("")
+    L.append("#include <stdint.h>")
+    L.append("")
+    L.append("#define %s_LEN\t\t%d" % (macro, length))
+    L.append("")
+    L.append("typedef struct {")
+    for f in fields:
+        L.append("  %s %s;%s" % (CTYPES[f.size], f.name, ("\t\t// " + f.comment) if f.comment else ""))
+    L.append("} %s;" % typ)
+    L.append("")
+    if crc:
+        table = ", ".join("0x%04X" % v for v in CRC_TABLE)
+        L.append("#ifndef PAYLOAD_CRC16_DEFINED")
+        L.append("#define PAYLOAD_CRC16_DEFINED")
+        L.append("// CRC-16/CCITT-FALSE (poly 0x1021, init 0xFFFF), 4 bit table")
+        L.append("static const uint16_t payloadCrc16Table[16] = {%s};" % table)
+        L.append("")
+        L.append("static inline uint16_t payloadCrc16(const uint8_t *data, uint8_t len) {")
+        L.append("  uint16_t crc = 0xFFFF;")
+        L.append("  uint8_t i;")
+        L.append("")
+        L.append("  for(i = 0; i < len; i++) {")
+        L.append("    crc = (crc << 4) ^ payloadCrc16Table[(crc >> 12) ^ (data[i] >> 4)];")
+        L.append("    crc = (crc << 4) ^ payloadCrc16Table[(crc >> 12) ^ (data[i] & 0x0F)];")
+        L.append("  }")
+        L.append("  return crc;")
+        L.append("}")
+        L.append("#endif")
+        L.append("")
+    L.append("// Encode into buf (%s_LEN bytes)" % macro)
+    L.append("static inline void payload%sEncode(uint8_t *buf, const %s *v) {" % (cam, typ))
+    if crc:
+        L.append("  uint16_t crc;")
+        L.append("")
+    for i in items:
+        if i.kind == "len":
+            L.append("  buf[%d] = %d;" % (i.offset, length - 1))
+        elif i.kind == "const":
+            L.append("  buf[%d] = 0x%02X;" % (i.offset, i.value))
+        elif i.kind == "pad":
+            for k in range(i.size):
+                L.append("  buf[%d] = 0;" % (i.offset + k))
+        elif i.kind == "field":
+            for k, e in enumerate(field_bytes("v->" + i.name, i)):
+                L.append("  buf[%d] = %s;" % (i.offset + k, e))
+        elif i.kind == "crc16":
+            L.append("")
+            L.append("  crc = payloadCrc16(buf, %d);" % i.offset)
+            L.append("  buf[%d] = (uint8_t)(crc >> 8);" % i.offset)
+            L.append("  buf[%d] = (uint8_t)crc;" % (i.offset + 1))
+    L.append("}")
+    L.append("")
+    L.append("#endif /* %s_H_ */" % macro)
+    return "\n".join(L) + "\n"
+
+
+def gen_cpp(name, items, length, schema):
+    cam = camel(name)
+    guard = "PAYLOAD_%s_HPP_" % name.upper()
+    fields = [i for i in items if i.kind == "field"]
+    L = []
+    L.append("// payload_%s.hpp" % name)
+    L.append("//")
+    L.append("// Generated by gateway/payloadgen.py from %s - do not edit." % schema)
+    L.append("")
+    L.append("#ifndef %s" % guard)
+    L.append("#define %s" % guard)
+    L.append("")
+    L.append("#include <cstddef>")
+    L.append("#include <cstdint>")
+    L.append("")
+    L.append("namespace payload {")
+    L.append("")
+    L.append("#ifndef PAYLOAD_CRC16_CPP_DEFINED")
+    L.append("#define PAYLOAD_CRC16_CPP_DEFINED")
+    L.append("// CRC-16/CCITT-FALSE (poly 0x1021, init 0xFFFF)")
+    L.append("inline uint16_t crc16(const uint8_t* data, std::size_t len) {")
+    L.append("  uint16_t crc = 0xFFFF;")
+    L.append("  for (std::size_t i = 0; i < len; i++) {")
+    L.append("    crc ^= static_cast<uint16_t>(data[i] << 8);")
+    L.append("    for (int b = 0; b < 8; b++) {")
+    L.append("      crc = (crc & 0x8000) ? static_cast<uint16_t>((crc << 1) ^ 0x1021) : static_cast<uint16_t>(crc << 1);")
+    L.append("    }")
+    L.append("  }")
+    L.append("  return crc;")
+    L.append("}")
+    L.append("#endif")
+    L.append("")
+    L.append("struct %s {" % cam)
+    L.append("  static constexpr std::size_t kLength = %d;" % length)
+    L.append("")
+    for f in fields:
+        L.append("  %s %s;%s" % (CTYPES[f.size], f.name, ("  // " + f.comment) if f.comment else ""))
+    L.append("")
+    L.append("  // Decode AdvData starting at the AD length byte. False on length, constant or CRC mismatch")
+    L.append("  static bool decode(const uint8_t* buf, std::size_t len, %s& out) {" % cam)
+    L.append("    if (len < kLength) {")
+    L.append("      return false;")
+    L.append("    }")
+    for i in items:
+        if i.kind == "len":
+            L.append("    if (buf[%d] != %d) {" % (i.offset, length - 1))
+            L.append("      return false;")
+            L.append("    }")
+        elif i.kind == "const":
+            L.append("    if (buf[%d] != 0x%02X) {" % (i.offset, i.value))
+            L.append("      return false;")
+            L.append("    }")
+        elif i.kind == "crc16":
+            L.append("    if (crc16(buf, %d) != static_cast<uint16_t>((buf[%d] << 8) | buf[%d])) {"
+                     % (i.offset, i.offset, i.offset + 1))
+            L.append("      return false;")
+            L.append("    }")
+    for f in fields:
+        parts = []
+        for k in range(f.size):
+            shift = 8 * (f.size - 1 - k)
+            b = "static_cast<%s>(buf[%d])" % (CTYPES[f.size], f.offset + k)
+            parts.append("(%s << %d)" % (b, shift) if shift else b)
+        L.append("    out.%s = static_cast<%s>(%s);" % (f.name, CTYPES[f.size], " | ".join(parts)))
+    L.append("    return true;")
+    L.append("  }")
+    L.append("};")
+    L.append("")
+    L.append("}  // namespace payload")
+    L.append("")
+    L.append("#endif  // %s" % guard)
+    return "\n".join(L) + "\n"
+
+
+def main():
+    ap = argparse.ArgumentParser(description="payload schema compiler")
+    ap.add_argument("schema")
+    ap.add_argument("--c", dest="c_out")
+    ap.add_argument("--cpp", dest="cpp_out")
+    args = ap.parse_args()
+
+    name, items, length = parse(args.schema)
+    schema = "schema/" + os.path.basename(args.schema)
+    if args.c_out:
+        open(args.c_out, "w").write(gen_c(name, items, length, schema))
+    if args.cpp_out:
+        open(args.cpp_out, "w").write(gen_cpp(name, items, length, schema))
+
+
+if __name__ == "__main__":
+    main()
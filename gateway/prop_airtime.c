@@ -0,0 +1,138 @@
+/*
+ * prop_airtime.c
+ *
+ * Airtime and TX energy per delivered reading: proprietary short packet vs.
+ * the three-channel BLE advertising chain of advanced_harvester.
+ *
+ * build: cc -c -I../ADVANCED/advanced_harvester -I../ADVANCED/advanced_harvester/cc26xxware_2_22_00_16101
+ *           ../ADVANCED/advanced_harvester/payload_compact.c
+ *        cc -O2 -I../ADVANCED/advanced_harvester -I../ADVANCED/advanced_harvester/cc26xxware_2_22_00_16101
+ *           -o prop_airtime prop_airtime.c prop_frame.c payload_compact.o
+ * usage: prop_airtime [loss per packet, default 0.1]
+ *
+ * Frames are the ones the firmware sends: the full layout and compact frames
+ * built with the firmware encoder (payload_compact.c, config.h of the tree).
+ * The BLE advert carries the AdvData, sealed (AUTH_PAYLOAD) when the trailer
+ * fits; the prop packet carries PROP_PAYLOAD_LEN(AdvData length), never sealed.
+ *
+ * Model: both links at 1 Mbps, TX current at 0 dBm from the CC2650 datasheet,
+ * a synth retune before every BLE channel. Setup and XOSC start are the same
+ * for both links and are left out. Losses per packet are independent, a BLE
+ * reading is delivered if one of the three adverts arrives.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "prop_frame.h"
+#include "config.h"
+#include "auth.h"
+#include "payload_advanced_uplink.h"
+#include "payload_compact.h"
+
+#define BLE_OVERHEAD_BYTES		(1 + 4 + 2 + 6 + 3)	// preamble, access address, header, AdvA, CRC
+#define BLE_CHANNELS			3
+#define BLE_RETUNE_US			150.0		// synth retune between advert channels (estimate)
+#define TX_CURRENT_MA			6.1			// CC2650, 0 dBm
+#define VDD_V					3.0
+#define FRAMES					5
+
+typedef struct {
+  const char *name;
+  uint8_t advLen;							// AdvData length as built by the firmware
+} frame_t;
+
+
+// AdvData lengths of the uplink frames: full layout, compact with the firmware encoder
+static void frameLengths(frame_t frames[FRAMES]) {
+  compactReading_t r, history[COMPACT_MAX_HISTORY];
+  uint8_t buf[ADVLEN];
+  uint8_t i;
+
+  memset(&r, 0, sizeof(r));
+  r.seq = 0x1234;
+  r.timediff = 0x1E80;
+  frames[0].name = "full";
+  frames[0].advLen = PAYLOAD_ADVANCED_UPLINK_LEN;
+  frames[1].name = "compact speed";
+  frames[1].advLen = payloadCompactEncode(buf, &r, NULL, 0);
+
+  r.flags = COMPACT_HAS_PRESSURE | COMPACT_HAS_TEMPERATURE | COMPACT_HAS_HUMIDITY;
+  r.pressure = 96000;
+  r.temperature = 2345;
+  r.humidity = 456;
+  frames[2].name = "compact env";
+  frames[2].advLen = payloadCompactEncode(buf, &r, NULL, 0);
+
+  for(i = 0; i < COMPACT_MAX_HISTORY; i++) {
+    history[i] = r;
+    history[i].seq = (uint16_t)(r.seq - 3 * (i + 1));
+    history[i].timediff = r.timediff + 40 * (i + 1);
+    history[i].pressure = r.pressure + 2 * (i + 1);
+  }
+  frames[3].name = "compact env+hist";
+  frames[3].advLen = payloadCompactEncode(buf, &r, history, COMPACT_MAX_HISTORY);
+
+  r.flags = COMPACT_HAS_RIDE;						// with sensors it does not fit a sealed frame
+  r.ride.revs = 12;
+  r.ride.ticks = 12 * r.timediff;
+  r.ride.minPeriod = r.timediff - 200;
+  r.ride.maxPeriod = r.timediff + 300;
+  r.rideTotals.distance = 12345;
+  r.rideTotals.movingTime = 2400;
+  frames[4].name = "compact ride";
+  frames[4].advLen = payloadCompactEncode(buf, &r, NULL, 0);
+}
+
+
+int main(int argc, char **argv) {
+  double loss = (argc > 1) ? atof(argv[1]) : 0.1;
+  double bleUs, propUs, bleUj, propUj;
+  double bleDelivered  = 1.0 - loss * loss * loss;
+  double propDelivered = 1.0 - loss;
+  uint8_t frame[PROP_FRAME_LEN(PROP_PKT_MAX)];
+  uint8_t pkt[ADVLEN], pktLen;
+  const uint8_t *dec, *end;
+  frame_t frames[FRAMES];
+  int i, bleLen;
+
+  // encoder/decoder round trip
+  for(i = 0; i < ADVLEN; i++) {
+    pkt[i] = (uint8_t)(0x5A + 7 * i);
+  }
+  pkt[0] = 0xDE;
+  pkt[1] = 0xBA;
+  end = frame + propFrameEncode(pkt, PROP_PAYLOAD_LEN(ADVLEN), frame);
+  if(propFrameDecode(frame, (size_t)(end - frame), &dec, &pktLen) != PROP_OK
+     || pktLen != PROP_PAYLOAD_LEN(ADVLEN) || memcmp(dec, pkt, pktLen) != 0) {
+    printf("round trip failed\n");
+    return 1;
+  }
+  frame[5] ^= 0x01;
+  if(propFrameDecode(frame, (size_t)(end - frame), &dec, &pktLen) != PROP_ERR_CRC) {
+    printf("CRC check failed\n");
+    return 1;
+  }
+
+  frameLengths(frames);
+  printf("loss per packet %.2f, delivered: ble-3ch %.3f, prop-1ch %.3f\n\n", loss, bleDelivered, propDelivered);
+  printf("%-18s %7s | %8s %8s %8s | %8s %8s %8s\n", "frame", "AdvData", "BLE [B]", "air [us]", "uJ/dlv",
+         "prop [B]", "air [us]", "uJ/dlv");
+  for(i = 0; i < FRAMES; i++) {
+    bleLen = frames[i].advLen;
+    if(AUTH_PAYLOAD && bleLen + AUTH_TRAILER_LEN <= ADVLEN) {
+      bleLen += AUTH_TRAILER_LEN;					// authSeal()
+    }
+    bleUs  = BLE_CHANNELS * ((BLE_OVERHEAD_BYTES + bleLen) * 8.0 + BLE_RETUNE_US);
+    propUs = (PROP_PREAMBLE_BYTES + PROP_SYNC_BYTES + PROP_FRAME_LEN(PROP_PAYLOAD_LEN(frames[i].advLen))) * 8.0;
+
+    bleUj  = bleUs * TX_CURRENT_MA * VDD_V / 1000.0;
+    propUj = propUs * TX_CURRENT_MA * VDD_V / 1000.0;
+
+    printf("%-18s %7u | %8d %8.0f %8.2f | %8d %8.0f %8.2f\n", frames[i].name, frames[i].advLen,
+           bleLen, bleUs, bleUj / bleDelivered,
+           PROP_PAYLOAD_LEN(frames[i].advLen), propUs, propUj / propDelivered);
+  }
+
+  return 0;
+}
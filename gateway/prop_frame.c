@@ -0,0 +1,57 @@
+/*
+ * prop_frame.c
+ *
+ * Encoder/decoder for the proprietary short-packet link, frame see prop_frame.h
+ */
+
+#include <string.h>
+#include "prop_frame.h"
+
+
+uint16_t propCrc16(const uint8_t *data, size_t len) {
+  uint16_t crc = 0xFFFF;
+  size_t i;
+  int b;
+
+  for(i = 0; i < len; i++) {
+    crc ^= (uint16_t)data[i] << 8;
+    for(b = 0; b < 8; b++) {
+      crc = (crc & 0x8000) ? (uint16_t)((crc << 1) ^ 0x1021) : (uint16_t)(crc << 1);
+    }
+  }
+  return crc;
+}
+
+size_t propFrameEncode(const uint8_t *pkt, uint8_t pktLen, uint8_t *out) {
+  uint16_t crc;
+
+  out[0] = pktLen;
+  memcpy(&out[1], pkt, pktLen);
+
+  crc = propCrc16(out, 1 + (size_t)pktLen);
+  out[1 + pktLen] = (uint8_t)(crc >> 8);
+  out[2 + pktLen] = (uint8_t)crc;
+
+  return PROP_FRAME_LEN(pktLen);
+}
+
+int propFrameDecode(const uint8_t *in, size_t len, const uint8_t **pkt, uint8_t *pktLen) {
+  uint16_t crc;
+
+  if(len < (size_t)PROP_FRAME_LEN(0) || len < (size_t)PROP_FRAME_LEN(in[0])) {
+    return PROP_ERR_LEN;
+  }
+
+  crc = ((uint16_t)in[1 + in[0]] << 8) | in[2 + in[0]];
+  if(propCrc16(in, 1 + (size_t)in[0]) != crc) {
+    return PROP_ERR_CRC;
+  }
+
+  if(in[0] < 2 || in[1] != 0xDE || in[2] != 0xBA) {
+    return PROP_ERR_MAGIC;
+  }
+
+  *pkt = &in[1];
+  *pktLen = in[0];
+  return PROP_OK;
+}
@@ -0,0 +1,52 @@
+/*
+ * prop_frame.h
+ *
+ * Host side encoder/decoder for the proprietary short-packet link
+ * ---------------------------------------------------------------
+ * (firmware: LINK_MODE_PROP in advanced_harvester/config.h)
+ *
+ * On air, 1 Mbps GFSK on PROP_FREQUENCY_MHZ:
+ *   [preamble 4 x 0x55][sync word 0x930B51DE][len][payload, len bytes][CRC-16]
+ *
+ * The decoder gets the bytes after the sync word (length, payload, CRC), as
+ * delivered by a receiver in raw mode. CRC-16/CCITT (poly 0x1021, init 0xFFFF)
+ * over length byte and payload, MSB first, must match the RF core CRC setting.
+ *
+ * Payload: the AdvData the firmware built for the BLE link (full layout or
+ * payload_compact.h, length per packet) from byte PROP_PKT_OFFSET on, without its
+ * trailing CRC-16 (radioUpdateAdvData()). The radio CRC covers it instead.
+ * Both formats start with 0xDE 0xBA.
+ */
+
+#ifndef PROP_FRAME_H_
+#define PROP_FRAME_H_
+
+#include <stdint.h>
+#include <stddef.h>
+
+#define PROP_PREAMBLE_BYTES		4
+#define PROP_SYNC_WORD			0x930B51DE
+#define PROP_SYNC_BYTES			4
+#define PROP_PKT_OFFSET			2			// AD length/type bytes of the AdvData
+#define PROP_PKT_MAX			255
+#define PROP_CRC_BYTES			2
+#define PROP_FRAME_LEN(pktLen)	(1 + (pktLen) + PROP_CRC_BYTES)		// after sync word
+#define PROP_PAYLOAD_LEN(advLen) ((advLen) - PROP_PKT_OFFSET - PROP_CRC_BYTES)	// payload of an AdvData
+
+// decoder results
+#define PROP_OK					0
+#define PROP_ERR_LEN			-1
+#define PROP_ERR_CRC			-2
+#define PROP_ERR_MAGIC			-3
+
+
+uint16_t propCrc16(const uint8_t *data, size_t len);
+
+// Encode length, payload and CRC into out (PROP_FRAME_LEN(pktLen) bytes), returns length
+size_t propFrameEncode(const uint8_t *pkt, uint8_t pktLen, uint8_t *out);
+
+// Decode a frame (bytes after the sync word), PROP_OK or PROP_ERR_*.
+// pkt/pktLen: the payload inside in
+int propFrameDecode(const uint8_t *in, size_t len, const uint8_t **pkt, uint8_t *pktLen);
+
+#endif /* PROP_FRAME_H_ */
@@ -63,6 +63,7 @@
 
 #include "board.h"
 #include "radio.h"
+#include "payload_simple_uplink.h"
 
 #include <config.h>
 #include <driverLib/gpio.h>
@@ -371,47 +372,15 @@ void ledInit(void)
 
 /*****************************************************************************************/
 // Set payload and transmit
-	uint8_t p;
-    p = 0;
-
-    /*jedes 5.te mal senden*/
-
-
-		payload[p++] = ADVLEN-1;        /* len */
-		payload[p++] = 0x03;
-		payload[p++] = 0xde;
-		payload[p++] = 0xba;
-		payload[p++] =(sequenceNumber >> 8);				// laufnummer
-		payload[p++] = sequenceNumber;
-
-		// Speed
-		payload[p++] = g_diff >> 24;						// higher seconds
-		payload[p++] = g_diff >> 16;						// lower  seconds
-		payload[p++] = g_diff >> 8;							// higher subseconds
-		payload[p++] = g_diff;								// lower  subseconds
-
-		//pressure
-		payload[p++] = 0;
-		payload[p++] = 0; //(pressure >> 16);
-		payload[p++] = 0; //(pressure >> 8);
-		payload[p++] = 0; //pressure;
-
-		//temperature
-		payload[p++] = 0;
-		payload[p++] = 0; // char_temp[2];
-		payload[p++] = 0;//temperature >> 8; // char_temp[1];
-		payload[p++] = 0; //temperature; //char_temp[0];
-
-		// huminity
-		payload[p++] = 0;
-		payload[p++] = 0;//char_hum[0];
-		payload[p++] = 0;//char_hum[1];
-		payload[p++] = 0;//char_hum[2];
-
-		payload[p++] = 0;
-		payload[p++] = 0;
-
-
+	// payload layout: gateway/schema/simple_uplink.schema
+	payloadSimpleUplink_t uplink;
+
+		uplink.seq         = sequenceNumber;
+		uplink.timediff    = g_diff;
+		uplink.pressure    = 0;
+		uplink.temperature = 0;
+		uplink.humidity    = 0;
+		payloadSimpleUplinkEncode((uint8_t*)payload, &uplink);
 
 		//Start radio setup and linked advertisment
 		radioUpdateAdvData(ADVLEN, payload);